@@ -20,17 +20,13 @@ namespace fast {
 
         mIterationError = mTolerance + 10.0;
         mObjectiveFunction = mObjectiveFunction = std::numeric_limits<double>::max();
-        mResponsibilityMatrix = MatrixXf::Zero(mNumMovingPoints, mNumFixedPoints);
     }
 
     void CoherentPointDriftAffine::maximization(Eigen::MatrixXf &fixedPoints, Eigen::MatrixXf &movingPoints) {
 
         double startM = omp_get_wtime();
 
-        // Define some useful matrix sums
-        mPt1 = mResponsibilityMatrix.transpose().rowwise().sum();      // mNumFixedPoints x 1
-        mP1 = mResponsibilityMatrix.rowwise().sum();                   // mNumMovingPoints x 1
-        mNp = mPt1.sum();                                           // 1 (sum of all P elements)
+        // P1, Pt1, Np and PX are calculated in the expectation step
         double timeEndMUseful = omp_get_wtime();
 
         // Estimate new mean vectors
@@ -45,7 +41,8 @@ namespace fast {
         /* **********************************************************
          * Find transformation parameters: affine matrix, translation
          * *********************************************************/
-        MatrixXf A = fixedPointsCentered.transpose() * mResponsibilityMatrix.transpose() * movingPointsCentered;
+        // Equal to fixedPointsCentered^T * P^T * movingPointsCentered
+        MatrixXf A = mPX.transpose() * movingPoints - mNp * fixedMean * movingMean.transpose();
         MatrixXf YPY = movingPointsCentered.transpose() * mP1.asDiagonal() * movingPointsCentered;
         MatrixXf XPX = fixedPointsCentered.transpose() * mPt1.asDiagonal() * fixedPointsCentered;
 
@@ -3,6 +3,7 @@
 #include "CoherentPointDrift.hpp"
 
 #include "FAST/Algorithms/CoherentPointDrift/Rigid.hpp"
+#include "FAST/Algorithms/KDTree/KDTree.hpp"
 
 #undef min
 #undef max
@@ -20,6 +21,7 @@ namespace fast {
         mIteration = 0;
         mTolerance = 1e-4;
         mUniformWeight = 0.5;
+        mTruncation = 0;
         mTransformation = AffineTransformation::New();
         mRegistrationConverged = false;
         mScale = 1.0;
@@ -94,47 +96,80 @@ namespace fast {
 
         double timeStartE = omp_get_wtime();
 
-        /* **********************************************************************************
-         * Calculate distances between the points in the two point sets
-         * Let row i in P equal the squared distances from all fixed points to moving point i
-         * *********************************************************************************/
-
-        /* Implementation without OpenMP
-        MatrixXf movingPointMatrix = MatrixXf::Zero(mNumMovingPoints, mNumFixedPoints);
-        MatrixXf distances = MatrixXf::Zero(mNumMovingPoints, mNumFixedPoints);
-        for (int i = 0; i < mNumMovingPoints; ++i) {
-            movingPointMatrix = movingPoints.row(i).replicate(mNumFixedPoints, 1);
-            distances = fixedPoints - movingPoints.row(i).replicate(mNumFixedPoints, 1);
-            distances = fixedPoints - movingPointMatrix;            // Distance between all fixed points and moving point i
-            distances = distances.cwiseAbs2();                            // Square distance components (3xN)
-            mResponsibilityMatrix.row(i) = distances.rowwise().sum();   // Sum x, y, z components (1xN)
-        }
-        */
+        /* ***********************************************************************************
+         * The responsibility matrix P (moving x fixed points) is never stored. Instead the
+         * fixed points are processed one at a time in parallel, and only the reductions of P
+         * needed by the maximization step are accumulated: P1, Pt1, Np and PX.
+         * **********************************************************************************/
 
         auto c = (float) (pow(2*(double)EIGEN_PI*mVariance, (double)mNumDimensions/2.0)
                           * (mUniformWeight/(1-mUniformWeight)) * (float)mNumMovingPoints/mNumFixedPoints);
-
-#pragma omp parallel for //collapse(2)
-        for (int col = 0; col < mNumFixedPoints; ++col) {
-            for (int row = 0; row < mNumMovingPoints; ++row) {
-                double norm = (fixedPoints.row(col) - movingPoints.row(row)).squaredNorm();
-                mResponsibilityMatrix(row, col) = exp(norm / (-2.0 * mVariance));
-            }
+        const auto exponentScale = (float) (-1.0 / (2.0 * mVariance));
+
+        // With truncation, only moving points within the truncation distance are used
+        std::unique_ptr<KDTree> movingTree;
+        float truncationDistance = 0;
+        if(mTruncation > 0) {
+            movingTree = std::make_unique<KDTree>(movingPoints.transpose());
+            truncationDistance = (float) (mTruncation * sqrt(mVariance));
         }
-        double timeEndFirstLoop = omp_get_wtime();
-
-#pragma omp parallel for
-        for (int col = 0; col < mNumFixedPoints; ++col) {
-            float denom = mResponsibilityMatrix.col(col).sum() + c;
-            mResponsibilityMatrix.col(col) /= max(denom, Eigen::NumTraits<float>::epsilon() );
+        double timeEndDistances = omp_get_wtime();
+
+        mPt1 = VectorXf::Zero(mNumFixedPoints);
+        mP1 = VectorXf::Zero(mNumMovingPoints);
+        mPX = MatrixXf::Zero(mNumMovingPoints, mNumDimensions);
+#pragma omp parallel
+        {
+            // Thread local accumulators, added together at the end
+            VectorXf P1 = VectorXf::Zero(mNumMovingPoints);
+            MatrixXf PX = MatrixXf::Zero(mNumMovingPoints, mNumDimensions);
+            Eigen::ArrayXf column(mNumMovingPoints);
+            std::vector<int> neighbours;
+#pragma omp for schedule(dynamic, 64)
+            for (int col = 0; col < mNumFixedPoints; ++col) {
+                if(movingTree) {
+                    neighbours = movingTree->findWithinRadius(fixedPoints.row(col).transpose(), truncationDistance);
+                    for(int i = 0; i < neighbours.size(); ++i)
+                        column(i) = (fixedPoints.row(col) - movingPoints.row(neighbours[i])).squaredNorm();
+                    auto values = column.head(neighbours.size());
+                    values = (values * exponentScale).exp();
+                    const float sum = values.sum();
+                    const float denom = max(sum + c, Eigen::NumTraits<float>::epsilon());
+                    values /= denom;
+                    mPt1(col) = sum / denom;
+                    for(int i = 0; i < neighbours.size(); ++i) {
+                        P1(neighbours[i]) += values(i);
+                        PX.row(neighbours[i]) += values(i) * fixedPoints.row(col);
+                    }
+                } else {
+                    // Column of P for this fixed point, using Eigen's vectorized exp
+                    column = (movingPoints.col(0).array() - fixedPoints(col, 0)).square();
+                    for(int dim = 1; dim < mNumDimensions; ++dim)
+                        column += (movingPoints.col(dim).array() - fixedPoints(col, dim)).square();
+                    column = (column * exponentScale).exp();
+                    const float sum = column.sum();
+                    const float denom = max(sum + c, Eigen::NumTraits<float>::epsilon());
+                    column /= denom;
+                    mPt1(col) = sum / denom;
+                    P1 += column.matrix();
+                    for(int dim = 0; dim < mNumDimensions; ++dim)
+                        PX.col(dim) += column.matrix() * fixedPoints(col, dim);
+                }
+            }
+#pragma omp critical
+            {
+                mP1 += P1;
+                mPX += PX;
+            }
         }
+        mNp = mPt1.sum();
 
         // Update computation times
         double timeEndE = omp_get_wtime();
-        timeEDistances += 0.0;
-        timeENormal += timeEndFirstLoop - timeStartE;
+        timeEDistances += timeEndDistances - timeStartE;
+        timeENormal += timeEndE - timeEndDistances;
         timeEPosterior += 0.0;
-        timeEPosteriorDivision += timeEndE - timeEndFirstLoop;
+        timeEPosteriorDivision += 0.0;
         timeE += timeEndE - timeStartE;
     }
 
@@ -256,6 +291,12 @@ namespace fast {
         mTolerance = tolerance;
     }
 
+    void CoherentPointDrift::setTruncation(float standardDeviations) {
+        if(standardDeviations < 0)
+            throw Exception("Truncation of CoherentPointDrift can't be negative");
+        mTruncation = standardDeviations;
+    }
+
     AffineTransformation::pointer CoherentPointDrift::getOutputTransformation() {
         return mTransformation;
     }
@@ -18,6 +18,13 @@ namespace fast {
         void setMaximumIterations(unsigned char maxIterations);
         void setUniformWeight(float uniformWeight);
         void setTolerance(double tolerance);
+        /**
+         * Truncate the Gaussian kernel of the expectation step at the given nr of standard deviations.
+         * Only pairs of points closer than this are used, and they are found with a KDTree,
+         * which is much faster for large point sets when the variance becomes small.
+         * @param standardDeviations Truncation distance. 0 (default) means no truncation.
+         */
+        void setTruncation(float standardDeviations);
         AffineTransformation::pointer getOutputTransformation();
 
         virtual void initializeVarianceAndMore() = 0;
@@ -31,7 +38,10 @@ namespace fast {
         MatrixXf mMovingPoints;
         MatrixXf mMovingMeanInitial;
         MatrixXf mFixedMeanInitial;
-        MatrixXf mResponsibilityMatrix;         // P
+        VectorXf mPt1;                          // Colwise sum of P, then transpose
+        VectorXf mP1;                           // Rowwise sum of P
+        MatrixXf mPX;                           // P multiplied with fixed points
+        float mNp;                              // Sum of all elements in P
         unsigned int mNumFixedPoints;           // N
         unsigned int mNumMovingPoints;          // M
         unsigned int mNumDimensions;            // D
@@ -65,6 +75,7 @@ namespace fast {
         std::shared_ptr<Mesh> mFixedMesh;
         std::shared_ptr<Mesh> mMovingMesh;
         unsigned char mMaxIterations;
+        float mTruncation;
         CoherentPointDrift::TransformationType mTransformationType;
     };
 
@@ -17,12 +17,9 @@ namespace fast {
         void initializeVarianceAndMore() override;
 
     private:
-        VectorXf mPt1;                          // Colwise sum of P, then transpose
-        VectorXf mP1;                           // Rowwise sum of P
         MatrixXf mRotation;                     // R
         MatrixXf mTranslation;                  // t
         double mIterationError;                 // Change in error from iteration to iteration
-        float mNp;                              // Sum of all elements in P
         TransformationType mTransformationType;
     };
 
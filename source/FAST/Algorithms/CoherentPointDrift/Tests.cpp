@@ -10,6 +10,7 @@
 #include "CoherentPointDrift.hpp"
 #include "Rigid.hpp"
 #include "Affine.hpp"
+#include "FAST/SceneGraph.hpp"
 
 #include <random>
 #include <iostream>
@@ -181,4 +182,34 @@ TEST_CASE("cpd", "[fast][coherentpointdrift][visual][cpd]") {
         window->start();
     }
 
-}
\ No newline at end of file
+}
+
+TEST_CASE("cpd with truncated kernel gives same result as full kernel", "[fast][coherentpointdrift][cpd]") {
+    auto fixedCloud = getPointCloud();
+    modifyPointCloud(fixedCloud, 0.5);
+
+    Affine3f affine = Affine3f::Identity();
+    affine.rotate(Eigen::AngleAxisf(3.141592f / 180.0f * 10.0f, Eigen::Vector3f::UnitY()));
+    affine.translate(Vector3f(0.01f, 0.005f, -0.001f));
+    auto transform = AffineTransformation::New();
+    transform->setTransform(affine);
+
+    std::vector<Affine3f> results;
+    for(float truncation : {0.0f, 5.0f}) {
+        auto movingCloud = getPointCloud();
+        modifyPointCloud(movingCloud, 0.5);
+        movingCloud->getSceneGraphNode()->setTransformation(transform);
+
+        auto cpd = CoherentPointDriftRigid::New();
+        cpd->setFixedMesh(fixedCloud);
+        cpd->setMovingMesh(movingCloud);
+        cpd->setMaximumIterations(50);
+        cpd->setTruncation(truncation);
+        auto port = cpd->getOutputPort();
+        cpd->update();
+        auto registered = port->getNextFrame<Mesh>();
+        results.push_back(SceneGraph::getEigenAffineTransformationFromData(registered));
+    }
+
+    CHECK(results[0].matrix().isApprox(results[1].matrix(), 1e-3));
+}
@@ -2,6 +2,8 @@
 #include "FAST/Exception.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Data/Image.hpp"
+#include <cstring>
+#include <limits>
 using namespace fast;
 
 void GaussianSmoothingFilter::setMaskSize(unsigned char maskSize) {
@@ -138,61 +140,130 @@ void GaussianSmoothingFilter::recompileOpenCLCode(Image::pointer input) {
     mTypeCLCodeCompiledFor = input->getDataType();
 }
 
+/**
+ * Normalized 1D gaussian mask. The 2D and 3D gaussian masks are outer products of this mask,
+ * thus the host implementation can filter along one axis at a time.
+ */
+static std::vector<float> createSeparableMask(int maskSize, float stdDev) {
+    const int halfSize = (maskSize-1)/2;
+    std::vector<float> mask(maskSize);
+    float sum = 0.0f;
+    for(int x = -halfSize; x <= halfSize; x++) {
+        mask[x+halfSize] = exp(-(float)(x*x)/(2.0f*stdDev*stdDev));
+        sum += mask[x+halfSize];
+    }
+    for(float& value : mask)
+        value /= sum;
+    return mask;
+}
+
 template <class T>
-void executeAlgorithmOnHost(Image::pointer input, Image::pointer output, const float* const mask, unsigned char maskSize) {
-    // TODO: this method currently only processes the first component
-    unsigned int nrOfComponents = input->getNrOfChannels();
-    ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
-    ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+static void storeValues(const float* values, T* output, std::size_t size) {
+    // Round and saturate as the OpenCL kernels do
+    const float lowest = std::numeric_limits<T>::lowest();
+    const float highest = std::numeric_limits<T>::max();
+    for(std::size_t i = 0; i < size; ++i)
+        output[i] = (T)std::min(std::max(std::round(values[i]), lowest), highest);
+}
 
-    T * inputData = (T*)inputAccess->get();
-    T * outputData = (T*)outputAccess->get();
-
-    const unsigned char halfSize = (maskSize-1)/2;
-    unsigned int width = input->getWidth();
-    unsigned int height = input->getHeight();
-    if(input->getDimensions() == 3) {
-        unsigned int depth = input->getDepth();
-        for(unsigned int z = 0; z < depth; z++) {
-        for(unsigned int y = 0; y < height; y++) {
-        for(unsigned int x = 0; x < width; x++) {
-
-            if(x < halfSize || x >= width-halfSize ||
-            y < halfSize || y >= height-halfSize ||
-            z < halfSize || z >= depth-halfSize) {
-                // on border only copy values
-                outputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height] = inputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height];
-                continue;
+template <>
+void storeValues<float>(const float* values, float* output, std::size_t size) {
+    std::memcpy(output, values, size*sizeof(float));
+}
+
+/**
+ * Filter along x. Rows are padded by repeating the edge pixels, which is the same as
+ * CLK_ADDRESS_CLAMP_TO_EDGE in the OpenCL kernels. All channels are filtered.
+ */
+template <class T>
+static void smoothRows(const T* input, float* output, int width, int rows, int channels, const std::vector<float>& mask) {
+    const int halfSize = (mask.size()-1)/2;
+    const int rowLength = width*channels;
+    #pragma omp parallel
+    {
+        std::vector<float> padded((width + 2*halfSize)*channels);
+        #pragma omp for
+        for(int row = 0; row < rows; ++row) {
+            const T* source = &input[(std::size_t)row*rowLength];
+            for(int x = -halfSize; x < width + halfSize; ++x) {
+                const int clamped = std::min(std::max(x, 0), width - 1);
+                for(int channel = 0; channel < channels; ++channel)
+                    padded[(x + halfSize)*channels + channel] = (float)source[clamped*channels + channel];
             }
 
-            double sum = 0.0;
-            for(int c = -halfSize; c <= halfSize; c++) {
-            for(int b = -halfSize; b <= halfSize; b++) {
-            for(int a = -halfSize; a <= halfSize; a++) {
-                sum += mask[a+halfSize+(b+halfSize)*maskSize+(c+halfSize)*maskSize*maskSize]*
-                        inputData[(x+a)*nrOfComponents+(y+b)*nrOfComponents*width+(z+c)*nrOfComponents*width*height];
-            }}}
-            outputData[x*nrOfComponents+y*nrOfComponents*width+z*nrOfComponents*width*height] = (T)sum;
-        }}}
-    } else {
-        for(unsigned int y = halfSize; y < height-halfSize; y++) {
-        for(unsigned int x = halfSize; x < width-halfSize; x++) {
-
-            if(x < halfSize || x >= width-halfSize ||
-            y < halfSize || y >= height-halfSize) {
-                // on border only copy values
-                outputData[x*nrOfComponents+y*nrOfComponents*width] = inputData[x*nrOfComponents+y*nrOfComponents*width];
-                continue;
+            float* target = &output[(std::size_t)row*rowLength];
+            std::fill(target, target + rowLength, 0.0f);
+            for(int k = 0; k < mask.size(); ++k) {
+                const float weight = mask[k];
+                const float* shifted = &padded[k*channels];
+                for(int i = 0; i < rowLength; ++i)
+                    target[i] += weight*shifted[i];
+            }
+        }
+    }
+}
+
+/**
+ * Filter along y or z. The data is seen as slices of lines, where each line has lineLength values,
+ * and is filtered across the lines of each slice. For y the lines are image rows, and for z
+ * the data is one slice where each line is an entire image plane.
+ * Lines are processed in blocks, so that the sums for a block stay in the L1 cache while the
+ * neighbour lines are streamed through, and the inner loop is contiguous so that it is vectorized.
+ */
+template <class T>
+static void smoothLines(const float* input, T* output, int slices, int lines, std::size_t lineLength, const std::vector<float>& mask) {
+    const int halfSize = (mask.size()-1)/2;
+    const std::size_t blockSize = 2048;
+    const int64_t blocks = (lineLength + blockSize - 1)/blockSize;
+    const int64_t tasks = (int64_t)slices*lines*blocks;
+    #pragma omp parallel
+    {
+        std::vector<float> sum(blockSize);
+        #pragma omp for
+        for(int64_t task = 0; task < tasks; ++task) {
+            const std::size_t start = (task % blocks)*blockSize;
+            const int line = (task / blocks) % lines;
+            const int slice = task / (blocks*lines);
+            const std::size_t length = std::min(blockSize, lineLength - start);
+            const float* sliceData = &input[(std::size_t)slice*lines*lineLength + start];
+
+            std::fill(sum.begin(), sum.begin() + length, 0.0f);
+            for(int k = 0; k < mask.size(); ++k) {
+                const int neighbour = std::min(std::max(line + k - halfSize, 0), lines - 1);
+                const float weight = mask[k];
+                const float* source = &sliceData[neighbour*lineLength];
+                for(std::size_t i = 0; i < length; ++i)
+                    sum[i] += weight*source[i];
             }
+            storeValues(sum.data(), &output[((std::size_t)slice*lines + line)*lineLength + start], length);
+        }
+    }
+}
 
-            double sum = 0.0;
-            for(int b = -halfSize; b <= halfSize; b++) {
-            for(int a = -halfSize; a <= halfSize; a++) {
-                sum += mask[a+halfSize+(b+halfSize)*maskSize]*
-                        inputData[(x+a)*nrOfComponents+(y+b)*nrOfComponents*width];
-            }}
-            outputData[x*nrOfComponents+y*nrOfComponents*width] = (T)sum;
-        }}
+template <class T>
+void executeAlgorithmOnHost(Image::pointer input, Image::pointer output, const std::vector<float>& mask) {
+    ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
+    ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+    const T* inputData = (const T*)inputAccess->get();
+    void* outputData = outputAccess->get();
+
+    const int width = input->getWidth();
+    const int height = input->getHeight();
+    const int depth = input->getDimensions() == 3 ? input->getDepth() : 1;
+    const std::size_t lineLength = (std::size_t)width*input->getNrOfChannels();
+
+    std::vector<float> smoothedX(lineLength*height*depth);
+    smoothRows(inputData, smoothedX.data(), width, height*depth, input->getNrOfChannels(), mask);
+    if(depth == 1) {
+        switch(output->getDataType()) {
+            fastSwitchTypeMacro(smoothLines(smoothedX.data(), (FAST_TYPE*)outputData, 1, height, lineLength, mask));
+        }
+    } else {
+        std::vector<float> smoothedY(smoothedX.size());
+        smoothLines(smoothedX.data(), smoothedY.data(), depth, height, lineLength, mask);
+        switch(output->getDataType()) {
+            fastSwitchTypeMacro(smoothLines(smoothedY.data(), (FAST_TYPE*)outputData, 1, depth, lineLength*height, mask));
+        }
     }
 }
 
@@ -220,9 +291,9 @@ void GaussianSmoothingFilter::execute() {
 
 
     if(device->isHost()) {
-        createMask(input, maskSize, false);
+        const std::vector<float> mask = createSeparableMask(maskSize, mStdDev);
         switch(input->getDataType()) {
-            fastSwitchTypeMacro(executeAlgorithmOnHost<FAST_TYPE>(input, output, mMask.get(), maskSize));
+            fastSwitchTypeMacro(executeAlgorithmOnHost<FAST_TYPE>(input, output, mask));
         }
     } else {
         OpenCLDevice::pointer clDevice = std::static_pointer_cast<OpenCLDevice>(device);
@@ -1,6 +1,8 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter.hpp"
 #include "FAST/DeviceManager.hpp"
+#include <chrono>
+#include <random>
 
 namespace fast {
 
@@ -202,4 +204,77 @@ TEST_CASE("Correct output with small 3x3x3 3D image as input to GaussianSmoothin
 }
 */
 
+static Image::pointer createRandomImage(Vector3i size, DataType type) {
+    auto image = Image::New();
+    if(size.z() == 1) {
+        image->create(size.x(), size.y(), type, 1);
+    } else {
+        image->create(size.x(), size.y(), size.z(), type, 1);
+    }
+    auto access = image->getImageAccess(ACCESS_READ_WRITE);
+    std::mt19937 random(size.x());
+    std::uniform_int_distribution<int> distribution(0, 255);
+    for(int i = 0; i < size.prod(); ++i)
+        access->setScalar(i, distribution(random));
+    return image;
+}
+
+static Image::pointer runGaussianSmoothing(Image::pointer input, ExecutionDevice::pointer device, float stdDev = 1.5f) {
+    auto filter = GaussianSmoothingFilter::New();
+    filter->setStandardDeviation(stdDev);
+    filter->setInputData(input);
+    filter->setMainDevice(device);
+    auto output = filter->updateAndGetOutputData<Image>();
+    // Make sure the result is available on the host
+    output->getImageAccess(ACCESS_READ);
+    return output;
+}
+
+TEST_CASE("GaussianSmoothingFilter gives same result on host and OpenCL device", "[fast][GaussianSmoothingFilter]") {
+    auto device = DeviceManager::getInstance()->getDefaultComputationDevice();
+    for(DataType type : {TYPE_UINT8, TYPE_FLOAT}) {
+        for(Vector3i size : {Vector3i(67, 45, 1), Vector3i(33, 28, 19)}) {
+            auto input = createRandomImage(size, type);
+            auto hostOutput = runGaussianSmoothing(input, Host::getInstance());
+            auto deviceOutput = runGaussianSmoothing(input, device);
+            CHECK(hostOutput->getDataType() == type);
+
+            auto hostAccess = hostOutput->getImageAccess(ACCESS_READ);
+            auto deviceAccess = deviceOutput->getImageAccess(ACCESS_READ);
+            int differences = 0;
+            for(int i = 0; i < size.prod(); ++i) {
+                // Integer results may be rounded differently
+                if(std::fabs(hostAccess->getScalar(i) - deviceAccess->getScalar(i)) > (type == TYPE_FLOAT ? 0.01f : 1.0f))
+                    ++differences;
+            }
+            CHECK(differences == 0);
+        }
+    }
+}
+
+TEST_CASE("GaussianSmoothingFilter host and OpenCL benchmark", "[fast][GaussianSmoothingFilter][benchmark]") {
+    std::vector<std::pair<std::string, ExecutionDevice::pointer>> devices = {{"Host", Host::getInstance()}};
+    if(!DeviceManager::getInstance()->getAllCPUDevices().empty())
+        devices.push_back({"OpenCL CPU", DeviceManager::getInstance()->getOneCPUDevice()});
+    if(!DeviceManager::getInstance()->getAllGPUDevices().empty())
+        devices.push_back({"OpenCL GPU", DeviceManager::getInstance()->getOneGPUDevice()});
+
+    for(Vector3i size : {Vector3i(1920, 1080, 1), Vector3i(256, 256, 256)}) {
+        for(DataType type : {TYPE_UINT8, TYPE_FLOAT}) {
+            auto input = createRandomImage(size, type);
+            for(auto&& device : devices) {
+                // First run includes kernel compilation and transfer of the input
+                runGaussianSmoothing(input, device.second, 2.0f);
+                const int iterations = 5;
+                auto start = std::chrono::high_resolution_clock::now();
+                for(int i = 0; i < iterations; ++i)
+                    runGaussianSmoothing(input, device.second, 2.0f);
+                std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+                Reporter::info() << "GaussianSmoothingFilter " << size.transpose() << " " << getCTypeAsString(type)
+                    << " on " << device.first << ": " << duration.count() / iterations << " ms" << Reporter::end();
+            }
+        }
+    }
+}
+
 } // end namespace fast
@@ -1,6 +1,8 @@
 #include <FAST/Data/ImagePyramid.hpp>
 #include <FAST/Data/Image.hpp>
 #include "PatchGenerator.hpp"
+#include <FAST/Algorithms/NeuralNetwork/NeuralNetwork.hpp>
+#include <map>
 
 namespace fast {
 
@@ -8,7 +10,7 @@ PatchGenerator::PatchGenerator() {
     createInputPort<SpatialDataObject>(0); // Either ImagePyramid or Image/Volume
     createInputPort<Image>(1, false); // Optional mask
 
-    createOutputPort<Image>(0);
+    createOutputPort<DataObject>(0); // Image or Batch of images
 
     m_width = -1;
     m_height = -1;
@@ -17,10 +19,15 @@ PatchGenerator::PatchGenerator() {
     m_streamIsStarted = false;
     m_firstFrameIsInserted = false;
     m_level = 0;
+    m_threads = std::max(1, (int)std::thread::hardware_concurrency());
     mIsModified = true;
 
     createIntegerAttribute("patch-size", "Patch size", "", 0);
     createIntegerAttribute("patch-level", "Patch level", "Patch level used for image pyramid inputs", m_level);
+    createIntegerAttribute("threads", "Threads", "Nr of threads used to read patches from image pyramid inputs", m_threads);
+    createIntegerAttribute("batch-size", "Batch size", "Nr of patches to output in each batch. 1 means single patches are output.", m_batchSize);
+    createFloatAttribute("mask-threshold", "Mask threshold", "Fraction of a patch which must be foreground in the mask", m_maskThreshold);
+    createBooleanAttribute("tissue-priority", "Tissue priority", "Generate patches with most foreground in the mask first", m_tissuePriority);
 }
 
 void PatchGenerator::loadAttributes() {
@@ -34,24 +41,128 @@ void PatchGenerator::loadAttributes() {
     }
 
     setPatchLevel(getIntegerAttribute("patch-level"));
+    setNumberOfThreads(getIntegerAttribute("threads"));
+    setBatchSize(getIntegerAttribute("batch-size"));
+    setMaskThreshold(getFloatAttribute("mask-threshold"));
+    setTissuePriorityOrder(getBooleanAttribute("tissue-priority"));
 }
 
 PatchGenerator::~PatchGenerator() {
     stop();
 }
 
-void PatchGenerator::generateStream() {
-    Image::pointer previousPatch;
-
-    if(m_inputImagePyramid) {
-        const int levelWidth = m_inputImagePyramid->getLevelWidth(m_level);
-        const int levelHeight = m_inputImagePyramid->getLevelHeight(m_level);
-        const int patchesX = std::ceil((float) levelWidth / m_width);
-        const int patchesY = std::ceil((float) levelHeight / m_height);
+template <class T>
+static void createIntegralImage(const T* mask, int width, int height, std::vector<uint32_t>& integral) {
+    // One extra row and column of zeros at the start, so that no border checks are needed
+    integral.assign((std::size_t)(width + 1)*(height + 1), 0);
+    for(int y = 0; y < height; ++y) {
+        uint32_t rowSum = 0;
+        const T* row = &mask[(std::size_t)y*width];
+        const uint32_t* previous = &integral[(std::size_t)y*(width + 1)];
+        uint32_t* current = &integral[(std::size_t)(y + 1)*(width + 1)];
+        for(int x = 0; x < width; ++x) {
+            rowSum += row[x] != 0 ? 1 : 0;
+            current[x + 1] = previous[x + 1] + rowSum;
+        }
+    }
+}
 
+std::vector<Vector2i> PatchGenerator::createPatchList(int patchesX, int patchesY) {
+    std::vector<Vector2i> patches;
+    if(!m_inputMask) {
         for(int patchY = 0; patchY < patchesY; ++patchY) {
             for(int patchX = 0; patchX < patchesX; ++patchX) {
-                mRuntimeManager->startRegularTimer("create patch");
+                patches.push_back(Vector2i(patchX, patchY));
+            }
+        }
+        return patches;
+    }
+
+    // Count foreground pixels of the mask with an integral image, so that the foreground fraction
+    // of each patch is found in constant time
+    const int maskWidth = m_inputMask->getWidth();
+    const int maskHeight = m_inputMask->getHeight();
+    std::vector<uint32_t> integral;
+    {
+        auto access = m_inputMask->getImageAccess(ACCESS_READ);
+        switch(m_inputMask->getDataType()) {
+            fastSwitchTypeMacro(createIntegralImage<FAST_TYPE>((const FAST_TYPE*)access->get(), maskWidth, maskHeight, integral));
+        }
+    }
+
+    // The mask covers the entire level
+    const int levelWidth = m_inputImagePyramid->getLevelWidth(m_level);
+    const int levelHeight = m_inputImagePyramid->getLevelHeight(m_level);
+    const float scaleX = (float)maskWidth / levelWidth;
+    const float scaleY = (float)maskHeight / levelHeight;
+    std::vector<std::pair<float, Vector2i>> foregroundPatches;
+    for(int patchY = 0; patchY < patchesY; ++patchY) {
+        const int startY = std::min(maskHeight - 1, (int)std::floor(patchY * m_height * scaleY));
+        const int endY = std::max(startY + 1, std::min(maskHeight, (int)std::ceil(std::min((patchY + 1) * m_height, levelHeight) * scaleY)));
+        for(int patchX = 0; patchX < patchesX; ++patchX) {
+            const int startX = std::min(maskWidth - 1, (int)std::floor(patchX * m_width * scaleX));
+            const int endX = std::max(startX + 1, std::min(maskWidth, (int)std::ceil(std::min((patchX + 1) * m_width, levelWidth) * scaleX)));
+            const uint32_t foreground = integral[endX + (std::size_t)endY*(maskWidth + 1)]
+                                        - integral[startX + (std::size_t)endY*(maskWidth + 1)]
+                                        - integral[endX + (std::size_t)startY*(maskWidth + 1)]
+                                        + integral[startX + (std::size_t)startY*(maskWidth + 1)];
+            const float fraction = (float)foreground / ((endX - startX)*(endY - startY));
+            if(fraction < m_maskThreshold)
+                continue;
+            foregroundPatches.push_back(std::make_pair(fraction, Vector2i(patchX, patchY)));
+        }
+    }
+    if(m_tissuePriority) {
+        // Stable sort, so that patches with the same fraction are still in row by row order
+        std::stable_sort(foregroundPatches.begin(), foregroundPatches.end(), [](const std::pair<float, Vector2i>& a, const std::pair<float, Vector2i>& b) {
+            return a.first > b.first;
+        });
+    }
+    for(auto&& patch : foregroundPatches)
+        patches.push_back(patch.second);
+    reportInfo() << "PatchGenerator skipping " << patchesX*patchesY - patches.size() << " of " << patchesX*patchesY << " patches as background" << reportEnd();
+    return patches;
+}
+
+void PatchGenerator::generatePyramidPatches() {
+    const int levelWidth = m_inputImagePyramid->getLevelWidth(m_level);
+    const int levelHeight = m_inputImagePyramid->getLevelHeight(m_level);
+    const int patchesX = std::ceil((float) levelWidth / m_width);
+    const int patchesY = std::ceil((float) levelHeight / m_height);
+
+    const std::vector<Vector2i> patches = createPatchList(patchesX, patchesY);
+    if(patches.empty())
+        throw Exception("PatchGenerator found no patches to generate. Is the mask empty?");
+    const int nrOfPatches = patches.size();
+    const int threads = std::max(1, std::min(m_threads, nrOfPatches));
+    const int prefetch = m_prefetch > 0 ? m_prefetch : std::max(threads*2, m_batchSize);
+
+    // Patches are read by a pool of threads, and output by this thread.
+    // Patches which have been read, but not output yet, indexed by position in the patch list
+    std::map<int, Image::pointer> finishedPatches;
+    std::mutex mutex;
+    std::condition_variable condition;
+    int nextPatch = 0;
+    int outputPatches = 0;
+    bool abort = false;
+    std::exception_ptr error;
+
+    auto readPatches = [&]() {
+        try {
+            auto access = m_inputImagePyramid->getAccess(ACCESS_READ);
+            while(true) {
+                int index;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    // Don't read too far ahead of the patches which have been output
+                    condition.wait(lock, [&]() { return abort || nextPatch < outputPatches + prefetch; });
+                    if(abort || nextPatch >= nrOfPatches)
+                        return;
+                    index = nextPatch;
+                    ++nextPatch;
+                }
+                const int patchX = patches[index].x();
+                const int patchY = patches[index].y();
                 int patchWidth = m_width;
                 if(patchX == patchesX - 1)
                     patchWidth = levelWidth - patchX * m_width - 1;
@@ -59,29 +170,7 @@ void PatchGenerator::generateStream() {
                 if(patchY == patchesY - 1)
                     patchHeight = levelHeight - patchY * m_height - 1;
 
-                if(m_inputMask) {
-                    // If a mask exist, check if this patch should be included or not
-                    // At least half of the patch should be clasified as foreground
-                    auto access = m_inputMask->getImageAccess(ACCESS_READ);
-                    auto croppedMask = m_inputMask->crop(
-                        Vector2i(
-                            round(m_inputMask->getWidth() * ((float)patchX / patchesX)),
-                            round(m_inputMask->getHeight() * ((float)patchY / patchesY))
-                        ),
-                        Vector2i(
-                            round(m_inputMask->getWidth() * (1.0f/patchesX)),
-                            round(m_inputMask->getHeight() * (1.0f/patchesY))
-                        )
-                    );
-                    float average = croppedMask->calculateAverageIntensity();
-                    if(average < 0.5) // At least half of the mask has to be foreground
-                        continue;
-                }
-                reportInfo() << "Generating patch " << patchX << " " << patchY << reportEnd();
-                auto access = m_inputImagePyramid->getAccess(ACCESS_READ);
-                auto patch = access->getPatchAsImage(m_level, patchX * m_width, patchY * m_height,
-                                                                  patchWidth,
-                                                                  patchHeight);
+                auto patch = access->getPatchAsImage(m_level, patchX * m_width, patchY * m_height, patchWidth, patchHeight);
 
                 // Store some frame data useful for patch stitching
                 patch->setFrameData("original-width", std::to_string(levelWidth));
@@ -93,31 +182,129 @@ void PatchGenerator::generateStream() {
                 patch->setFrameData("patch-height", std::to_string(m_height));
                 patch->setFrameData("patch-spacing-x", std::to_string(patch->getSpacing().x()));
                 patch->setFrameData("patch-spacing-y", std::to_string(patch->getSpacing().y()));
-
-                mRuntimeManager->stopRegularTimer("create patch");
-                try {
-                    if(previousPatch) {
-                        addOutputData(0, previousPatch);
-                        frameAdded();
-                    }
-                } catch(ThreadStopped &e) {
-                    std::unique_lock<std::mutex> lock(m_stopMutex);
-                    m_stop = true;
-                    break;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finishedPatches[index] = patch;
                 }
-                previousPatch = patch;
-                std::unique_lock<std::mutex> lock(m_stopMutex);
-                if(m_stop)
-                    break;
+                condition.notify_all();
             }
-            std::unique_lock<std::mutex> lock(m_stopMutex);
-            if(m_stop) {
-                //m_streamIsStarted = false;
-                m_firstFrameIsInserted = false;
-                break;
+        } catch(...) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!error)
+                    error = std::current_exception();
+                abort = true;
             }
+            condition.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for(int i = 0; i < threads; ++i)
+        workers.emplace_back(readPatches);
+
+    std::vector<Image::pointer> batchPatches;
+    while(true) {
+        Image::pointer patch;
+        bool lastPatch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() {
+                return abort || (m_ordered ? finishedPatches.count(outputPatches) > 0 : !finishedPatches.empty());
+            });
+            if(abort)
+                break;
+            auto next = m_ordered ? finishedPatches.find(outputPatches) : finishedPatches.begin();
+            patch = next->second;
+            finishedPatches.erase(next);
+            ++outputPatches;
+            lastPatch = outputPatches == nrOfPatches;
+        }
+        condition.notify_all();
+        reportInfo() << "Generating patch " << patch->getFrameData("patchid-x") << " " << patch->getFrameData("patchid-y") << reportEnd();
+
+        DataObject::pointer output = patch;
+        if(m_batchSize > 1) {
+            batchPatches.push_back(patch);
+            if(batchPatches.size() < m_batchSize && !lastPatch)
+                continue;
+            output = createBatch(batchPatches);
+            batchPatches.clear();
+        }
+        if(lastPatch)
+            output->setLastFrame(getNameOfClass());
+        try {
+            addOutputData(0, output);
+            frameAdded();
+        } catch(ThreadStopped &e) {
+            std::unique_lock<std::mutex> lock(m_stopMutex);
+            m_stop = true;
+        }
+        if(lastPatch)
+            break;
+        std::unique_lock<std::mutex> lock(m_stopMutex);
+        if(m_stop) {
+            m_firstFrameIsInserted = false;
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        abort = true;
+    }
+    condition.notify_all();
+    for(auto& worker : workers)
+        worker.join();
+    if(error)
+        std::rethrow_exception(error);
+}
+
+std::shared_ptr<Batch> PatchGenerator::createBatch(std::vector<Image::pointer> patches) {
+    auto batch = Batch::New();
+    if(m_padLastBatch && patches.size() < m_batchSize) {
+        // Fill the batch with copies of the last patch. Since they have the same patch id,
+        // results for these are simply written to the same place again when stitched.
+        const int padding = m_batchSize - patches.size();
+        batch->setFrameData("batch-padding", std::to_string(padding));
+        const auto lastPatch = patches.back();
+        for(int i = 0; i < padding; ++i)
+            patches.push_back(lastPatch);
+    }
+
+    // Patches at the right and bottom edge are smaller, and will be resized by the network.
+    // Thus only batches of full size patches can be put into a single image.
+    bool fullSize = true;
+    for(auto&& patch : patches) {
+        if(patch->getWidth() != m_width || patch->getHeight() != m_height) {
+            fullSize = false;
+            break;
         }
+    }
+    if(!fullSize) {
+        batch->create(patches);
+        return batch;
+    }
+
+    // Copy all patches into one 3D image with one slice per patch, so that it can be sent to the GPU at once
+    const int channels = patches[0]->getNrOfChannels();
+    const std::size_t patchSize = (std::size_t)m_width*m_height*channels;
+    auto data = make_uninitialized_unique<uchar[]>(patchSize*patches.size());
+    for(int i = 0; i < patches.size(); ++i) {
+        auto access = patches[i]->getImageAccess(ACCESS_READ);
+        std::memcpy(&data[i*patchSize], access->get(), patchSize);
+    }
+    auto stackedImage = Image::New();
+    stackedImage->create(m_width, m_height, patches.size(), TYPE_UINT8, channels, std::move(data));
+    batch->create(patches, stackedImage);
+    return batch;
+}
+
+void PatchGenerator::generateStream() {
+    if(m_inputImagePyramid) {
+        generatePyramidPatches();
+        reportInfo() << "Done generating patches" << reportEnd();
     } else if(m_inputVolume) {
+        Image::pointer previousPatch;
         // TODO Support patching in x and y direction as well for volumes. For now, only depth
         const int width = m_inputVolume->getWidth();
         const int height = m_inputVolume->getHeight();
@@ -158,17 +345,17 @@ void PatchGenerator::generateStream() {
             if(m_stop)
                 break;
         }
+        // Add final patch, and mark it has last frame
+        previousPatch->setLastFrame(getNameOfClass());
+        try {
+            addOutputData(0, previousPatch);
+        } catch(ThreadStopped &e) {
+
+        }
+        reportInfo() << "Done generating patches" << reportEnd();
     } else {
         throw Exception("Unsupported data object given to PatchGenerator");
     }
-    // Add final patch, and mark it has last frame
-    previousPatch->setLastFrame(getNameOfClass());
-    try {
-        addOutputData(0, previousPatch);
-    } catch(ThreadStopped &e) {
-
-    }
-    reportInfo() << "Done generating patches" << reportEnd();
 }
 
 void PatchGenerator::execute() {
@@ -200,4 +387,43 @@ void PatchGenerator::setPatchLevel(int level) {
     mIsModified = true;
 }
 
-}
\ No newline at end of file
+void PatchGenerator::setNumberOfThreads(int threads) {
+    if(threads <= 0)
+        throw Exception("Nr of threads in PatchGenerator must be larger than 0");
+    m_threads = threads;
+    mIsModified = true;
+}
+
+void PatchGenerator::setMaximumPrefetch(int patches) {
+    if(patches <= 0)
+        throw Exception("Maximum prefetch in PatchGenerator must be larger than 0");
+    m_prefetch = patches;
+    mIsModified = true;
+}
+
+void PatchGenerator::setBatchSize(int size, bool padLastBatch) {
+    if(size <= 0)
+        throw Exception("Batch size in PatchGenerator must be larger than 0");
+    m_batchSize = size;
+    m_padLastBatch = padLastBatch;
+    mIsModified = true;
+}
+
+void PatchGenerator::setMaskThreshold(float threshold) {
+    if(threshold < 0.0f || threshold > 1.0f)
+        throw Exception("Mask threshold in PatchGenerator must be between 0 and 1");
+    m_maskThreshold = threshold;
+    mIsModified = true;
+}
+
+void PatchGenerator::setTissuePriorityOrder(bool priority) {
+    m_tissuePriority = priority;
+    mIsModified = true;
+}
+
+void PatchGenerator::setOrderedOutput(bool ordered) {
+    m_ordered = ordered;
+    mIsModified = true;
+}
+
+}
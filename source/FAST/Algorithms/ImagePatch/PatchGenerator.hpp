@@ -3,17 +3,55 @@
 #include <FAST/ProcessObject.hpp>
 #include <FAST/Streamers/Streamer.hpp>
 #include <thread>
+#include <condition_variable>
 
 namespace fast {
 
 class ImagePyramid;
 class Image;
+class Batch;
 
 class FAST_EXPORT PatchGenerator : public Streamer {
     FAST_OBJECT(PatchGenerator)
     public:
         void setPatchSize(int width, int height, int depth = 1);
         void setPatchLevel(int level);
+        /**
+         * Set nr of threads used to read patches from an image pyramid.
+         * Default is the nr of cores.
+         */
+        void setNumberOfThreads(int threads);
+        /**
+         * Set the maximum nr of patches which may be read ahead of the patch currently being output.
+         * Default is two patches per thread.
+         */
+        void setMaximumPrefetch(int patches);
+        /**
+         * If ordered output is disabled, patches are output in the order they have been read,
+         * instead of row by row. The position of each patch is always given in the frame data patchid-x and patchid-y.
+         * Default is true.
+         */
+        void setOrderedOutput(bool ordered);
+        /**
+         * Output batches of patches from an image pyramid instead of single patches.
+         * The patches of a batch are also stored in a single 3D image, so that NeuralNetwork can transfer them at once.
+         * @param size Nr of patches in each batch. Default is 1, which means single patches are output.
+         * @param padLastBatch If true, the last batch is filled up with copies of the last patch to get the full size.
+         *      The nr of copies is given in the frame data batch-padding of the batch.
+         */
+        void setBatchSize(int size, bool padLastBatch = false);
+        /**
+         * Set the fraction of a patch which must be foreground in the mask for the patch to be generated.
+         * Patches below this threshold are skipped without reading the image pyramid. Default is 0.5.
+         * @param threshold Between 0 and 1
+         */
+        void setMaskThreshold(float threshold);
+        /**
+         * If enabled, patches are generated in order of decreasing foreground fraction in the mask,
+         * instead of row by row, so that the patches with most tissue are processed first.
+         * Default is false.
+         */
+        void setTissuePriorityOrder(bool priority);
         ~PatchGenerator();
         void loadAttributes() override;
     protected:
@@ -23,9 +61,24 @@ class FAST_EXPORT PatchGenerator : public Streamer {
         std::shared_ptr<Image> m_inputVolume;
         std::shared_ptr<Image> m_inputMask;
         int m_level;
+        int m_threads;
+        int m_prefetch = 0;
+        bool m_ordered = true;
+        int m_batchSize = 1;
+        bool m_padLastBatch = false;
+        float m_maskThreshold = 0.5f;
+        bool m_tissuePriority = false;
 
         void execute() override;
         void generateStream() override;
+        /**
+         * Find which patches to generate from the image pyramid, in row by row order.
+         * If a mask is given, only patches where the fraction of non-zero mask pixels is at least
+         * the mask threshold are included, optionally ordered by decreasing foreground fraction.
+         */
+        std::vector<Vector2i> createPatchList(int patchesX, int patchesY);
+        void generatePyramidPatches();
+        std::shared_ptr<Batch> createBatch(std::vector<std::shared_ptr<Image>> patches);
     private:
         PatchGenerator();
 };
@@ -176,20 +176,9 @@ void PatchStitcher::processImage(std::shared_ptr<Image> patch) {
                 cl::NullRange
             );
         } else {
-            //enableRuntimeMeasurements();
-            // Image pyramid, do it on CPU TODO: optimize somehow?
+            // Image pyramid, copy the patch into the tiles on the CPU, and update the lower resolution levels
             auto outputAccess = m_outputImagePyramid->getAccess(ACCESS_READ_WRITE);
-            auto patchAccess = patch->getImageAccess(ACCESS_READ);
-            //mRuntimeManager->startRegularTimer("copy patch");
-            const int maxY = std::min(endY, fullHeight);
-            const int maxX = std::min(endX, fullWidth);
-            for(int y = startY; y < maxY; ++y) {
-                for(int x = startX; x < maxX; ++x) {
-                    outputAccess->setScalarFast(x, y, 0, patchAccess->getScalarFast<uchar>(Vector2i(x - startX, y - startY)));
-                }
-            }
-            //mRuntimeManager->stopRegularTimer("copy patch");
-            //mRuntimeManager->getTiming("copy patch")->print();
+            outputAccess->setPatch(0, startX, startY, patch);
         }
     } else {
         // 3D
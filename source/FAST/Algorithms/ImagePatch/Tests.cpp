@@ -112,4 +112,133 @@ TEST_CASE("Patch generator, sticher and image to batch generator for WSI", "[fas
         std::cout << "Got a batch" << std::endl;
     } while(!batch->isLastFrame());
     std::cout << "Done" << std::endl;
-}
\ No newline at end of file
+}
+
+static std::vector<std::pair<int, int>> generatePatchIds(int threads, bool ordered) {
+    // ImagePyramid::create only adds levels of at least 4096 pixels. Level 0 has 4x4 patches.
+    auto pyramid = ImagePyramid::New();
+    pyramid->create(8192, 8192, 3);
+
+    auto generator = PatchGenerator::New();
+    generator->setPatchSize(2048, 2048);
+    generator->setNumberOfThreads(threads);
+    generator->setMaximumPrefetch(3);
+    generator->setOrderedOutput(ordered);
+    generator->setInputData(pyramid);
+    auto port = generator->getOutputPort();
+
+    std::vector<std::pair<int, int>> ids;
+    Image::pointer patch;
+    do {
+        generator->update();
+        patch = port->getNextFrame<Image>();
+        CHECK(patch->getNrOfChannels() == 3);
+        ids.push_back(std::make_pair(std::stoi(patch->getFrameData("patchid-x")), std::stoi(patch->getFrameData("patchid-y"))));
+    } while(!patch->isLastFrame());
+    return ids;
+}
+
+TEST_CASE("Patch generator with multiple threads outputs patches in order", "[fast][wsi][PatchGenerator]") {
+    auto ids = generatePatchIds(4, true);
+    REQUIRE(ids.size() == 16);
+    for(int i = 0; i < 16; ++i) {
+        CHECK(ids[i].first == i % 4);
+        CHECK(ids[i].second == i / 4);
+    }
+}
+
+TEST_CASE("Patch generator with multiple threads and unordered output outputs all patches", "[fast][wsi][PatchGenerator]") {
+    auto ids = generatePatchIds(4, false);
+    REQUIRE(ids.size() == 16);
+    std::sort(ids.begin(), ids.end());
+    CHECK(std::unique(ids.begin(), ids.end()) == ids.end());
+}
+
+TEST_CASE("Patch generator with batch output", "[fast][wsi][PatchGenerator][batch]") {
+    // Level 0 has 5x5 patches, where the last patch of each row and column is smaller
+    auto pyramid = ImagePyramid::New();
+    pyramid->create(9000, 9000, 3);
+
+    auto generator = PatchGenerator::New();
+    generator->setPatchSize(2048, 2048);
+    generator->setBatchSize(4, true);
+    generator->setInputData(pyramid);
+    auto port = generator->getOutputPort();
+
+    std::vector<Batch::pointer> batches;
+    do {
+        generator->update();
+        batches.push_back(port->getNextFrame<Batch>());
+    } while(!batches.back()->isLastFrame());
+
+    // 5x5 patches gives 6 full batches and 1 batch with one patch and 3 copies
+    REQUIRE(batches.size() == 7);
+    for(auto&& batch : batches) {
+        auto access = batch->getAccess(ACCESS_READ);
+        CHECK(access->getData().getSize() == 4);
+    }
+    CHECK(batches.back()->getFrameData("batch-padding") == "3");
+
+    // The first batch has only full size patches, and is thus also stored as a single 3D image
+    auto access = batches[0]->getAccess(ACCESS_READ);
+    auto stackedImage = access->getData().getStackedImage();
+    REQUIRE(stackedImage);
+    CHECK(stackedImage->getWidth() == 2048);
+    CHECK(stackedImage->getHeight() == 2048);
+    CHECK(stackedImage->getDepth() == 4);
+    CHECK(stackedImage->getNrOfChannels() == 3);
+
+    // The second batch contains the patch at the right edge, which is smaller
+    auto access2 = batches[1]->getAccess(ACCESS_READ);
+    CHECK_FALSE(access2->getData().getStackedImage());
+}
+
+static std::vector<std::pair<int, int>> generateMaskedPatchIds(float threshold, bool priority) {
+    auto pyramid = ImagePyramid::New();
+    pyramid->create(8192, 8192, 3);
+
+    // Mask covering the entire level, which has 4x4 patches of 16x16 mask pixels
+    auto mask = Image::New();
+    mask->create(64, 64, TYPE_UINT8, 1);
+    mask->fill(0);
+    {
+        auto access = mask->getImageAccess(ACCESS_READ_WRITE);
+        auto data = (uchar*)access->get();
+        // Patch 1,1 is all foreground
+        for(int y = 16; y < 32; ++y)
+            for(int x = 16; x < 32; ++x)
+                data[x + y*64] = 1;
+        // Patch 2,3 is 5/16 foreground
+        for(int y = 48; y < 53; ++y)
+            for(int x = 32; x < 48; ++x)
+                data[x + y*64] = 1;
+        // Patch 0,0 has a few pixels of foreground
+        for(int x = 0; x < 10; ++x)
+            data[x] = 1;
+    }
+
+    auto generator = PatchGenerator::New();
+    generator->setPatchSize(2048, 2048);
+    generator->setMaskThreshold(threshold);
+    generator->setTissuePriorityOrder(priority);
+    generator->setInputData(0, pyramid);
+    generator->setInputData(1, mask);
+    auto port = generator->getOutputPort();
+
+    std::vector<std::pair<int, int>> ids;
+    Image::pointer patch;
+    do {
+        generator->update();
+        patch = port->getNextFrame<Image>();
+        ids.push_back(std::make_pair(std::stoi(patch->getFrameData("patchid-x")), std::stoi(patch->getFrameData("patchid-y"))));
+    } while(!patch->isLastFrame());
+    return ids;
+}
+
+TEST_CASE("Patch generator skips background patches of mask", "[fast][wsi][PatchGenerator]") {
+    CHECK(generateMaskedPatchIds(0.5f, false) == std::vector<std::pair<int, int>>({{1, 1}}));
+    CHECK(generateMaskedPatchIds(0.01f, false) == std::vector<std::pair<int, int>>({{0, 0}, {1, 1}, {2, 3}}));
+    // Patches with most foreground first
+    CHECK(generateMaskedPatchIds(0.01f, true) == std::vector<std::pair<int, int>>({{1, 1}, {2, 3}, {0, 0}}));
+    CHECK_THROWS(PatchGenerator::New()->setMaskThreshold(1.5f));
+}
@@ -1,5 +1,6 @@
 #include "FAST/Algorithms/IterativeClosestPoint/IterativeClosestPoint.hpp"
 #include "FAST/SceneGraph.hpp"
+#include "FAST/Algorithms/KDTree/KDTree.hpp"
 #undef min
 #undef max
 #include <limits>
@@ -68,44 +69,30 @@ inline Vector3f RGB2YIQ(Vector3f rgb) {
 }
 
 /**
- * Create a new matrix which is matrix A rearranged.
- * This matrix has the same size as B
+ * Create the feature vectors used to match points: The position and
+ * the weighted color in YIQ color space, one point per column.
  */
-inline MatrixXf rearrangeMatrixToClosestPoints(const MatrixXf& A, const MatrixXf& B, const MatrixXf& Acolors, const MatrixXf& Bcolors, float colorWeight) {
-    MatrixXf result = MatrixXf::Constant(B.rows(), B.cols(), 0);
+inline MatrixXf getMatchingFeatures(const MatrixXf& points, const MatrixXf& colors) {
+    const Vector3f colorWeights(100.0, 1000.0, 1000.0);
+    MatrixXf features(6, points.cols());
+    features.topRows(3) = points;
+    for(int i = 0; i < points.cols(); ++i)
+        features.col(i).tail(3) = RGB2YIQ(colors.col(i)).cwiseProduct(colorWeights);
+    return features;
+}
 
-    Vector3f colorWeights(100.0, 1000.0, 1000.0);
+/**
+ * Create a new matrix which is matrix A rearranged, using a KDTree of the features of A.
+ * This matrix has the same size as B
+ */
+inline MatrixXf rearrangeMatrixToClosestPoints(const MatrixXf& A, const KDTree& treeA, const MatrixXf& Bfeatures) {
     // For each point in B, find the closest point in A
-#pragma omp parallel for
-    for(int b = 0; b < B.cols(); ++b) {
-        Vector3f pointInB = B.col(b);
-        Vector3f Bcolor = RGB2YIQ(Bcolors.col(b));
-        float minDistance = std::numeric_limits<float>::max();
-        uint closestPoint = 0;
-        for(int a = 0; a < A.cols(); ++a) {
-            Vector3f pointInA = A.col(a);
-            Vector3f Acolor = RGB2YIQ(Acolors.col(a));
-            VectorXf distanceVector = VectorXf::Zero(6);
-            distanceVector.head(3) = pointInA - pointInB;
-            distanceVector(3) = (Acolor.x() - Bcolor.x())*colorWeights.x();
-            distanceVector(4) = (Acolor.y() - Bcolor.y())*colorWeights.y();
-            distanceVector(5) = (Acolor.z() - Bcolor.z())*colorWeights.z();
-            //std::cout << distanceVector.tail(3) << std::endl;
-            float distance = distanceVector.norm();
-            //float distance = (pointInA-pointInB).norm();
-            //std::cout << colorDistance(Acolor, Bcolor) << std::endl;
-            //if(colorDistance(Acolor, Bcolor) < 100) {
-                if(distance < minDistance) {
-                    minDistance = distance;
-                    closestPoint = a;
-                }
-            //}
-        }
-        result.col(b) = A.col(closestPoint);
-    }
+    const VectorXi closestPoints = treeA.findNearestPoints(Bfeatures);
+    MatrixXf result(A.rows(), Bfeatures.cols());
+    for(int b = 0; b < Bfeatures.cols(); ++b)
+        result.col(b) = A.col(closestPoints(b));
 
     return result;
-
 }
 
 /*
@@ -242,14 +229,18 @@ void IterativeClosestPoint::execute() {
     }
     fixedPoints = fixedPointTransform*fixedPoints.colwise().homogeneous();
 
-    float colorWeight = 1.0f;
+    // The fixed points don't move, thus the search tree is only built once
+    mRuntimeManager->startRegularTimer("build_tree");
+    const KDTree fixedTree(getMatchingFeatures(fixedPoints, fixedColors));
+    mRuntimeManager->stopRegularTimer("build_tree");
+    MatrixXf movedFeatures = getMatchingFeatures(movingPoints, movingColors);
 
     // Want to choose the smallest one as moving
     bool invertTransform = false;
 	MatrixXf movedPoints = currentTransformation*(movingPoints.colwise().homogeneous());
     // Match closest points using current transformation
-    MatrixXf rearrangedFixedPoints = rearrangeMatrixToClosestPoints(
-            fixedPoints, movedPoints, fixedColors, movingColors, colorWeight);
+    movedFeatures.topRows(3) = movedPoints;
+    MatrixXf rearrangedFixedPoints = rearrangeMatrixToClosestPoints(fixedPoints, fixedTree, movedFeatures);
     do {
         previousError = error;        
 
@@ -300,8 +291,8 @@ void IterativeClosestPoint::execute() {
         // Calculate RMS error
         // Should we rearrange the points here?
         mRuntimeManager->startRegularTimer("find_closest");
-        rearrangedFixedPoints = rearrangeMatrixToClosestPoints(
-                fixedPoints, movedPoints, fixedColors, movingColors, colorWeight);
+        movedFeatures.topRows(3) = movedPoints;
+        rearrangedFixedPoints = rearrangeMatrixToClosestPoints(fixedPoints, fixedTree, movedFeatures);
         mRuntimeManager->stopRegularTimer("find_closest");
 		MatrixXf distance = rearrangedFixedPoints - movedPoints;
         error = 0;
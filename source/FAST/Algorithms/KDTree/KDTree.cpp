@@ -0,0 +1,158 @@
+#include "KDTree.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace fast {
+
+KDTree::KDTree(const MatrixXf& points, int leafSize) {
+    if(leafSize < 1)
+        throw Exception("Leaf size of KDTree must be at least 1");
+    m_leafSize = leafSize;
+    m_points = points;
+    m_indices.resize(points.cols());
+    for(int i = 0; i < points.cols(); ++i)
+        m_indices[i] = i;
+    if(points.cols() > 0) {
+        m_nodes.reserve(2 * (points.cols() / leafSize + 1));
+        build(0, points.cols());
+        // Store points in the same order as the nodes
+        for(int i = 0; i < points.cols(); ++i)
+            m_points.col(i) = points.col(m_indices[i]);
+    }
+}
+
+int KDTree::build(int begin, int end) {
+    const int nodeIndex = m_nodes.size();
+    m_nodes.emplace_back();
+    m_nodes[nodeIndex].begin = begin;
+    m_nodes[nodeIndex].end = end;
+    if(end - begin <= m_leafSize)
+        return nodeIndex;
+
+    // Split on the dimension with largest extent
+    VectorXf minimum = VectorXf::Constant(m_points.rows(), std::numeric_limits<float>::max());
+    VectorXf maximum = VectorXf::Constant(m_points.rows(), std::numeric_limits<float>::lowest());
+    for(int i = begin; i < end; ++i) {
+        minimum = minimum.cwiseMin(m_points.col(m_indices[i]));
+        maximum = maximum.cwiseMax(m_points.col(m_indices[i]));
+    }
+    int dimension;
+    const float extent = (maximum - minimum).maxCoeff(&dimension);
+    if(extent <= 0) // All points are equal
+        return nodeIndex;
+
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(m_indices.begin() + begin, m_indices.begin() + middle, m_indices.begin() + end, [this, dimension](int a, int b) {
+        return m_points(dimension, a) < m_points(dimension, b);
+    });
+    const float splitValue = m_points(dimension, m_indices[middle]);
+    const int left = build(begin, middle);
+    const int right = build(middle, end);
+    Node& node = m_nodes[nodeIndex];
+    node.left = left;
+    node.right = right;
+    node.splitDimension = dimension;
+    node.splitValue = splitValue;
+    return nodeIndex;
+}
+
+int KDTree::getNrOfPoints() const {
+    return m_points.cols();
+}
+
+int KDTree::getNrOfDimensions() const {
+    return m_points.rows();
+}
+
+void KDTree::findNearest(const float* query, int nodeIndex, int& bestIndex, float& bestDistance) const {
+    const Node& node = m_nodes[nodeIndex];
+    if(node.left < 0) {
+        const int dimensions = m_points.rows();
+        for(int i = node.begin; i < node.end; ++i) {
+            const float* point = m_points.data() + (std::size_t)i * dimensions;
+            float distance = 0;
+            for(int d = 0; d < dimensions; ++d) {
+                const float difference = point[d] - query[d];
+                distance += difference * difference;
+            }
+            if(distance < bestDistance || (distance == bestDistance && m_indices[i] < bestIndex)) {
+                bestDistance = distance;
+                bestIndex = m_indices[i];
+            }
+        }
+        return;
+    }
+
+    // Visit the side of the query point first. The other side only needs to be visited if
+    // the splitting plane is closer than the best point found so far.
+    const float planeDistance = query[node.splitDimension] - node.splitValue;
+    const int nearChild = planeDistance < 0 ? node.left : node.right;
+    const int farChild = planeDistance < 0 ? node.right : node.left;
+    findNearest(query, nearChild, bestIndex, bestDistance);
+    if(planeDistance * planeDistance <= bestDistance)
+        findNearest(query, farChild, bestIndex, bestDistance);
+}
+
+int KDTree::findNearest(const VectorXf& query, float* squaredDistance) const {
+    if(query.size() != m_points.rows())
+        throw Exception("Query point has wrong nr of dimensions in KDTree::findNearest");
+    int bestIndex = -1;
+    float bestDistance = std::numeric_limits<float>::max();
+    if(!m_nodes.empty())
+        findNearest(query.data(), 0, bestIndex, bestDistance);
+    if(squaredDistance != nullptr)
+        *squaredDistance = bestDistance;
+    return bestIndex;
+}
+
+VectorXi KDTree::findNearestPoints(const MatrixXf& queries) const {
+    if(queries.rows() != m_points.rows())
+        throw Exception("Query points have wrong nr of dimensions in KDTree::findNearestPoints");
+    VectorXi result = VectorXi::Constant(queries.cols(), -1);
+    if(m_nodes.empty())
+        return result;
+#pragma omp parallel for schedule(dynamic, 256)
+    for(int i = 0; i < queries.cols(); ++i) {
+        int bestIndex = -1;
+        float bestDistance = std::numeric_limits<float>::max();
+        findNearest(queries.data() + (std::size_t)i * queries.rows(), 0, bestIndex, bestDistance);
+        result(i) = bestIndex;
+    }
+    return result;
+}
+
+void KDTree::findWithinRadius(const float* query, int nodeIndex, float squaredRadius, std::vector<int>& result) const {
+    const Node& node = m_nodes[nodeIndex];
+    if(node.left < 0) {
+        const int dimensions = m_points.rows();
+        for(int i = node.begin; i < node.end; ++i) {
+            const float* point = m_points.data() + (std::size_t)i * dimensions;
+            float distance = 0;
+            for(int d = 0; d < dimensions; ++d) {
+                const float difference = point[d] - query[d];
+                distance += difference * difference;
+            }
+            if(distance <= squaredRadius)
+                result.push_back(m_indices[i]);
+        }
+        return;
+    }
+
+    const float planeDistance = query[node.splitDimension] - node.splitValue;
+    if(planeDistance < 0 || planeDistance * planeDistance <= squaredRadius)
+        findWithinRadius(query, node.left, squaredRadius, result);
+    if(planeDistance >= 0 || planeDistance * planeDistance <= squaredRadius)
+        findWithinRadius(query, node.right, squaredRadius, result);
+}
+
+std::vector<int> KDTree::findWithinRadius(const VectorXf& query, float radius) const {
+    if(query.size() != m_points.rows())
+        throw Exception("Query point has wrong nr of dimensions in KDTree::findWithinRadius");
+    std::vector<int> result;
+    if(!m_nodes.empty())
+        findWithinRadius(query.data(), 0, radius * radius, result);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <FAST/Object.hpp>
+#include <FAST/Data/DataTypes.hpp>
+
+namespace fast {
+
+/**
+ * K-d tree for nearest neighbour search in a fixed set of points.
+ * The tree is built once, and can then be queried many times, e.g. for every iteration
+ * of a registration algorithm such as IterativeClosestPoint.
+ *
+ * Points can have any nr of dimensions. This makes it possible to include other features than
+ * the position, such as a weighted color, in the distance.
+ */
+class FAST_EXPORT KDTree : public Object {
+    public:
+        typedef std::shared_ptr<KDTree> pointer;
+        /**
+         * Build a tree of the given points.
+         * @param points Matrix with one point per column (dimensions x N)
+         * @param leafSize Maximum nr of points in each leaf node
+         */
+        KDTree(const MatrixXf& points, int leafSize = 16);
+        int getNrOfPoints() const;
+        int getNrOfDimensions() const;
+        /**
+         * Find the point closest to the query point. If several points are equally close,
+         * the one with the lowest index is returned.
+         * @param query Query point with getNrOfDimensions() elements
+         * @param squaredDistance If not nullptr, the squared distance to the closest point is stored here
+         * @return column index of the closest point, or -1 if the tree is empty
+         */
+        int findNearest(const VectorXf& query, float* squaredDistance = nullptr) const;
+        /**
+         * Find the closest point of every column in queries. Queries are processed in parallel.
+         * @param queries Matrix with one query point per column
+         * @return column index of the closest point of every query point
+         */
+        VectorXi findNearestPoints(const MatrixXf& queries) const;
+        /**
+         * Find all points within a given radius of the query point
+         * @return column indices of the points, sorted in increasing order
+         */
+        std::vector<int> findWithinRadius(const VectorXf& query, float radius) const;
+    private:
+        struct Node {
+            // Range in m_points and m_indices
+            int begin;
+            int end;
+            // Child node indices, -1 for leaf nodes
+            int left = -1;
+            int right = -1;
+            int splitDimension = 0;
+            float splitValue = 0;
+        };
+        int build(int begin, int end);
+        void findNearest(const float* query, int node, int& bestIndex, float& bestDistance) const;
+        void findWithinRadius(const float* query, int node, float squaredRadius, std::vector<int>& result) const;
+
+        // Points reordered so that the points of each node are contiguous in memory
+        MatrixXf m_points;
+        // Original index of every column of m_points
+        std::vector<int> m_indices;
+        std::vector<Node> m_nodes;
+        int m_leafSize;
+};
+
+}
@@ -0,0 +1,80 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Algorithms/KDTree/KDTree.hpp"
+#include <random>
+
+namespace fast {
+
+static int bruteForceNearest(const MatrixXf& points, const VectorXf& query) {
+    int bestIndex = -1;
+    float bestDistance = std::numeric_limits<float>::max();
+    for(int i = 0; i < points.cols(); ++i) {
+        const float distance = (points.col(i) - query).squaredNorm();
+        if(distance < bestDistance) {
+            bestDistance = distance;
+            bestIndex = i;
+        }
+    }
+    return bestIndex;
+}
+
+TEST_CASE("KDTree nearest neighbour gives same result as brute force", "[fast][KDTree]") {
+    std::default_random_engine engine(42);
+    std::uniform_real_distribution<float> distribution(-10, 10);
+    for(int dimensions : {3, 6}) {
+        MatrixXf points(dimensions, 2000);
+        MatrixXf queries(dimensions, 500);
+        for(int i = 0; i < points.size(); ++i)
+            points.data()[i] = distribution(engine);
+        for(int i = 0; i < queries.size(); ++i)
+            queries.data()[i] = distribution(engine);
+
+        KDTree tree(points, 8);
+        CHECK(tree.getNrOfPoints() == 2000);
+        CHECK(tree.getNrOfDimensions() == dimensions);
+        VectorXi result = tree.findNearestPoints(queries);
+        for(int i = 0; i < queries.cols(); ++i) {
+            const int expected = bruteForceNearest(points, queries.col(i));
+            CHECK(result(i) == expected);
+            float distance;
+            CHECK(tree.findNearest(queries.col(i), &distance) == expected);
+            CHECK(distance == Approx((points.col(expected) - queries.col(i)).squaredNorm()));
+        }
+    }
+}
+
+TEST_CASE("KDTree with duplicate points returns lowest index", "[fast][KDTree]") {
+    MatrixXf points = MatrixXf::Zero(3, 100);
+    points.col(50) = Vector3f(5, 5, 5);
+    KDTree tree(points, 4);
+    CHECK(tree.findNearest(Vector3f(0.1, 0, 0)) == 0);
+    CHECK(tree.findNearest(Vector3f(4, 4, 4)) == 50);
+}
+
+TEST_CASE("KDTree radius search", "[fast][KDTree]") {
+    MatrixXf points(3, 10*10*10);
+    int counter = 0;
+    for(int z = 0; z < 10; ++z) {
+        for(int y = 0; y < 10; ++y) {
+            for(int x = 0; x < 10; ++x) {
+                points.col(counter) = Vector3f(x, y, z);
+                ++counter;
+            }
+        }
+    }
+    KDTree tree(points);
+    // Center point and its 6 neighbours
+    std::vector<int> result = tree.findWithinRadius(Vector3f(5, 5, 5), 1.0f);
+    REQUIRE(result.size() == 7);
+    CHECK(result[3] == 555);
+    CHECK(tree.findWithinRadius(Vector3f(-5, -5, -5), 1.0f).empty());
+}
+
+TEST_CASE("KDTree with no points and wrong query size", "[fast][KDTree]") {
+    KDTree empty(MatrixXf::Zero(3, 0));
+    CHECK(empty.findNearest(Vector3f(0, 0, 0)) == -1);
+    KDTree tree(MatrixXf::Zero(3, 10));
+    CHECK_THROWS(tree.findNearest(Vector2f(0, 0)));
+    CHECK_THROWS(KDTree(MatrixXf::Zero(3, 10), 0));
+}
+
+}
@@ -12,10 +12,13 @@ __kernel void normalize2DInput(
 	__private float minIntensity,
 	__private float maxIntensity,
 	__private int clipIntensity,
-	__private int channelFirst
+	__private int channelFirst,
+	__private int outputOffset
 	) {
 	
 	const int2 pos = {get_global_id(0), get_global_id(1)};
+	// Images of a batch are written one after another into the same output buffer
+	output += outputOffset;
 	const int dataType = get_image_channel_data_type(input);
 	float4 value;
 	if(dataType == CLK_FLOAT) {
@@ -75,10 +78,12 @@ __kernel void normalize3DInput(
 	__private float minIntensity,
 	__private float maxIntensity,
 	__private int clipIntensity,
-	__private int channelFirst
+	__private int channelFirst,
+	__private int outputOffset
 	) {
 
 	const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
+	output += outputOffset;
 	const int dataType = get_image_channel_data_type(input);
 	float4 value;
 	if(dataType == CLK_FLOAT) {
@@ -119,4 +124,63 @@ __kernel void normalize3DInput(
         if(channels > 3)
             output[position + 3*width*height*depth] = value.w;
     }
-}
\ No newline at end of file
+}
+// Same as normalize2DInput, except that all images of a batch are given as slices of one 3D image
+__kernel void normalize2DInputBatch(
+	__read_only image3d_t input,
+	__global float* output,
+	__private float scaleFactor,
+	__private float mean,
+	__private float std,
+	__private int signedInputNormalization,
+	__private int horizontalFlip,
+	__private int channels,
+	__private float minIntensity,
+	__private float maxIntensity,
+	__private int clipIntensity,
+	__private int channelFirst,
+	__private int outputOffset
+	) {
+
+	const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
+	const int width = get_global_size(0);
+	const int height = get_global_size(1);
+	output += outputOffset + pos.z*width*height*channels;
+	const int dataType = get_image_channel_data_type(input);
+	float4 value;
+	if(dataType == CLK_FLOAT) {
+		value = read_imagef(input, sampler, pos);
+	} else if(dataType == CLK_SIGNED_INT8 || dataType == CLK_SIGNED_INT16) {
+		value = convert_float4(read_imagei(input, sampler, pos));
+	} else {
+		value = convert_float4(read_imageui(input, sampler, pos));
+	}
+
+	if(clipIntensity)
+	    value = clamp(value, minIntensity, maxIntensity);
+	value = (value - mean)/std;
+    value = value*scaleFactor;
+    if(signedInputNormalization) {
+        value = value*2 - 1;
+	}
+
+    if(channelFirst == 0) {
+        int position = (pos.x + pos.y*width)*channels;
+        output[position] = value.x;
+        if(channels > 1)
+            output[position+1] = value.y;
+        if(channels > 2)
+            output[position+2] = value.z;
+        if(channels > 3)
+            output[position+3] = value.w;
+    } else {
+        int position = pos.x + pos.y*width;
+        output[position] = value.x;
+        if(channels > 1)
+            output[position + 1*width*height] = value.y;
+        if(channels > 2)
+            output[position + 2*width*height] = value.z;
+        if(channels > 3)
+            output[position + 3*width*height] = value.w;
+    }
+}
@@ -3,6 +3,7 @@
 #include "FAST/Data/Tensor.hpp"
 #include "FAST/Algorithms/ImageResizer/ImageResizer.hpp"
 #include "InferenceEngineManager.hpp"
+#include <FAST/Streamers/Streamer.hpp>
 
 
 namespace fast {
@@ -35,6 +36,7 @@ void NeuralNetwork::loadAttributes() {
     setScaleFactor(getFloatAttribute("scale-factor"));
     setSignedInputNormalization(getBooleanAttribute("signed-input-normalization"));
     setPreserveAspectRatio(getBooleanAttribute("preserve-aspect"));
+    setPipelineDepth(getIntegerAttribute("pipeline-depth"));
 
     auto sizes = getStringAttribute("input-size");
     if(!sizes.empty()) {
@@ -68,20 +70,15 @@ NeuralNetwork::NeuralNetwork() {
 	createStringAttribute("output-names", "Output names", "Name of output nodes", "");
 	createBooleanAttribute("signed-input-normalization", "Signed input normalization", "Normalize input to -1 and 1 instead of 0 to 1.", false);
     createBooleanAttribute("preserve-aspect", "Preserve aspect ratio of input images", "", mPreserveAspectRatio);
+    createIntegerAttribute("pipeline-depth", "Pipeline depth", "Maximum nr of batches in flight when inputs are streamed. 1 disables pipelining.", m_pipelineDepth);
 
 	m_engine = InferenceEngineManager::loadBestAvailableEngine();
 	reportInfo() << "Inference engine " << m_engine->getName() << " selected" << reportEnd();
 }
 
-std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData() {
-    std::unordered_map<std::string, Tensor::pointer> tensors;
-    m_batchSize = -1;
+void NeuralNetwork::updateNodes() {
     for(auto inputNode : m_engine->getInputNodes()) {
         auto shape = inputNode.second.shape;
-        if(shape.getDimensions() == 0)
-            throw Exception("Unable to deduce input shape from network file. "
-                            "Either export the file with shape information or supply the input shape manually using setInputNode.");
-
         if(mInputSizes.count("") > 0) {
             auto sizes = mInputSizes[""];
             for(int i = 0; i < sizes.size(); ++i) {
@@ -95,6 +92,23 @@ std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData
             }
             m_engine->setInputNodeShape(inputNode.first, shape);
         }
+    }
+    m_inputNodes = m_engine->getInputNodes();
+    m_outputNodes = m_engine->getOutputNodes();
+    m_imageOrdering = m_engine->getPreferredImageOrdering();
+}
+
+std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData() {
+    // When pipelining, the engine is only used by the inference thread, and the nodes were copied before it started
+    if(!m_inferenceThread.joinable())
+        updateNodes();
+    std::unordered_map<std::string, Tensor::pointer> tensors;
+    m_batchSize = -1;
+    for(auto inputNode : m_inputNodes) {
+        auto shape = inputNode.second.shape;
+        if(shape.getDimensions() == 0)
+            throw Exception("Unable to deduce input shape from network file. "
+                            "Either export the file with shape information or supply the input shape manually using setInputNode.");
 
         std::shared_ptr<DataObject> data = getInputData<DataObject>(inputNode.second.portID);
         mRuntimeManager->startRegularTimer("input_processing");
@@ -110,11 +124,13 @@ std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData
             Batch::pointer batch = std::dynamic_pointer_cast<Batch>(data);
             std::vector<Image::pointer> inputImages;
             std::vector<Tensor::pointer> inputTensors;
+            Image::pointer stackedImage;
             if(batch) {
                 Batch::access access = batch->getAccess(ACCESS_READ);
                 auto dataList = access->getData();
                 if(dataList.isImages()) {
                     inputImages = dataList.getImages();
+                    stackedImage = dataList.getStackedImage();
                 } else {
                     inputTensors = dataList.getTensors();
                 }
@@ -175,7 +191,7 @@ std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData
                 const int dims = shape.getDimensions();
                 int height = shape[dims - 3];
                 int width = shape[dims - 2];
-                if(m_engine->getPreferredImageOrdering() == ImageOrdering::ChannelFirst) {
+                if(m_imageOrdering == ImageOrdering::ChannelFirst) {
                     height = shape[dims - 2];
                     width = shape[dims - 1];
                 }
@@ -185,18 +201,21 @@ std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData
                     // Temporal input
                     timesteps = shape[1];
                     if(dims == 6) // 3D
-                        depth = m_engine->getPreferredImageOrdering() == ImageOrdering::ChannelLast ? shape[dims - 4] : shape[
+                        depth = m_imageOrdering == ImageOrdering::ChannelLast ? shape[dims - 4] : shape[
                                 dims - 3];
                 } else {
                     if(dims == 5) // 3D
-                        depth = m_engine->getPreferredImageOrdering() == ImageOrdering::ChannelLast ? shape[dims - 4] : shape[
+                        depth = m_imageOrdering == ImageOrdering::ChannelLast ? shape[dims - 4] : shape[
                                 dims - 3];
                 }
                 auto inputImages2 = resizeImages(inputImages, width, height, depth);
+                // The stacked image of a batch can only be used if none of the images were resized
+                if(inputImages2 != inputImages)
+                    stackedImage.reset();
 
                 // Convert images to tensors
                 shape[0] = m_batchSize;
-                tensors[inputNode.first] = convertImagesToTensor(inputImages2, shape, containsSequence);
+                tensors[inputNode.first] = convertImagesToTensor(inputImages2, shape, containsSequence, stackedImage);
             } else {
                 // TODO fix ordering if necessary
                 // We have a list of tensors, convert the list of tensors into a single tensor
@@ -244,21 +263,32 @@ void NeuralNetwork::run() {
 }
 
 void NeuralNetwork::execute() {
+    if(m_pipelineDepth > 1 && inputsAreStreamed()) {
+        executePipelined();
+        return;
+    }
+
     // Load, prepare input and run network
     run();
 
+    std::unordered_map<std::string, Tensor::pointer> tensors;
+    for(const auto &node : m_engine->getOutputNodes())
+        tensors[node.first] = m_engine->getOutputData(node.first);
+    addOutputTensors(tensors, m_batchSize, mInputImages);
+}
+
+void NeuralNetwork::addOutputTensors(std::unordered_map<std::string, Tensor::pointer> tensors, int batchSize,
+        const std::unordered_map<std::string, std::vector<std::shared_ptr<Image>>>& inputImages) {
     mRuntimeManager->startRegularTimer("output_processing");
 	// Collect output data of network and add to output ports
-    for(const auto &node : m_engine->getOutputNodes()) {
+    for(const auto &node : m_outputNodes) {
         // TODO if input was a batch, the output should be converted to a batch as well
         // TODO and any frame data (such as patch info should be transferred)
-        auto tensor = m_engine->getOutputData(node.first);
+        auto tensor = tensors.at(node.first);
 
-        if(m_batchSize > 1) {
-            // Create a batch of tensors
+        if(batchSize > 1) {
+            // Create a batch of tensors, each being a view of the output tensor to avoid copying
             std::vector<Tensor::pointer> tensorList;
-            auto tensorAccess = tensor->getAccess(ACCESS_READ);
-            const float* rawTensorData = tensorAccess->getRawData();
             // Calculate sample size
             auto shape = tensor->getShape();
             int size = 1;
@@ -268,18 +298,18 @@ void NeuralNetwork::execute() {
                 newShape.addDimension(shape[i]);
             }
 
-            for(int i = 0; i < m_batchSize; ++i) {
+            for(int i = 0; i < batchSize; ++i) {
                 auto newTensor = Tensor::New();
-                auto newData = make_uninitialized_unique<float[]>(size);
-                std::memcpy(newData.get(), &(rawTensorData[i*size]), size*sizeof(float));
-                newTensor->create(std::move(newData), newShape);
+                newTensor->createView(tensor, (std::size_t)i*size, newShape);
                 tensorList.push_back(newTensor);
-                for(auto& inputNode : m_engine->getInputNodes()) {
+                for(auto& inputNode : m_inputNodes) {
                     // TODO assuming input are images here:
-                    for(auto &&frameData : mInputImages[inputNode.first][i]->getFrameData()) {
+                    if(inputImages.count(inputNode.first) == 0)
+                        continue;
+                    for(auto &&frameData : inputImages.at(inputNode.first)[i]->getFrameData()) {
                         newTensor->setFrameData(frameData.first, frameData.second);
                     }
-                    for(auto &&lastFrame : mInputImages[inputNode.first][i]->getLastFrame())
+                    for(auto &&lastFrame : inputImages.at(inputNode.first)[i]->getLastFrame())
                         newTensor->setLastFrame(lastFrame);
                 }
             }
@@ -289,12 +319,14 @@ void NeuralNetwork::execute() {
         } else {
             // Remove first dimension as it is 1, due to batch size 1
             tensor->deleteDimension(0);
-            for(auto& inputNode : m_engine->getInputNodes()) {
+            for(auto& inputNode : m_inputNodes) {
                 // TODO assuming input are images here: Should also be able to handle tensors
-                for(auto &&frameData : mInputImages[inputNode.first][0]->getFrameData()) {
+                if(inputImages.count(inputNode.first) == 0)
+                    continue;
+                for(auto &&frameData : inputImages.at(inputNode.first)[0]->getFrameData()) {
                     tensor->setFrameData(frameData.first, frameData.second);
                 }
-                for(auto &&lastFrame : mInputImages[inputNode.first][0]->getLastFrame())
+                for(auto &&lastFrame : inputImages.at(inputNode.first)[0]->getLastFrame())
                     tensor->setLastFrame(lastFrame);
             }
             addOutputData(node.second.portID, tensor);
@@ -303,7 +335,98 @@ void NeuralNetwork::execute() {
     mRuntimeManager->stopRegularTimer("output_processing");
 }
 
-Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer> images, const TensorShape& shape, bool temporal) {
+void NeuralNetwork::executePipelined() {
+    if(!m_engine->isLoaded())
+        m_engine->load();
+    if(!m_inferenceThread.joinable()) {
+        // Copy the nodes, since the engine can't be used by this thread while the inference thread runs
+        updateNodes();
+        m_stopInferenceThread = false;
+        m_inferenceThread = std::thread(&NeuralNetwork::inferenceThread, this);
+    }
+
+    // Preprocess the current batch, and read ahead until the pipeline is full.
+    // Each batch is given to the inference thread as soon as it is ready, thus the
+    // next batches are preprocessed while the inference engine runs.
+    while(m_pipeline.size() < m_pipelineDepth && (m_pipeline.empty() || !m_pipeline.back().endOfStream)) {
+        auto inputTensors = processInputData();
+        PipelineJob job;
+        job.batchSize = m_batchSize;
+        job.inputImages = mInputImages;
+        job.frameData = m_frameData;
+        job.lastFrame = m_lastFrame;
+        job.endOfStream = isEndOfStream();
+
+        std::packaged_task<std::unordered_map<std::string, Tensor::pointer>()> task([this, inputTensors]() {
+            for(const auto &node : m_engine->getInputNodes())
+                m_engine->setInputData(node.first, inputTensors.at(node.first));
+            m_engine->run();
+            std::unordered_map<std::string, Tensor::pointer> outputTensors;
+            for(const auto &node : m_engine->getOutputNodes())
+                outputTensors[node.first] = m_engine->getOutputData(node.first);
+            return outputTensors;
+        });
+        job.outputs = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_inferenceMutex);
+            m_inferenceQueue.push_back(std::move(task));
+        }
+        m_inferenceCondition.notify_one();
+        m_pipeline.push_back(std::move(job));
+    }
+
+    // Output the oldest batch. Downstream process objects will then run while the engine works on the next batch.
+    PipelineJob job = std::move(m_pipeline.front());
+    m_pipeline.pop_front();
+    mRuntimeManager->startRegularTimer("inference");
+    auto outputTensors = job.outputs.get(); // Rethrows any exception from the inference thread
+    mRuntimeManager->stopRegularTimer("inference");
+
+    // Frame data added to the output has to be that of this batch, not of the batches read ahead.
+    // This also makes sure update() executes this object again until the last batch has been output.
+    m_frameData = job.frameData;
+    m_lastFrame = job.lastFrame;
+    addOutputTensors(outputTensors, job.batchSize, job.inputImages);
+}
+
+bool NeuralNetwork::inputsAreStreamed() {
+    for(const auto& input : mInputConnections) {
+        if(dynamic_cast<Streamer*>(input.second->getProcessObject().get()) == nullptr)
+            return false;
+    }
+    return !mInputConnections.empty();
+}
+
+bool NeuralNetwork::isEndOfStream() {
+    for(const auto& input : mInputConnections) {
+        if(m_lastFrame.count(input.second->getProcessObject()->getNameOfClass()) > 0)
+            return true;
+    }
+    return false;
+}
+
+void NeuralNetwork::inferenceThread() {
+    while(true) {
+        std::packaged_task<std::unordered_map<std::string, Tensor::pointer>()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_inferenceMutex);
+            m_inferenceCondition.wait(lock, [this]() { return m_stopInferenceThread || !m_inferenceQueue.empty(); });
+            if(m_stopInferenceThread)
+                return;
+            task = std::move(m_inferenceQueue.front());
+            m_inferenceQueue.pop_front();
+        }
+        task();
+    }
+}
+
+void NeuralNetwork::setPipelineDepth(int depth) {
+    if(depth < 1)
+        throw Exception("Pipeline depth of NeuralNetwork must be at least 1");
+    m_pipelineDepth = depth;
+}
+
+Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer> images, const TensorShape& shape, bool temporal, Image::pointer stackedImage) {
     if(shape.getUnknownDimensions() > 0)
         throw Exception("Shape must be known at this time");
 
@@ -319,7 +442,7 @@ Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer>
     int channels = shape[dims-1];
     int width = shape[dims-2];
     int height = shape[dims-3];
-    if(m_engine->getPreferredImageOrdering() == ImageOrdering::ChannelFirst) {
+    if(m_imageOrdering == ImageOrdering::ChannelFirst) {
         channels = shape[dims-3];
         width = shape[dims-1];
         height = shape[dims-2];
@@ -338,7 +461,7 @@ Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer>
         kernelName = "normalize3DInput";
         if((!temporal && shape.getDimensions() != 5) || (temporal && shape.getDimensions() != 6))
             throw Exception("Incorrect shape size");
-        if(m_engine->getPreferredImageOrdering() == ImageOrdering::ChannelFirst) {
+        if(m_imageOrdering == ImageOrdering::ChannelFirst) {
             channels = shape[dims-4];
             depth = shape[dims-3];
             height = shape[dims-2];
@@ -347,58 +470,91 @@ Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer>
             depth = shape[dims - 4];
         }
     }
+    // If all images of a batch are slices of a single 3D image, it is transferred and normalized at once
+    const bool useStackedImage = stackedImage && kernelName == "normalize2DInput" && !temporal &&
+            stackedImage->getWidth() == width && stackedImage->getHeight() == height &&
+            stackedImage->getDepth() == images.size() && stackedImage->getNrOfChannels() == channels;
+    if(useStackedImage)
+        kernelName = "normalize2DInputBatch";
     cl::Kernel kernel(program, kernelName.c_str());
     const std::size_t size = width*height*depth*channels; // nr of elements per image
-    for(int i = 0; i < images.size(); ++i) {
-        auto image = images[i];
-        if(image->getWidth() != width ||
-            image->getHeight() != height ||
-            image->getDepth() != depth)
-            throw Exception("Input image sent to executeNetwork was of incorrect size: " +
-                    std::to_string(image->getWidth()) + "," + std::to_string(image->getHeight()) + "," +
-                    std::to_string(image->getDepth()) + ". Expected: " + std::to_string(width) + ", " +
-                    std::to_string(height) + "," + std::to_string(depth) + ".");
-        if(image->getNrOfChannels() != channels)
-            throw Exception("Input image sent to executeNetwork has incorrect nr of channels: " +
-                    std::to_string(image->getNrOfChannels())+ ". Expected: " + std::to_string(channels) + ".");
-        OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, device);
-        cl::Buffer buffer(
+    const std::size_t totalSize = size*images.size();
+
+    // All images of the batch are normalized into one device buffer, which is reused between executions
+    if(m_inputBufferSize < totalSize) {
+        m_inputBuffer = cl::Buffer(
                 device->getContext(),
                 CL_MEM_WRITE_ONLY,
-                sizeof(float) * size
+                sizeof(float) * totalSize
         );
-        kernel.setArg(1, buffer);
-        kernel.setArg(2, mScaleFactor);
-        kernel.setArg(3, mMean);
-        kernel.setArg(4, mStd);
-        kernel.setArg(5, (int) (mSignedInputNormalization ? 1 : 0));
-        kernel.setArg(6, (int) (mHorizontalImageFlipping ? 1 : 0));
-        kernel.setArg(7, image->getNrOfChannels());
-        kernel.setArg(8, mMinIntensity);
-        kernel.setArg(9, mMaxIntensity);
-        kernel.setArg(10, (int)(mMinAndMaxIntensitySet ? 1 : 0));
-        kernel.setArg(11, (int)(m_engine->getPreferredImageOrdering() == ImageOrdering::ChannelFirst ? 1 : 0));
-        cl::NDRange globalSize;
-        if(image->getDimensions() == 2) {
-            kernel.setArg(0, *access->get2DImage());
-            globalSize = cl::NDRange(width, height);
-        } else {
-            kernel.setArg(0, *access->get3DImage());
-            globalSize = cl::NDRange(width, height, depth);
-        }
-
-        device->getCommandQueue().enqueueNDRangeKernel(
+        m_inputBufferSize = totalSize;
+    }
+    kernel.setArg(1, m_inputBuffer);
+    kernel.setArg(2, mScaleFactor);
+    kernel.setArg(3, mMean);
+    kernel.setArg(4, mStd);
+    kernel.setArg(5, (int) (mSignedInputNormalization ? 1 : 0));
+    kernel.setArg(6, (int) (mHorizontalImageFlipping ? 1 : 0));
+    kernel.setArg(7, channels);
+    kernel.setArg(8, mMinIntensity);
+    kernel.setArg(9, mMaxIntensity);
+    kernel.setArg(10, (int)(mMinAndMaxIntensitySet ? 1 : 0));
+    kernel.setArg(11, (int)(m_imageOrdering == ImageOrdering::ChannelFirst ? 1 : 0));
+
+    // Keep the accesses until all kernels are finished
+    std::vector<OpenCLImageAccess::pointer> accesses;
+    cl::CommandQueue queue = device->getCommandQueue();
+    if(useStackedImage) {
+        OpenCLImageAccess::pointer access = stackedImage->getOpenCLImageAccess(ACCESS_READ, device);
+        kernel.setArg(0, *access->get3DImage());
+        kernel.setArg(12, 0);
+        queue.enqueueNDRangeKernel(
                 kernel,
                 cl::NullRange,
-                globalSize,
+                cl::NDRange(width, height, images.size()),
                 cl::NullRange
         );
-
-        // Read data directly into slice
-        device->getCommandQueue().enqueueReadBuffer(buffer, CL_TRUE, 0, sizeof(float) * size,
-                                                    values.get() + i*size);
+        accesses.push_back(std::move(access));
+    } else {
+        for(int i = 0; i < images.size(); ++i) {
+            auto image = images[i];
+            if(image->getWidth() != width ||
+                image->getHeight() != height ||
+                image->getDepth() != depth)
+                throw Exception("Input image sent to executeNetwork was of incorrect size: " +
+                        std::to_string(image->getWidth()) + "," + std::to_string(image->getHeight()) + "," +
+                        std::to_string(image->getDepth()) + ". Expected: " + std::to_string(width) + ", " +
+                        std::to_string(height) + "," + std::to_string(depth) + ".");
+            if(image->getNrOfChannels() != channels)
+                throw Exception("Input image sent to executeNetwork has incorrect nr of channels: " +
+                        std::to_string(image->getNrOfChannels())+ ". Expected: " + std::to_string(channels) + ".");
+            OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, device);
+            cl::NDRange globalSize;
+            if(image->getDimensions() == 2) {
+                kernel.setArg(0, *access->get2DImage());
+                globalSize = cl::NDRange(width, height);
+            } else {
+                kernel.setArg(0, *access->get3DImage());
+                globalSize = cl::NDRange(width, height, depth);
+            }
+            kernel.setArg(12, (int)(i*size));
+
+            // Kernel arguments are copied when enqueued, thus the kernel object can be reused for the next image
+            queue.enqueueNDRangeKernel(
+                    kernel,
+                    cl::NullRange,
+                    globalSize,
+                    cl::NullRange
+            );
+            accesses.push_back(std::move(access));
+        }
     }
 
+    // Read the entire batch directly into the tensor data, and wait only once
+    cl::Event readEvent;
+    queue.enqueueReadBuffer(m_inputBuffer, CL_FALSE, 0, sizeof(float) * totalSize, values.get(), nullptr, &readEvent);
+    readEvent.wait();
+
     auto tensor = Tensor::New();
     tensor->create(std::move(values), shape);
     return tensor;
@@ -445,6 +601,14 @@ void NeuralNetwork::setSignedInputNormalization(bool signedInputNormalization) {
 }
 
 NeuralNetwork::~NeuralNetwork() {
+    if(m_inferenceThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_inferenceMutex);
+            m_stopInferenceThread = true;
+        }
+        m_inferenceCondition.notify_one();
+        m_inferenceThread.join();
+    }
 }
 
 void NeuralNetwork::setInputNode(uint portID, std::string name, NodeType type, TensorShape shape) {
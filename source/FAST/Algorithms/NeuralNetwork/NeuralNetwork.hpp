@@ -4,6 +4,10 @@
 #include <FAST/Data/Tensor.hpp>
 #include <FAST/Data/SimpleDataObject.hpp>
 #include "InferenceEngine.hpp"
+#include <deque>
+#include <future>
+#include <thread>
+#include <condition_variable>
 
 namespace fast {
 
@@ -41,9 +45,20 @@ class FAST_EXPORT InferenceDataList {
         int getSize() const {
             return isImages() ? m_images.size() : m_tensors.size();
         }
+        /**
+         * Set a 3D image where slice i is a copy of image i in the list.
+         * NeuralNetwork uses this to transfer all images to the GPU at once.
+         */
+        void setStackedImage(std::shared_ptr<Image> image) {
+            m_stackedImage = image;
+        }
+        std::shared_ptr<Image> getStackedImage() const {
+            return m_stackedImage;
+        }
     private:
         std::vector<std::shared_ptr<Image>> m_images;
         std::vector<std::shared_ptr<Tensor>> m_tensors;
+        std::shared_ptr<Image> m_stackedImage;
 };
 
 class Sequence : public SimpleDataObject<InferenceDataList> {
@@ -66,6 +81,13 @@ class Batch : public SimpleDataObject<InferenceDataList> {
         void create(std::vector<std::shared_ptr<Image>> images) {
             mData = InferenceDataList(images);
         };
+        /**
+         * Create a batch of images, where stackedImage is a 3D image containing all the images as slices
+         */
+        void create(std::vector<std::shared_ptr<Image>> images, std::shared_ptr<Image> stackedImage) {
+            mData = InferenceDataList(images);
+            mData.setStackedImage(stackedImage);
+        };
         void create(std::vector<std::shared_ptr<Tensor>> tensors) {
             mData = InferenceDataList(tensors);
         };
@@ -141,6 +163,18 @@ class FAST_EXPORT NeuralNetwork : public ProcessObject {
          */
         void setTemporalWindow(uint window);
 
+        /**
+         * Enable pipelined execution. While the inference engine runs on a batch, the input of the next batches is
+         * preprocessed, and the output of the previous batch is sent further down the pipeline.
+         * This only has an effect when all inputs come from streamers, otherwise there is nothing to read ahead.
+         * Output frames are produced in the same order as input frames.
+         *
+         * The inference engine is run in a separate thread in this mode.
+         *
+         * @param depth Maximum nr of batches in flight. 1, which is the default, disables pipelining.
+         */
+        void setPipelineDepth(int depth);
+
         virtual void setInputSize(std::string name, std::vector<int> size);
 
         void loadAttributes();
@@ -161,15 +195,49 @@ class FAST_EXPORT NeuralNetwork : public ProcessObject {
         virtual void run();
 
         std::shared_ptr<InferenceEngine> m_engine;
+        // Copy of the nodes and image ordering of the engine, used when preprocessing input and adding output
+        std::unordered_map<std::string, InferenceEngine::NetworkNode> m_inputNodes;
+        std::unordered_map<std::string, InferenceEngine::NetworkNode> m_outputNodes;
+        ImageOrdering m_imageOrdering;
+        /**
+         * Apply input sizes to the input nodes of the engine, and copy the nodes of the engine
+         */
+        void updateNodes();
 
         std::unordered_map<std::string, std::vector<std::shared_ptr<Image>>> mInputImages;
+        // Device buffer for normalized input images, reused as long as it is large enough
+        cl::Buffer m_inputBuffer;
+        std::size_t m_inputBufferSize = 0;
 
         std::unordered_map<std::string, Tensor::pointer> processInputData();
+        void addOutputTensors(std::unordered_map<std::string, Tensor::pointer> tensors, int batchSize,
+                const std::unordered_map<std::string, std::vector<std::shared_ptr<Image>>>& inputImages);
         std::vector<std::shared_ptr<Image>> resizeImages(const std::vector<std::shared_ptr<Image>>& images, int width, int height, int depth);
-        Tensor::pointer convertImagesToTensor(std::vector<std::shared_ptr<Image>> image, const TensorShape& shape, bool temporal);
+        Tensor::pointer convertImagesToTensor(std::vector<std::shared_ptr<Image>> image, const TensorShape& shape, bool temporal, std::shared_ptr<Image> stackedImage = nullptr);
 
     private:
+        // A batch which has been preprocessed, and is waiting for or running in the inference engine
+        struct PipelineJob {
+            std::future<std::unordered_map<std::string, Tensor::pointer>> outputs;
+            int batchSize;
+            std::unordered_map<std::string, std::vector<std::shared_ptr<Image>>> inputImages;
+            std::unordered_map<std::string, std::string> frameData;
+            std::unordered_set<std::string> lastFrame;
+            bool endOfStream;
+        };
+        int m_pipelineDepth = 1;
+        std::deque<PipelineJob> m_pipeline;
+        std::deque<std::packaged_task<std::unordered_map<std::string, Tensor::pointer>()>> m_inferenceQueue;
+        std::thread m_inferenceThread;
+        std::mutex m_inferenceMutex;
+        std::condition_variable m_inferenceCondition;
+        bool m_stopInferenceThread = false;
+
         void execute();
+        void executePipelined();
+        bool inputsAreStreamed();
+        bool isEndOfStream();
+        void inferenceThread();
 };
 
 }
@@ -0,0 +1,25 @@
+__kernel void tensorToSegmentation(
+        __global const float* tensor,
+        __global uchar* segmentation,
+        __private const int size,
+        __private const int nrOfClasses,
+        __private const int channelFirst,
+        __private const float threshold
+    ) {
+    const int x = get_global_id(0);
+    // Position of class j is x*nrOfClasses + j for channel last, and x + j*size for channel first
+    const int pixelStride = channelFirst == 1 ? 1 : nrOfClasses;
+    const int classStride = channelFirst == 1 ? size : 1;
+    const int start = x*pixelStride;
+
+    uchar maxClass = 0;
+    float maxValue = tensor[start];
+    for(int j = 1; j < nrOfClasses; ++j) {
+        const float value = tensor[start + j*classStride];
+        if(value > threshold && value > maxValue) {
+            maxClass = j;
+            maxValue = value;
+        }
+    }
+    segmentation[x] = maxClass;
+}
@@ -2,66 +2,169 @@
 #include <FAST/Data/Image.hpp>
 #include "TensorToSegmentation.hpp"
 #include "InferenceEngine.hpp"
+#include "NeuralNetwork.hpp"
+#include <cstring>
 
 namespace fast {
 
 /**
- * Calculate array position based on image ordering
- * @param x
- * @param nrOfClasses
- * @param j
- * @param size
- * @param ordering
- * @return
+ * Find the class with the highest value above threshold for each pixel, when classes are stored last.
  */
-inline int getPosition(int x, int nrOfClasses, int j, int size, ImageOrdering ordering) {
-    return ordering == ImageOrdering::ChannelLast ? x*nrOfClasses + j : x + j*size;
+static void argmaxChannelLast(const float* tensorData, uchar* segmentation, int size, int nrOfClasses, float threshold) {
+#pragma omp parallel for
+    for(int x = 0; x < size; ++x) {
+        const float* values = &tensorData[(std::size_t)x*nrOfClasses];
+        uchar maxClass = 0;
+        float maxValue = values[0];
+        for(int j = 1; j < nrOfClasses; ++j) {
+            const bool larger = values[j] > threshold && values[j] > maxValue;
+            maxClass = larger ? (uchar)j : maxClass;
+            maxValue = larger ? values[j] : maxValue;
+        }
+        segmentation[x] = maxClass;
+    }
+}
+
+/**
+ * Find the class with the highest value above threshold for each pixel, when classes are stored first.
+ * Pixels are processed in blocks, and the inner loop is over contiguous pixels of one class, which can be vectorized.
+ */
+static void argmaxChannelFirst(const float* tensorData, uchar* segmentation, int size, int nrOfClasses, float threshold) {
+    const int blockSize = 4096;
+    const int blocks = (size + blockSize - 1) / blockSize;
+#pragma omp parallel for
+    for(int block = 0; block < blocks; ++block) {
+        const int start = block*blockSize;
+        const int length = std::min(blockSize, size - start);
+        float maxValue[blockSize];
+        uchar maxClass[blockSize];
+        for(int x = 0; x < length; ++x) {
+            maxValue[x] = tensorData[start + x];
+            maxClass[x] = 0;
+        }
+        for(int j = 1; j < nrOfClasses; ++j) {
+            const float* values = &tensorData[(std::size_t)j*size + start];
+            for(int x = 0; x < length; ++x) {
+                const bool larger = values[x] > threshold && values[x] > maxValue[x];
+                maxClass[x] = larger ? (uchar)j : maxClass[x];
+                maxValue[x] = larger ? values[x] : maxValue[x];
+            }
+        }
+        std::memcpy(&segmentation[start], maxClass, length);
+    }
 }
 
 TensorToSegmentation::TensorToSegmentation() {
-    createInputPort<Tensor>(0);
-    createOutputPort<Image>(0);
+    createInputPort<DataObject>(0); // Can be Tensor or Batch of tensors
+    createOutputPort<DataObject>(0); // Image or Batch of images
+    createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/NeuralNetwork/TensorToSegmentation.cl");
+    createFloatAttribute("threshold", "Threshold", "Lower threshold of accepting a label", m_threshold);
+}
+
+void TensorToSegmentation::loadAttributes() {
+    setThreshold(getFloatAttribute("threshold"));
+}
+
+void TensorToSegmentation::setThreshold(float threshold) {
+    m_threshold = threshold;
+}
+
+float TensorToSegmentation::getThreshold() const {
+    return m_threshold;
+}
+
+void TensorToSegmentation::setChannelOrdering(ImageOrdering ordering) {
+    m_ordering = ordering;
 }
 
 void TensorToSegmentation::execute() {
-    auto tensor = getInputData<Tensor>();
-    auto output = getOutputData<Image>();
+    auto data = getInputData<DataObject>();
+    auto batch = std::dynamic_pointer_cast<Batch>(data);
+    if(batch) {
+        // Batch tensors from NeuralNetwork are views of the network output, and are read without any copy
+        std::vector<Image::pointer> images;
+        auto access = batch->getAccess(ACCESS_READ);
+        for(auto&& tensor : access->getData().getTensors()) {
+            auto image = createSegmentation(tensor);
+            for(auto&& frameData : tensor->getFrameData())
+                image->setFrameData(frameData.first, frameData.second);
+            for(auto&& lastFrame : tensor->getLastFrame())
+                image->setLastFrame(lastFrame);
+            images.push_back(image);
+        }
+        auto outputBatch = Batch::New();
+        outputBatch->create(images);
+        addOutputData(0, outputBatch);
+    } else {
+        auto tensor = std::dynamic_pointer_cast<Tensor>(data);
+        if(!tensor)
+            throw BadCastException(data->getNameOfClass(), Tensor::getStaticNameOfClass());
+        addOutputData(0, createSegmentation(tensor));
+    }
+}
 
+Image::pointer TensorToSegmentation::createSegmentation(Tensor::pointer tensor) {
+    auto output = Image::New();
+
+    // Remove any leading batch dimensions of size 1
     auto shape = tensor->getShape();
-    const int dims = shape.getDimensions();
-    int outputHeight = shape[dims-3];
-    int outputWidth = shape[dims-2];
-    ImageOrdering ordering = ImageOrdering::ChannelLast;
-    if(ordering == ImageOrdering::ChannelFirst) {
-        outputHeight = shape[dims-2];
-        outputWidth = shape[dims-1];
-    }
-    int outputDepth = 1;
-    auto access = tensor->getAccess(ACCESS_READ);
-    float* tensorData = access->getRawData();
-    if(dims == 5) {
-        outputDepth = shape[dims - 4];
-    }
+    int firstDimension = 0;
+    while(shape.getDimensions() - firstDimension > 3 && shape[firstDimension] == 1)
+        ++firstDimension;
+    const int dims = shape.getDimensions() - firstDimension;
+    if(dims < 3 || dims > 4)
+        throw Exception("TensorToSegmentation expects a tensor with 2 or 3 spatial dimensions and one channel dimension");
+    const bool channelFirst = m_ordering == ImageOrdering::ChannelFirst;
+    // Spatial dimensions are (depth), height, width
+    const int spatialStart = firstDimension + (channelFirst ? 1 : 0);
+    const int nrOfClasses = channelFirst ? shape[firstDimension] : shape[shape.getDimensions() - 1];
+    const int outputDepth = dims == 4 ? shape[spatialStart] : 1;
+    const int outputHeight = shape[spatialStart + dims - 3];
+    const int outputWidth = shape[spatialStart + dims - 2];
     const int size = outputWidth*outputHeight*outputDepth;
+    if(nrOfClasses > 256)
+        throw Exception("TensorToSegmentation supports at most 256 classes");
 
-    auto data = make_uninitialized_unique<uchar[]>(size);
-    const int nrOfClasses = ordering == ImageOrdering::ChannelFirst ? tensor->getShape()[0] : tensor->getShape()[tensor->getShape().getDimensions()-1];
-    for(int x = 0; x < size; ++x) {
-        uchar maxClass = 0;
-        for(uchar j = 1; j < nrOfClasses; j++) {
-            if(tensorData[getPosition(x, nrOfClasses, j, size, ordering)] > m_threshold &&
-               tensorData[getPosition(x, nrOfClasses, j, size, ordering)] > tensorData[getPosition(x, nrOfClasses, maxClass, size, ordering)]) {
-                maxClass = j;
-            }
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(getMainDevice());
+    if(device && !device->isHost() && tensor->hasOpenCLBuffer(device)) {
+        // Tensor is already on the device, create the segmentation there as well
+        if(outputDepth == 1) {
+            output->create(outputWidth, outputHeight, TYPE_UINT8, 1);
+        } else {
+            output->create(outputWidth, outputHeight, outputDepth, TYPE_UINT8, 1);
         }
-        data[x] = maxClass;
-    }
-    if(outputDepth == 1) {
-        output->create(outputWidth, outputHeight, TYPE_UINT8, 1, std::move(data));
+        auto tensorAccess = tensor->getOpenCLBufferAccess(ACCESS_READ, device);
+        auto outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+        cl::Kernel kernel(getOpenCLProgram(device), "tensorToSegmentation");
+        kernel.setArg(0, *tensorAccess->get());
+        kernel.setArg(1, *outputAccess->get());
+        kernel.setArg(2, size);
+        kernel.setArg(3, nrOfClasses);
+        kernel.setArg(4, (int)(channelFirst ? 1 : 0));
+        kernel.setArg(5, m_threshold);
+        device->getCommandQueue().enqueueNDRangeKernel(
+                kernel,
+                cl::NullRange,
+                cl::NDRange(size),
+                cl::NullRange
+        );
     } else {
-        output->create(outputWidth, outputHeight, outputDepth, TYPE_UINT8, 1, std::move(data));
+        auto access = tensor->getAccess(ACCESS_READ);
+        const float* tensorData = access->getRawData();
+        auto data = make_uninitialized_unique<uchar[]>(size);
+        if(channelFirst) {
+            argmaxChannelFirst(tensorData, data.get(), size, nrOfClasses, m_threshold);
+        } else {
+            argmaxChannelLast(tensorData, data.get(), size, nrOfClasses, m_threshold);
+        }
+        if(outputDepth == 1) {
+            output->create(outputWidth, outputHeight, TYPE_UINT8, 1, std::move(data));
+        } else {
+            output->create(outputWidth, outputHeight, outputDepth, TYPE_UINT8, 1, std::move(data));
+        }
     }
     output->setSpacing(tensor->getSpacing());
+    return output;
 }
 
-}
\ No newline at end of file
+}
@@ -1,16 +1,37 @@
 #pragma once
 
 #include <FAST/ProcessObject.hpp>
+#include "InferenceEngine.hpp"
 
 namespace fast {
 
+class Image;
+class Tensor;
+
+/**
+ * Converts a tensor of class probabilities to a segmentation image, by selecting the class with the highest
+ * value for each pixel. Class 0 (background) is used if no other class has a value above the threshold.
+ *
+ * If the main device is an OpenCL device, and the tensor data is already in an OpenCL buffer on that device,
+ * the segmentation is created on the device without transferring the tensor to the host.
+ * Otherwise a multi-threaded host implementation is used.
+ */
 class FAST_EXPORT TensorToSegmentation : public ProcessObject {
     FAST_OBJECT(TensorToSegmentation)
     public:
+        void setThreshold(float threshold);
+        float getThreshold() const;
+        /**
+         * Set the ordering of the class channel in the tensor. Default is ChannelLast.
+         */
+        void setChannelOrdering(ImageOrdering ordering);
+        void loadAttributes() override;
     protected:
         TensorToSegmentation();
         void execute() override;
+        std::shared_ptr<Image> createSegmentation(std::shared_ptr<Tensor> tensor);
         float m_threshold = 0.5f;
+        ImageOrdering m_ordering = ImageOrdering::ChannelLast;
 };
 
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #include "NeuralNetwork.hpp"
 #include "SegmentationNetwork.hpp"
 #include "InferenceEngineManager.hpp"
+#include "TensorToSegmentation.hpp"
 #include <FAST/Importers/ImageFileImporter.hpp>
 #include <FAST/Visualization/SegmentationRenderer/SegmentationRenderer.hpp>
 #include <FAST/Visualization/ImageRenderer/ImageRenderer.hpp>
@@ -14,6 +15,7 @@
 #include <FAST/Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter.hpp>
 #include <FAST/Streamers/ImageFileStreamer.hpp>
 #include <FAST/Visualization/HeatmapRenderer/HeatmapRenderer.hpp>
+#include <random>
 
 using namespace fast;
 
@@ -291,6 +293,96 @@ TEST_CASE("Execute NN on batch of 2D images", "[fast][neuralnetwork][batch]") {
     }
 }
 
+TEST_CASE("Pipelined NN execution on stream gives same output in same order", "[fast][neuralnetwork][pipeline]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    for(auto&& engine : InferenceEngineManager::getEngineList()) {
+        auto streamer = ImageFileStreamer::New();
+        streamer->setFilenameFormat(Config::getTestDataPath() + "US/JugularVein/US-2D_#.mhd");
+
+        std::vector<NeuralNetwork::pointer> networks;
+        std::vector<DataChannel::pointer> ports;
+        for(int depth : {1, 3}) {
+            auto network = NeuralNetwork::New();
+            network->setInferenceEngine(engine);
+            if(engine.substr(0, 10) == "TensorFlow") {
+                network->setOutputNode(0, "dense_1/BiasAdd", NodeType::TENSOR);
+                network->setOutputNode(1, "dense_2/BiasAdd", NodeType::TENSOR);
+                network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.pb");
+            } else if(engine == "TensorRT") {
+                network->setInputNode(0, "input_1", NodeType::IMAGE, TensorShape({-1, 1, 64, 64}));
+                network->setOutputNode(0, "dense_1/BiasAdd", NodeType::TENSOR, TensorShape({-1, 6}));
+                network->setOutputNode(1, "dense_2/BiasAdd", NodeType::TENSOR, TensorShape({-1, 6}));
+                network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output_channels_first.uff");
+            } else {
+                network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.xml");
+            }
+            network->setPipelineDepth(depth);
+            network->setInputConnection(streamer->getOutputPort());
+            ports.push_back(network->getOutputPort(0));
+            networks.push_back(network);
+        }
+
+        int frames = 0;
+        bool lastFrame = false;
+        while(!lastFrame) {
+            std::vector<Tensor::pointer> results;
+            for(int i = 0; i < 2; ++i) {
+                networks[i]->update();
+                results.push_back(ports[i]->getNextFrame<Tensor>());
+            }
+            CHECK(results[0]->isLastFrame() == results[1]->isLastFrame());
+            lastFrame = results[0]->isLastFrame();
+            auto access0 = results[0]->getAccess(ACCESS_READ);
+            auto access1 = results[1]->getAccess(ACCESS_READ);
+            REQUIRE(access0->getShape()[0] == 6);
+            REQUIRE(access1->getShape()[0] == 6);
+            for(int j = 0; j < 6; ++j)
+                CHECK(access0->getRawData()[j] == Approx(access1->getRawData()[j]));
+            ++frames;
+        }
+        CHECK(frames > 1);
+    }
+}
+
+TEST_CASE("Pipelined NN execution on stream with input size set", "[fast][neuralnetwork][pipeline]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    for(auto&& engine : InferenceEngineManager::getEngineList()) {
+        if(engine == "TensorRT") // Uses channel first ordering
+            continue;
+        auto streamer = ImageFileStreamer::New();
+        streamer->setFilenameFormat(Config::getTestDataPath() + "US/JugularVein/US-2D_#.mhd");
+
+        auto network = NeuralNetwork::New();
+        network->setInferenceEngine(engine);
+        if(engine.substr(0, 10) == "TensorFlow") {
+            network->setOutputNode(0, "dense_1/BiasAdd", NodeType::TENSOR);
+            network->setOutputNode(1, "dense_2/BiasAdd", NodeType::TENSOR);
+            network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.pb");
+        } else {
+            network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.xml");
+        }
+        // Input nodes of the engine are changed, this must not happen while the inference thread runs
+        network->setInputSize("", {64, 64});
+        network->setPipelineDepth(4);
+        network->enableRuntimeMeasurements();
+        network->setInputConnection(streamer->getOutputPort());
+        auto port = network->getOutputPort(0);
+
+        int frames = 0;
+        bool lastFrame = false;
+        while(!lastFrame) {
+            network->update();
+            auto result = port->getNextFrame<Tensor>();
+            lastFrame = result->isLastFrame();
+            auto access = result->getAccess(ACCESS_READ);
+            REQUIRE(access->getShape()[0] == 6);
+            ++frames;
+        }
+        CHECK(frames > 4);
+        CHECK(network->getRuntime("inference")->getSamples() == frames);
+    }
+}
+
 TEST_CASE("NN: temporal input static output", "[fast][neuralnetwork][sequence]") {
     for(const std::string& engine : {"TensorFlowCPU", "TensorFlowCUDA"}) {
         if(!InferenceEngineManager::isEngineAvailable(engine)) {
@@ -421,3 +513,58 @@ TEST_CASE("NN: temporal input temporal output, streaming mode", "[fast][neuralne
         }
     }
 }
+
+TEST_CASE("TensorToSegmentation with channel last, channel first and on device", "[fast][neuralnetwork][TensorToSegmentation]") {
+    const int width = 67, height = 45, classes = 4;
+    const float threshold = 0.3f;
+    std::default_random_engine engine(1);
+    std::uniform_real_distribution<float> distribution(0, 1);
+    auto channelLastData = std::make_unique<float[]>(width*height*classes);
+    auto channelFirstData = std::make_unique<float[]>(width*height*classes);
+    std::vector<uchar> expected(width*height);
+    for(int x = 0; x < width*height; ++x) {
+        uchar maxClass = 0;
+        for(int j = 0; j < classes; ++j) {
+            const float value = distribution(engine);
+            channelLastData[x*classes + j] = value;
+            channelFirstData[x + j*width*height] = value;
+            if(j > 0 && value > threshold && value > channelLastData[x*classes + maxClass])
+                maxClass = j;
+        }
+        expected[x] = maxClass;
+    }
+    auto channelLast = Tensor::New();
+    channelLast->create(std::move(channelLastData), TensorShape({height, width, classes}));
+    auto channelFirst = Tensor::New();
+    channelFirst->create(std::move(channelFirstData), TensorShape({classes, height, width}));
+
+    auto check = [&](Tensor::pointer tensor, ImageOrdering ordering) {
+        auto converter = TensorToSegmentation::New();
+        converter->setThreshold(threshold);
+        converter->setChannelOrdering(ordering);
+        converter->setInputData(tensor);
+        auto port = converter->getOutputPort();
+        converter->update();
+        auto image = port->getNextFrame<Image>();
+        REQUIRE(image->getWidth() == width);
+        REQUIRE(image->getHeight() == height);
+        auto access = image->getImageAccess(ACCESS_READ);
+        auto data = (const uchar*)access->get();
+        for(int x = 0; x < width*height; ++x)
+            CHECK(data[x] == expected[x]);
+    };
+
+    SECTION("Host") {
+        check(channelLast, ImageOrdering::ChannelLast);
+        check(channelFirst, ImageOrdering::ChannelFirst);
+    }
+    SECTION("Device") {
+        // Move tensor data to the device, this makes TensorToSegmentation use the OpenCL implementation
+        auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+        channelLast->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+        channelFirst->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+        REQUIRE(channelLast->hasOpenCLBuffer(device));
+        check(channelLast, ImageOrdering::ChannelLast);
+        check(channelFirst, ImageOrdering::ChannelFirst);
+    }
+}
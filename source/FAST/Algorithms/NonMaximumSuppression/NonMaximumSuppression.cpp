@@ -1,5 +1,9 @@
 #include "NonMaximumSuppression.hpp"
 #include <FAST/Data/BoundingBox.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 #include <queue>
 
 namespace fast {
@@ -8,68 +12,221 @@ NonMaximumSuppression::NonMaximumSuppression() {
 	createInputPort<BoundingBoxSet>(0);
 	createOutputPort<BoundingBoxSet>(0);
 	createFloatAttribute("threshold", "Threshold", "Threshold", m_threshold);
+	createBooleanAttribute("per-class", "Per class", "Only suppress boxes with the same label", m_perClass);
+	createBooleanAttribute("soft", "Soft NMS", "Reduce score of overlapping boxes instead of removing them", m_soft);
+	createFloatAttribute("sigma", "Sigma", "Sigma of soft NMS", m_sigma);
+	createFloatAttribute("minimum-score", "Minimum score", "Boxes with a lower score are removed in soft NMS", m_minimumScore);
 }
 
 void NonMaximumSuppression::loadAttributes() {
 	setThreshold(getFloatAttribute("threshold"));
+	setPerClass(getBooleanAttribute("per-class"));
+	setSoftNMS(getBooleanAttribute("soft"), getFloatAttribute("sigma"), getFloatAttribute("minimum-score"));
 }
 
 void NonMaximumSuppression::setThreshold(float threshold) {
 	m_threshold = threshold;
 }
 
+void NonMaximumSuppression::setPerClass(bool perClass) {
+	m_perClass = perClass;
+}
+
+void NonMaximumSuppression::setSoftNMS(bool soft, float sigma, float minimumScore) {
+	if(sigma <= 0)
+		throw Exception("Sigma of soft NMS must be larger than 0");
+	m_soft = soft;
+	m_sigma = sigma;
+	m_minimumScore = minimumScore;
+}
+
+namespace {
+
+/**
+ * Bounding boxes stored as flat arrays, ordered by grid cell.
+ * The boxes of cell c are in the range [cellStart[c], cellStart[c+1]).
+ */
+struct BoxGrid {
+	std::vector<float> x1, y1, x2, y2, area;
+	std::vector<uchar> label;
+	std::vector<int> index; // Original index of each box
+	std::vector<int> cellStart;
+	std::vector<int> boxCell;
+	int cellsX, cellsY;
+};
+
+BoxGrid createGrid(const std::vector<float>& coordinates, const std::vector<uchar>& labels) {
+	const int count = coordinates.size() / 12;
+	// Two boxes can only overlap if their centers are closer than the largest box size,
+	// thus it is enough to check the neighbouring cells if this is the cell size.
+	float minX = std::numeric_limits<float>::max(), minY = minX;
+	float maxX = std::numeric_limits<float>::lowest(), maxY = maxX;
+	float cellSize = 0;
+	for(int i = 0; i < count; ++i) {
+		const float* box = &coordinates[i * 12];
+		minX = std::min(minX, box[0]);
+		minY = std::min(minY, box[1]);
+		maxX = std::max(maxX, box[6]);
+		maxY = std::max(maxY, box[7]);
+		cellSize = std::max(cellSize, std::max(box[6] - box[0], box[7] - box[1]));
+	}
+	// Limit nr of cells to the order of the nr of boxes
+	cellSize = std::max(cellSize, std::sqrt((maxX - minX) * (maxY - minY) / std::max(count, 1)));
+	cellSize = std::max(cellSize, 1e-6f);
+
+	BoxGrid grid;
+	grid.cellsX = (int)((maxX - minX) / cellSize) + 1;
+	grid.cellsY = (int)((maxY - minY) / cellSize) + 1;
+	std::vector<int> cell(count);
+	grid.cellStart.assign(grid.cellsX * grid.cellsY + 1, 0);
+	for(int i = 0; i < count; ++i) {
+		const float* box = &coordinates[i * 12];
+		const int cellX = std::min((int)(((box[0] + box[6]) * 0.5f - minX) / cellSize), grid.cellsX - 1);
+		const int cellY = std::min((int)(((box[1] + box[7]) * 0.5f - minY) / cellSize), grid.cellsY - 1);
+		cell[i] = cellX + cellY * grid.cellsX;
+		grid.cellStart[cell[i] + 1]++;
+	}
+	std::partial_sum(grid.cellStart.begin(), grid.cellStart.end(), grid.cellStart.begin());
+
+	// Counting sort of the boxes into the cells
+	grid.x1.resize(count);
+	grid.y1.resize(count);
+	grid.x2.resize(count);
+	grid.y2.resize(count);
+	grid.area.resize(count);
+	grid.label.resize(count);
+	grid.index.resize(count);
+	grid.boxCell.resize(count);
+	std::vector<int> next(grid.cellStart.begin(), grid.cellStart.end() - 1);
+	for(int i = 0; i < count; ++i) {
+		const float* box = &coordinates[i * 12];
+		const int position = next[cell[i]]++;
+		grid.x1[position] = box[0];
+		grid.y1[position] = box[1];
+		grid.x2[position] = box[6];
+		grid.y2[position] = box[7];
+		grid.area[position] = (box[6] - box[0]) * (box[7] - box[1]);
+		grid.label[position] = labels[i * 4];
+		grid.index[position] = i;
+		grid.boxCell[position] = cell[i];
+	}
+	return grid;
+}
+
+/**
+ * Calculate IoU between box and the boxes in the range [begin, end) of the grid.
+ * Written without branches so that the compiler can vectorize it.
+ */
+void intersectionOverUnion(const BoxGrid& grid, int box, int begin, int end, bool perClass, float* result) {
+	const float x1 = grid.x1[box], y1 = grid.y1[box], x2 = grid.x2[box], y2 = grid.y2[box], area = grid.area[box];
+	const uchar label = grid.label[box];
+	for(int i = begin; i < end; ++i) {
+		const float width = std::max(std::min(x2, grid.x2[i]) - std::max(x1, grid.x1[i]), 0.0f);
+		const float height = std::max(std::min(y2, grid.y2[i]) - std::max(y1, grid.y1[i]), 0.0f);
+		const float intersection = width * height;
+		const float iou = intersection / std::max(area + grid.area[i] - intersection, std::numeric_limits<float>::min());
+		result[i - begin] = (!perClass || grid.label[i] == label) ? iou : 0.0f;
+	}
+}
+
+}
+
 void NonMaximumSuppression::execute() {
 	auto input = getInputData<BoundingBoxSet>();
 	auto output = getOutputData<BoundingBoxSet>();
 	output->create();
 
-	auto compare = [](BoundingBox::pointer a, BoundingBox::pointer b) {
-		return a->getScore() < b->getScore(); // if true, they swap place
-	};
-	std::priority_queue<BoundingBox::pointer, std::vector<BoundingBox::pointer>, decltype(compare)> queue(compare);
-	// Add bounding boxes to the queue
 	auto inputAccess = input->getAccess(ACCESS_READ);
-	auto outputAccess = output->getAccess(ACCESS_READ_WRITE);
 	auto coordinates = inputAccess->getCoordinates();
 	auto labels = inputAccess->getLabels();
-	auto scores = inputAccess->getScores();
-	for(int i = 0; i < coordinates.size(); i += 12) {
-		auto bbox = BoundingBox::New();
-		auto position = Vector2f(coordinates[i], coordinates[i + 1]);
-		auto size = Vector2f(coordinates[i + 6], coordinates[i + 7]) - position;
-		//std::cout << position << " " << size << std::endl;
-		//std::cout << labels[i / 3] << std::endl;
-		//std::cout << scores[i / 12] << std::endl;
-		bbox->create(position, size, labels[i / 3], scores[i / 12]);
-		//std::cout << "box created" << std::endl;
-		queue.push(bbox);
-		//std::cout << "box added" << std::endl;
-	}
+	auto inputScores = inputAccess->getScores();
+	const int count = coordinates.size() / 12;
+	// Output is an empty set, and no grid can be created without any boxes
+	if(count == 0)
+		return;
+
+	const BoxGrid grid = createGrid(coordinates, labels);
+	std::vector<float> scores(count);
+	for(int i = 0; i < count; ++i)
+		scores[i] = inputScores[grid.index[i]];
 
-	std::unordered_set<BoundingBox::pointer> erased;
-	while(!queue.empty()) {
-		BoundingBox::pointer b_m;
-		do {
-			b_m = queue.top();
+	// Visit all boxes in neighbouring cells of box i
+	std::vector<float> iou;
+	auto forEachNeighbour = [&](int i, auto function) {
+		const int cellX = grid.boxCell[i] % grid.cellsX;
+		const int cellY = grid.boxCell[i] / grid.cellsX;
+		for(int y = std::max(cellY - 1, 0); y <= std::min(cellY + 1, grid.cellsY - 1); ++y) {
+			// Cells next to each other in x are contiguous
+			const int begin = grid.cellStart[std::max(cellX - 1, 0) + y * grid.cellsX];
+			const int end = grid.cellStart[std::min(cellX + 1, grid.cellsX - 1) + y * grid.cellsX + 1];
+			iou.resize(std::max<std::size_t>(iou.size(), end - begin));
+			intersectionOverUnion(grid, i, begin, end, m_perClass, iou.data());
+			for(int j = begin; j < end; ++j)
+				function(j, iou[j - begin]);
+		}
+	};
+
+	std::vector<int> kept;
+	std::vector<bool> done(count, false);
+	if(!m_soft) {
+		// Sort by decreasing score, ties are kept in input order
+		std::vector<int> order(count);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+			if(scores[a] != scores[b])
+				return scores[a] > scores[b];
+			return grid.index[a] < grid.index[b];
+		});
+		// done is used to mark both kept and removed boxes
+		for(int i : order) {
+			if(done[i])
+				continue;
+			done[i] = true;
+			kept.push_back(i);
+			forEachNeighbour(i, [&](int j, float overlap) {
+				if(overlap > m_threshold)
+					done[j] = true;
+			});
+		}
+	} else {
+		// Scores change while processing, thus use a priority queue with lazy updates:
+		// An entry is only valid if its score is equal to the current score of the box.
+		auto compare = [&](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+			if(a.first != b.first)
+				return a.first < b.first;
+			return grid.index[a.second] > grid.index[b.second];
+		};
+		std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int>>, decltype(compare)> queue(compare);
+		for(int i = 0; i < count; ++i)
+			queue.push({scores[i], i});
+		while(!queue.empty()) {
+			const auto entry = queue.top();
 			queue.pop();
-		} while(erased.count(b_m) > 0 && !queue.empty());
-		if(!b_m)
-			break;
-		
-		outputAccess->addBoundingBox(b_m);
-		auto iterateQueue = queue; // Create new queue for iterating
-
-		// Remove overlapping bounding boxes
-		while(!iterateQueue.empty()) {
-			auto b = iterateQueue.top();
-			iterateQueue.pop();
-
-			if(b_m->intersectionOverUnion(b) > m_threshold) { // If large overlap
-				erased.insert(b);
-			}
+			const int i = entry.second;
+			if(done[i] || entry.first != scores[i])
+				continue;
+			done[i] = true;
+			if(scores[i] < m_minimumScore)
+				continue;
+			kept.push_back(i);
+			forEachNeighbour(i, [&](int j, float overlap) {
+				if(done[j] || overlap <= 0.0f)
+					return;
+				scores[j] *= std::exp(-overlap * overlap / m_sigma);
+				queue.push({scores[j], j});
+			});
 		}
 	}
 
+	auto outputAccess = output->getAccess(ACCESS_READ_WRITE);
+	for(int i : kept) {
+		outputAccess->addBoundingBox(
+				Vector2f(grid.x1[i], grid.y1[i]),
+				Vector2f(grid.x2[i] - grid.x1[i], grid.y2[i] - grid.y1[i]),
+				grid.label[i],
+				scores[i]
+		);
+	}
 }
 
-}
\ No newline at end of file
+}
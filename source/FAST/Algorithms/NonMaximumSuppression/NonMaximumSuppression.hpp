@@ -4,16 +4,41 @@
 
 namespace fast {
 
+/**
+ * Non-maximum suppression of a BoundingBoxSet.
+ *
+ * The boxes are kept in flat coordinate/score arrays, and are binned in a uniform grid
+ * so that each box is only compared with nearby boxes. Boxes are processed in order of
+ * decreasing score, and boxes which overlap a kept box with an intersection over union (IoU)
+ * above the threshold are removed.
+ *
+ * With soft NMS, overlapping boxes are not removed, instead their score is reduced by
+ * exp(-IoU^2/sigma). Boxes with a score below the minimum score are removed.
+ */
 class FAST_EXPORT NonMaximumSuppression : public ProcessObject {
 	FAST_OBJECT(NonMaximumSuppression)
 	public:
 		void setThreshold(float threshold);
+		/**
+		 * Only suppress boxes with the same label. Default is false.
+		 */
+		void setPerClass(bool perClass);
+		/**
+		 * Use soft NMS instead of removing overlapping boxes.
+		 * @param sigma Width of the Gaussian used to reduce the score of overlapping boxes
+		 * @param minimumScore Boxes with a score below this value are removed
+		 */
+		void setSoftNMS(bool soft, float sigma = 0.5f, float minimumScore = 0.001f);
 		void loadAttributes();
 	protected:
 		NonMaximumSuppression();
 		void execute() override;
 
 		float m_threshold = 0.5f;
+		bool m_perClass = false;
+		bool m_soft = false;
+		float m_sigma = 0.5f;
+		float m_minimumScore = 0.001f;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,124 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Algorithms/NonMaximumSuppression/NonMaximumSuppression.hpp"
+#include "FAST/Data/BoundingBox.hpp"
+#include <numeric>
+#include <random>
+
+namespace fast {
+
+static BoundingBoxSet::pointer runNMS(NonMaximumSuppression::pointer nms, BoundingBoxSet::pointer input) {
+    nms->setInputData(input);
+    auto port = nms->getOutputPort();
+    nms->update();
+    return port->getNextFrame<BoundingBoxSet>();
+}
+
+TEST_CASE("Non maximum suppression removes overlapping boxes", "[fast][NonMaximumSuppression]") {
+    auto input = BoundingBoxSet::New();
+    input->create();
+    {
+        auto access = input->getAccess(ACCESS_READ_WRITE);
+        access->addBoundingBox(Vector2f(0, 0), Vector2f(10, 10), 1, 0.5f);
+        access->addBoundingBox(Vector2f(1, 1), Vector2f(10, 10), 1, 0.9f);
+        access->addBoundingBox(Vector2f(50, 50), Vector2f(10, 10), 1, 0.3f);
+        access->addBoundingBox(Vector2f(2, 2), Vector2f(10, 10), 2, 0.4f);
+    }
+
+    auto nms = NonMaximumSuppression::New();
+    nms->setThreshold(0.5f);
+    auto output = runNMS(nms, input);
+    auto scores = output->getAccess(ACCESS_READ)->getScores();
+    REQUIRE(scores.size() == 2);
+    CHECK(scores[0] == 0.9f);
+    CHECK(scores[1] == 0.3f);
+
+    // Box with other label is kept in per class mode
+    nms->setPerClass(true);
+    output = runNMS(nms, input);
+    scores = output->getAccess(ACCESS_READ)->getScores();
+    REQUIRE(scores.size() == 3);
+    CHECK(scores[1] == 0.4f);
+}
+
+TEST_CASE("Soft non maximum suppression reduces score of overlapping boxes", "[fast][NonMaximumSuppression]") {
+    auto input = BoundingBoxSet::New();
+    input->create();
+    {
+        auto access = input->getAccess(ACCESS_READ_WRITE);
+        access->addBoundingBox(Vector2f(0, 0), Vector2f(10, 10), 1, 0.9f);
+        access->addBoundingBox(Vector2f(0, 5), Vector2f(10, 10), 1, 0.8f);
+        access->addBoundingBox(Vector2f(0, 0), Vector2f(10, 10), 1, 0.001f);
+    }
+
+    auto nms = NonMaximumSuppression::New();
+    nms->setSoftNMS(true, 0.5f, 0.0005f);
+    auto output = runNMS(nms, input);
+    auto scores = output->getAccess(ACCESS_READ)->getScores();
+    // IoU of the two first boxes is 1/3, the last box is removed since its score becomes too low
+    REQUIRE(scores.size() == 2);
+    CHECK(scores[0] == Approx(0.9f));
+    CHECK(scores[1] == Approx(0.8f * std::exp(-1.0f / 9.0f / 0.5f)));
+}
+
+TEST_CASE("Non maximum suppression of empty set gives empty set", "[fast][NonMaximumSuppression]") {
+    auto input = BoundingBoxSet::New();
+    input->create();
+
+    for(bool soft : {false, true}) {
+        auto nms = NonMaximumSuppression::New();
+        nms->setSoftNMS(soft);
+        auto output = runNMS(nms, input);
+        CHECK(output->getAccess(ACCESS_READ)->getScores().empty());
+    }
+}
+
+TEST_CASE("Non maximum suppression gives same result as brute force", "[fast][NonMaximumSuppression]") {
+    std::default_random_engine engine(3);
+    std::uniform_real_distribution<float> position(0, 1000);
+    std::uniform_real_distribution<float> size(5, 40);
+    std::uniform_real_distribution<float> score(0, 1);
+    std::vector<Vector4f> boxes; // x, y, width, height
+    std::vector<float> boxScores;
+    auto input = BoundingBoxSet::New();
+    input->create();
+    {
+        auto access = input->getAccess(ACCESS_READ_WRITE);
+        for(int i = 0; i < 3000; ++i) {
+            boxes.push_back(Vector4f(position(engine), position(engine), size(engine), size(engine)));
+            boxScores.push_back(score(engine));
+            access->addBoundingBox(boxes[i].head(2), boxes[i].tail(2), 1, boxScores[i]);
+        }
+    }
+
+    // Greedy NMS comparing every pair of boxes
+    auto iou = [&](int a, int b) {
+        const float width = std::max(std::min(boxes[a].x() + boxes[a].z(), boxes[b].x() + boxes[b].z()) - std::max(boxes[a].x(), boxes[b].x()), 0.0f);
+        const float height = std::max(std::min(boxes[a].y() + boxes[a].w(), boxes[b].y() + boxes[b].w()) - std::max(boxes[a].y(), boxes[b].y()), 0.0f);
+        const float intersection = width * height;
+        return intersection / (boxes[a].z() * boxes[a].w() + boxes[b].z() * boxes[b].w() - intersection);
+    };
+    std::vector<int> order(boxes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return boxScores[a] > boxScores[b]; });
+    std::vector<float> expectedScores;
+    std::vector<bool> removed(boxes.size(), false);
+    for(int i = 0; i < order.size(); ++i) {
+        if(removed[order[i]])
+            continue;
+        expectedScores.push_back(boxScores[order[i]]);
+        for(int j = i + 1; j < order.size(); ++j) {
+            if(iou(order[i], order[j]) > 0.3f)
+                removed[order[j]] = true;
+        }
+    }
+
+    auto nms = NonMaximumSuppression::New();
+    nms->setThreshold(0.3f);
+    auto output = runNMS(nms, input);
+    auto scores = output->getAccess(ACCESS_READ)->getScores();
+    REQUIRE(scores.size() == expectedScores.size());
+    for(int i = 0; i < scores.size(); ++i)
+        CHECK(scores[i] == expectedScores[i]);
+}
+
+}
@@ -1,7 +1,7 @@
 #include "FAST/Algorithms/SeededRegionGrowing/SeededRegionGrowing.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/SceneGraph.hpp"
-#include <stack>
+#include <mutex>
 #include "FAST/Data/Segmentation.hpp"
 
 namespace fast {
@@ -68,74 +68,97 @@ void SeededRegionGrowing::recompileOpenCLCode(Image::pointer input) {
     mTypeCLCodeCompiledFor = input->getDataType();
 }
 
+namespace {
+
+/**
+ * A run of segmented voxels along x
+ */
+struct Span {
+    int y, z;
+    int start, end; // Inclusive
+};
+
+}
+
 template <class T>
 void SeededRegionGrowing::executeOnHost(T* input, Image::pointer output) {
     ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
     uchar* outputData = (uchar*)outputAccess->get();
+    const int width = output->getWidth();
+    const int height = output->getHeight();
+    const int depth = output->getDepth();
     // initialize output to all zero
-    memset(outputData, 0, output->getWidth()*output->getHeight()*output->getDepth());
-    std::stack<Vector3i> queue;
+    memset(outputData, 0, (std::size_t)width*height*depth);
+
+    const float minimum = mMinimumIntensity;
+    const float maximum = mMaximumIntensity;
+    // Several threads may fill the same row. All reads and writes of the segmentation of a row
+    // happen while holding the lock of the row, rows share locks in a round robin fashion.
+    std::vector<std::mutex> rowLocks(1024);
+
+    // Fill all runs of voxels in row (y, z) which overlap [from, to] and are within the intensity range.
+    // The new runs are added to spans.
+    auto fillRow = [&](int y, int z, int from, int to, std::vector<Span>& spans) {
+        if(y < 0 || z < 0 || y >= height || z >= depth)
+            return;
+        from = std::max(from, 0);
+        to = std::min(to, width - 1);
+        const std::size_t rowOffset = ((std::size_t)z*height + y)*width;
+        const T* row = &input[rowOffset];
+        uchar* segmentation = &outputData[rowOffset];
+        auto isInside = [&](int x) {
+            return segmentation[x] == 0 && row[x] >= minimum && row[x] <= maximum;
+        };
+
+        std::lock_guard<std::mutex> lock(rowLocks[((std::size_t)z*height + y) % rowLocks.size()]);
+        for(int x = from; x <= to; ++x) {
+            if(!isInside(x))
+                continue;
+            int start = x;
+            while(start > 0 && isInside(start - 1))
+                --start;
+            int end = x;
+            while(end < width - 1 && isInside(end + 1))
+                ++end;
+            memset(&segmentation[start], 1, end - start + 1);
+            spans.push_back({y, z, start, end});
+            x = end + 1;
+        }
+    };
 
-    // Add seeds to queue
+    std::vector<Span> frontier;
     for(int i = 0; i < mSeedPoints.size(); i++) {
         Vector3ui pos = mSeedPoints[i];
 
         // Check if seed point is in bounds
-        if(pos.x() < 0 || pos.y() < 0 || pos.z() < 0 ||
-            pos.x() >= output->getWidth() || pos.y() >= output->getHeight() || pos.z() >= output->getDepth())
+        if(pos.x() >= width || pos.y() >= height || pos.z() >= depth)
             throw Exception("One of the seed points given to SeededRegionGrowing was out of bounds.");
 
-        queue.push(pos.cast<int>());
+        fillRow(pos.y(), pos.z(), pos.x(), pos.x(), frontier);
     }
 
-    std::vector<Vector3i> neighborhood;
-    if(output->getDimensions() == 2) {
-        for(int a = -1; a < 2; a++) {
-            for(int b = -1; b < 2; b++) {
-                for(int c = -1; c < 2; c++) {
-                    if(abs(a) + abs(b) + abs(c) != 1) // connectivity
-                        continue;
-                    neighborhood.push_back(Vector3i(a, b, c));
+    // Grow one span neighborhood at a time. Same connectivity as the OpenCL kernels:
+    // 8-connected in 2D and 6-connected in 3D.
+    const int diagonal = output->getDimensions() == 2 ? 1 : 0;
+    while(!frontier.empty()) {
+        std::vector<Span> nextFrontier;
+        #pragma omp parallel if(frontier.size() > 64)
+        {
+            std::vector<Span> spans;
+            #pragma omp for schedule(dynamic, 16)
+            for(int i = 0; i < frontier.size(); ++i) {
+                const Span span = frontier[i];
+                fillRow(span.y - 1, span.z, span.start - diagonal, span.end + diagonal, spans);
+                fillRow(span.y + 1, span.z, span.start - diagonal, span.end + diagonal, spans);
+                if(depth > 1) {
+                    fillRow(span.y, span.z - 1, span.start, span.end, spans);
+                    fillRow(span.y, span.z + 1, span.start, span.end, spans);
                 }
             }
+            #pragma omp critical
+            nextFrontier.insert(nextFrontier.end(), spans.begin(), spans.end());
         }
-    } else {
-        for(int a = -1; a < 2; a++) {
-            for(int b = -1; b < 2; b++) {
-                if(abs(a) + abs(b) != 1) // connectivity
-                    continue;
-                neighborhood.push_back(Vector3i(a, b, 0));
-            }
-        }
-    }
-
-    // Process queue
-    while(!queue.empty()) {
-        Vector3i pos = queue.top();
-        queue.pop();
-
-        // Add neighbors to queue
-        for(auto offset : neighborhood) {
-            Vector3i neighbor = pos.cast<int>() + offset;
-            // Check for out of bounds
-            if(neighbor.x() < 0 || neighbor.y() < 0 || neighbor.z() < 0 ||
-                neighbor.x() >= output->getWidth() || neighbor.y() >= output->getHeight() || neighbor.z() >= output->getDepth())
-                continue;
-
-            // Check that voxel is not already segmented
-            if(outputData[neighbor.x()+neighbor.y()*output->getWidth()+neighbor.z()*output->getWidth()*output->getHeight()] == 1)
-                continue;
-
-            // Check condition
-            T value = input[neighbor.x()+neighbor.y()*output->getWidth()+neighbor.z()*output->getWidth()*output->getHeight()];
-            if(value >= mMinimumIntensity && value <= mMaximumIntensity) {
-                // add it to segmentation
-                outputData[neighbor.x()+neighbor.y()*output->getWidth()+neighbor.z()*output->getWidth()*output->getHeight()] = 1;
-
-                // Add to queue
-                queue.push(neighbor);
-            }
-        }
+        frontier = std::move(nextFrontier);
     }
 }
 
@@ -202,25 +225,30 @@ void SeededRegionGrowing::execute() {
         mKernel.setArg(3, mMinimumIntensity);
         mKernel.setArg(4, mMaximumIntensity);
 
+        // Reading the stop flag forces a synchronization with the device, thus run several
+        // iterations between each check. Iterations after the region has stopped growing do nothing.
+        const int iterationsPerCheck = 16;
         bool stopGrowing = false;
         char stopGrowingInit = 1;
         char stopGrowingResult;
         int iterations = 0;
         do {
-            iterations++;
-            queue.enqueueWriteBuffer(stopGrowingBuffer, CL_TRUE, 0, sizeof(char), &stopGrowingInit);
-
-            queue.enqueueNDRangeKernel(
-                    mKernel,
-                    cl::NullRange,
-                    globalSize,
-                    cl::NullRange
-            );
+            queue.enqueueWriteBuffer(stopGrowingBuffer, CL_FALSE, 0, sizeof(char), &stopGrowingInit);
+            for(int i = 0; i < iterationsPerCheck; ++i) {
+                queue.enqueueNDRangeKernel(
+                        mKernel,
+                        cl::NullRange,
+                        globalSize,
+                        cl::NullRange
+                );
+            }
+            iterations += iterationsPerCheck;
 
             queue.enqueueReadBuffer(stopGrowingBuffer, CL_TRUE, 0, sizeof(char), &stopGrowingResult);
             if(stopGrowingResult == 1)
                 stopGrowing = true;
         } while(!stopGrowing);
+        reportInfo() << "SeededRegionGrowing finished after " << iterations << " iterations" << reportEnd();
     }
 
 }
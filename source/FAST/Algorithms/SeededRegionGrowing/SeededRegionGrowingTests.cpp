@@ -3,6 +3,7 @@
 #include "FAST/Importers/ImageFileImporter.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Data/Segmentation.hpp"
+#include <chrono>
 
 namespace fast {
 
@@ -38,6 +39,30 @@ TEST_CASE("2D Seeded region growing on OpenCL device", "[fast][SeededRegionGrowi
 }
 
 
+TEST_CASE("2D Seeded region growing on Host", "[fast][SeededRegionGrowing]") {
+    ImageFileImporter::pointer importer = ImageFileImporter::New();
+    importer->setFilename(Config::getTestDataPath()+"US/Heart/ApicalFourChamber/US-2D_0.mhd");
+
+    SeededRegionGrowing::pointer algorithm = SeededRegionGrowing::New();
+    algorithm->setInputConnection(importer->getOutputPort());
+    algorithm->addSeedPoint(50,50);
+    algorithm->addSeedPoint(100,100);
+    algorithm->setIntensityRange(26,255);
+    algorithm->setMainDevice(Host::getInstance());
+    auto port = algorithm->getOutputPort();
+    algorithm->update();
+    Segmentation::pointer result = port->getNextFrame<Segmentation>();
+
+    // Should give the same result as the OpenCL implementation
+    ImageAccess::pointer access = result->getImageAccess(ACCESS_READ);
+    uchar* data = (uchar*)access->get();
+    int sum = 0;
+    for(int i = 0; i < result->getWidth()*result->getHeight(); i++) {
+        if(data[i] == 1)
+            sum++;
+    }
+    CHECK(72640 == sum);
+}
 
 TEST_CASE("3D Seeded region growing on OpenCL device", "[fast][SeededRegionGrowing]") {
     std::vector<OpenCLDevice::pointer> devices = DeviceManager::getInstance()->getAllDevices();
@@ -94,4 +119,47 @@ TEST_CASE("3D Seeded region growing on Host", "[fast][SeededRegionGrowing]") {
     CHECK(4106484 == sum);
 }
 
+TEST_CASE("Seeded region growing benchmark", "[fast][SeededRegionGrowing][benchmark]") {
+    typedef std::chrono::high_resolution_clock Clock;
+    auto importer = ImageFileImporter::New();
+    importer->setFilename(Config::getTestDataPath() + "CT/CT-Abdomen.mhd");
+    auto port = importer->getOutputPort();
+    importer->update();
+    auto input = port->getNextFrame<Image>();
+
+    std::vector<std::pair<std::string, ExecutionDevice::pointer>> devices = {{"Host", Host::getInstance()}};
+    if(!DeviceManager::getInstance()->getAllCPUDevices().empty())
+        devices.push_back({"OpenCL CPU", DeviceManager::getInstance()->getOneCPUDevice()});
+    if(!DeviceManager::getInstance()->getAllGPUDevices().empty())
+        devices.push_back({"OpenCL GPU", DeviceManager::getInstance()->getOneGPUDevice()});
+
+    int expectedSum = -1;
+    for(auto&& device : devices) {
+        INFO("Device " << device.first);
+        // Segment the air around the patient
+        auto algorithm = SeededRegionGrowing::New();
+        algorithm->setInputData(input);
+        algorithm->addSeedPoint(0, 0, 0);
+        algorithm->setIntensityRange(-2000, -500);
+        algorithm->setMainDevice(device.second);
+        auto outputPort = algorithm->getOutputPort();
+        auto start = Clock::now();
+        algorithm->update();
+        auto result = outputPort->getNextFrame<Segmentation>();
+        std::chrono::duration<double, std::milli> duration = Clock::now() - start;
+        Reporter::info() << "SeededRegionGrowing on " << device.first << ": " << duration.count() << " ms" << Reporter::end();
+
+        ImageAccess::pointer access = result->getImageAccess(ACCESS_READ);
+        uchar* data = (uchar*)access->get();
+        int sum = 0;
+        for(std::size_t i = 0; i < (std::size_t)result->getWidth()*result->getHeight()*result->getDepth(); i++) {
+            if(data[i] == 1)
+                sum++;
+        }
+        if(expectedSum < 0)
+            expectedSum = sum;
+        CHECK(sum == expectedSum);
+    }
+}
+
 } // end namespace fast
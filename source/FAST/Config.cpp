@@ -1,6 +1,7 @@
 #include "Config.hpp"
 #include "Exception.hpp"
 #include "Utility.hpp"
+#include "DeviceManager.hpp"
 #include <fstream>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
@@ -36,6 +37,8 @@ namespace fast {
 			std::string mLibraryPath;
 			std::string mQtPluginsPath;
 			StreamingMode m_streamingMode = STREAMING_MODE_PROCESS_ALL_FRAMES;
+			bool m_visualization = true;
+			bool m_pinnedHostMemory = false;
 		}
 
 		std::string Config::getPath() {
@@ -290,6 +293,24 @@ namespace fast {
 		    return m_streamingMode;
 		}
 
+		void Config::setVisualization(bool visualization) {
+		    if(!visualization && DeviceManager::hasInstance())
+		        throw Exception("Visualization must be disabled in Config before any process object is created");
+		    m_visualization = visualization;
+		}
+
+		bool Config::getVisualization() {
+		    return m_visualization;
+		}
+
+		void Config::setPinnedHostMemory(bool pinned) {
+		    m_pinnedHostMemory = pinned;
+		}
+
+		bool Config::getPinnedHostMemory() {
+		    return m_pinnedHostMemory;
+		}
+
 		void downloadTestDataIfNotExists(std::string destination, bool force) {
 			if(destination.empty())
 				destination = Config::getTestDataPath();
@@ -19,6 +19,19 @@ public:
     static std::string getQtPluginsPath();
     static StreamingMode getStreamingMode();
     static void setStreamingMode(StreamingMode mode);
+    /**
+     * Disable visualization to run FAST on a machine without a display. No Qt application or OpenGL context
+     * is created, and OpenCL devices are created without OpenGL interoperability. Renderers and views can't be used.
+     * Has to be called before any process object is created.
+     */
+    static void setVisualization(bool visualization);
+    static bool getVisualization();
+    /**
+     * Allocate host data of images in pinned memory (CL_MEM_ALLOC_HOST_PTR) on the default computation device.
+     * This makes transfers between host and device faster. Default is false.
+     */
+    static void setPinnedHostMemory(bool pinned);
+    static bool getPinnedHostMemory();
     static void setTestDataPath(std::string path);
     static void setKernelSourcePath(std::string path);
     static void setKernelBinaryPath(std::string path);
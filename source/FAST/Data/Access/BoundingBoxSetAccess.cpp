@@ -93,7 +93,8 @@ void BoundingBoxSetAccess::addBoundingBoxes(std::vector<float> coordinates, std:
 
 
 void BoundingBoxSetAccess::release() {
-	m_bbset->accessFinished();
+	if(!m_released)
+		m_bbset->accessFinished();
 	m_released = true;
 }
 
@@ -125,7 +126,8 @@ GLuint BoundingBoxSetOpenGLAccess::getLabelVBO() const {
 }
 
 void BoundingBoxSetOpenGLAccess::release() {
-	m_bbset->accessFinished();
+	if(!m_released)
+		m_bbset->accessFinished();
 	m_released = true;
 }
 
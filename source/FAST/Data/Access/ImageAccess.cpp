@@ -15,7 +15,10 @@ ImageAccess::ImageAccess(void* data, Image::pointer image) :
 }
 
 void ImageAccess::release() {
-	mImage->accessFinished();
+    if(!m_released) {
+        m_released = true;
+        mImage->accessFinished();
+    }
 }
 
 ImageAccess::~ImageAccess() {
@@ -42,6 +42,7 @@ class FAST_EXPORT  ImageAccess {
         const int m_width, m_height, m_depth, m_channels, m_dimensions;
 
         std::shared_ptr<Image> mImage;
+        bool m_released = false;
 };
 
 template <class T>
@@ -1,5 +1,6 @@
 #include "ImagePyramidAccess.hpp"
 #include <FAST/Data/ImagePyramid.hpp>
+#include <FAST/Data/ImagePyramidTileCache.hpp>
 #include <FAST/Algorithms/ImageChannelConverter/ImageChannelConverter.hpp>
 #include <FAST/Utility.hpp>
 #include <openslide/openslide.h>
@@ -7,29 +8,34 @@
 
 namespace fast {
 
-ImagePyramidAccess::ImagePyramidAccess(std::vector<ImagePyramidLevel> levels, openslide_t* fileHandle, std::shared_ptr<ImagePyramid> imagePyramid, bool write) {
+ImagePyramidAccess::ImagePyramidAccess(std::vector<ImagePyramidLevel> levels, openslide_t* fileHandle, std::shared_ptr<ImagePyramidTileStorage> tiles, std::shared_ptr<ImagePyramidTileCache> tileCache, std::shared_ptr<ImagePyramid> imagePyramid, bool write) {
 	if(levels.size() == 0)
 		throw Exception("Image pyramid has no levels");
 	m_image = imagePyramid;
 	m_levels = levels;
 	m_write = write;
     m_fileHandle = fileHandle;
+    m_tiles = tiles;
+    m_tileCache = tileCache;
 }
 
 void ImagePyramidAccess::release() {
-	m_image->accessFinished();
+    if(!m_released) {
+        m_released = true;
+        m_image->accessFinished();
+    }
 }
 
 ImagePyramidAccess::~ImagePyramidAccess() {
 	release();
 }
 
-void ImagePyramidAccess::setScalarFast(uint x, uint y, uint level, uint8_t value, uint channel) noexcept {
+void ImagePyramidAccess::setScalarFast(uint x, uint y, uint level, uint8_t value, uint channel) {
     if(!m_write)
         return;
-	auto levelData = m_levels[level];
-    std::size_t pos = (x + (std::size_t)y * levelData.width) * m_image->getNrOfChannels() + channel;
-	levelData.data[pos] = value;
+	if(!m_tiles)
+		throw Exception("setScalar is not supported for image pyramids read from file");
+    m_tiles->setScalar(x, y, level, channel, value);
 
     // add patch to list of dirty patches
     int levelWidth = m_image->getLevelWidth(level);
@@ -74,16 +80,41 @@ void ImagePyramidAccess::setScalar(uint x, uint y, uint level, uint8_t value, ui
     setScalarFast(x, y, level, value, channel);
 }
 
+void ImagePyramidAccess::setPatch(int level, int x, int y, std::shared_ptr<Image> patch) {
+	if(!m_write)
+		throw Exception("ImagePyramidAccess has not write rights, but tried to write a patch");
+	if(!m_tiles)
+		throw Exception("setPatch is not supported for image pyramids read from file");
+	if(level < 0 || level >= m_levels.size())
+		throw Exception("Incorrect level given to setPatch: " + std::to_string(level));
+	if(patch->getDimensions() != 2 || patch->getDataType() != TYPE_UINT8)
+		throw Exception("Patch given to setPatch must be a 2D image of type uint8");
+	if(patch->getNrOfChannels() != m_image->getNrOfChannels())
+		throw Exception("Patch given to setPatch must have the same nr of channels as the image pyramid");
+
+	const int width = patch->getWidth();
+	const int height = patch->getHeight();
+	{
+		auto patchAccess = patch->getImageAccess(ACCESS_READ);
+		m_tiles->setRegion(level, x, y, width, height, (const uint8_t*)patchAccess->get());
+	}
+	m_image->setDirtyRegion(level, x, y, width, height);
+	m_image->updateLowerLevels(level, x, y, width, height);
+}
+
 uint8_t ImagePyramidAccess::getScalar(uint x, uint y, uint level, uint channel) {
 	auto levelData = m_levels[level];
 	if(x >= levelData.width || y >= levelData.height)
 		throw OutOfBoundsException();
-	return levelData.data[(x + y * levelData.width) * m_image->getNrOfChannels() + channel];
+	if(!m_tiles)
+		throw Exception("getScalar is not supported for image pyramids read from file");
+	return m_tiles->getScalar(x, y, level, channel);
 }
 
-uint8_t ImagePyramidAccess::getScalarFast(uint x, uint y, uint level, uint channel) noexcept {
-	auto levelData = m_levels[level];
-	return levelData.data[(x + y * levelData.width) * m_image->getNrOfChannels() + channel];
+uint8_t ImagePyramidAccess::getScalarFast(uint x, uint y, uint level, uint channel) {
+	if(!m_tiles)
+		throw Exception("getScalar is not supported for image pyramids read from file");
+	return m_tiles->getScalar(x, y, level, channel);
 }
 
 
@@ -105,18 +136,13 @@ std::unique_ptr<uchar[]> ImagePyramidAccess::getPatchData(int level, int x, int
     const int levelHeight = m_image->getLevelHeight(level);
     const int channels = m_image->getNrOfChannels();
     auto data = make_uninitialized_unique<uchar[]>(width*height*channels);
-    if(m_fileHandle != nullptr) {
+    if(m_tileCache) {
+        m_tileCache->getRegion(level, x, y, width, height, data.get());
+    } else if(m_fileHandle != nullptr) {
 		float scale = (float)m_image->getFullWidth()/levelWidth;
         openslide_read_region(m_fileHandle, (uint32_t*)data.get(), x * scale, y * scale, level, width, height);
     } else {
-        auto levelData = m_levels[level];
-        for(int cy = y; cy < std::min(y + height, levelHeight); ++cy) {
-            for(int cx = x; cx < std::min(x + width, levelWidth); ++cx) {
-                for(int channel = 0; channel < channels; ++channel) {
-                    data[(cx - x + (cy - y) * width)*channels + channel] = levelData.data[(cx + cy * levelWidth)*channels + channel];
-                }
-            }
-        }
+        m_tiles->getRegion(level, x, y, width, height, data.get());
     }
 
     return data;
@@ -154,19 +180,15 @@ std::shared_ptr<Image> ImagePyramidAccess::getLevelAsImage(int level) {
         throw Exception("Image level is too large to convert into a FAST image");
 
     auto image = Image::New();
-    if(m_fileHandle == nullptr) {
-		image->create(width, height, TYPE_UINT8, 4, m_levels[level].data);
-    } else {
-		auto data = make_uninitialized_unique<uchar[]>(width*height*4);
-        openslide_read_region(m_fileHandle, (uint32_t*)data.get(), 0, 0, level, width, height);
-		image->create(width, height, TYPE_UINT8, 4, std::move(data));
-    }
+    image->create(width, height, TYPE_UINT8, m_image->getNrOfChannels(), getPatchData(level, 0, 0, width, height));
     image->setSpacing(Vector3f(
             (float)m_image->getFullWidth() / width,
             (float)m_image->getFullHeight() / height,
             1.0f
     ));
     SceneGraph::setParentNode(image, std::dynamic_pointer_cast<SpatialDataObject>(m_image));
+    if(m_fileHandle == nullptr)
+        return image;
 
     // Data is stored as BGRA, need to delete alpha channel and reverse it
     auto channelConverter = ImageChannelConverter::New();
@@ -187,10 +209,25 @@ std::shared_ptr<Image> ImagePyramidAccess::getPatchAsImage(int level, int offset
     if(offsetX + width >= m_image->getLevelWidth(level) || offsetY + height >= m_image->getLevelHeight(level))
         throw Exception("offset + size exceeds level size");
 
-    auto image = Image::New();
     auto data = getPatchData(level, offsetX, offsetY, width, height);
+    int channels = m_image->getNrOfChannels();
+    if(m_fileHandle != nullptr) {
+        // Data is stored as BGRA, delete alpha channel and reverse it.
+        // This is done here instead of with an ImageChannelConverter, so that patches can be read from several threads.
+        const std::size_t pixels = (std::size_t)width*height;
+        auto rgbData = make_uninitialized_unique<uchar[]>(pixels*3);
+        for(std::size_t i = 0; i < pixels; ++i) {
+            rgbData[i*3] = data[i*4 + 2];
+            rgbData[i*3 + 1] = data[i*4 + 1];
+            rgbData[i*3 + 2] = data[i*4];
+        }
+        data = std::move(rgbData);
+        channels = 3;
+    }
+
+    auto image = Image::New();
     float scale = (float)m_image->getFullWidth()/m_image->getLevelWidth(level);
-    image->create(width, height, TYPE_UINT8, 4, std::move(data));
+    image->create(width, height, TYPE_UINT8, channels, std::move(data));
     image->setSpacing(Vector3f(
             scale,
             scale,
@@ -199,13 +236,7 @@ std::shared_ptr<Image> ImagePyramidAccess::getPatchAsImage(int level, int offset
     // TODO Set transformation
     SceneGraph::setParentNode(image, std::dynamic_pointer_cast<SpatialDataObject>(m_image));
 
-    // Data is stored as BGRA, need to delete alpha channel and reverse it
-    auto channelConverter = ImageChannelConverter::New();
-    channelConverter->setChannelsToRemove(false, false, false, true);
-    channelConverter->setReverseChannels(true);
-    channelConverter->setInputData(image);
-
-    return channelConverter->updateAndGetOutputData<Image>();
+    return image;
 }
 
 std::shared_ptr<Image> ImagePyramidAccess::getPatchAsImage(int level, int patchIdX, int patchIdY) {
@@ -9,6 +9,8 @@ namespace fast {
 
 class Image;
 class ImagePyramid;
+class ImagePyramidTileStorage;
+class ImagePyramidTileCache;
 
 class FAST_EXPORT ImagePyramidPatch {
 public:
@@ -26,23 +28,22 @@ public:
 	int tileWidth = 256;
 	int tileHeight = 256;
 	int patches;
-	bool memoryMapped;
-	uint8_t* data;
-#ifdef WIN32
-	void* fileHandle;
-#else
-	int fileHandle;
-#endif
 };
 
 class FAST_EXPORT ImagePyramidAccess : Object {
 public:
 	typedef std::unique_ptr<ImagePyramidAccess> pointer;
-	ImagePyramidAccess(std::vector<ImagePyramidLevel> levels, openslide_t* fileHandle, std::shared_ptr<ImagePyramid> imagePyramid, bool writeAccess);
+	ImagePyramidAccess(std::vector<ImagePyramidLevel> levels, openslide_t* fileHandle, std::shared_ptr<ImagePyramidTileStorage> tiles, std::shared_ptr<ImagePyramidTileCache> tileCache, std::shared_ptr<ImagePyramid> imagePyramid, bool writeAccess);
 	void setScalar(uint x, uint y, uint level, uint8_t value, uint channel = 0);
-	void setScalarFast(uint x, uint y, uint level, uint8_t value, uint channel = 0) noexcept;
+	void setScalarFast(uint x, uint y, uint level, uint8_t value, uint channel = 0);
+	/**
+	 * Write an entire patch into the given level at offset x, y, and update the lower resolution levels.
+	 * The patch must be a 2D uint8 image with the same nr of channels as the pyramid.
+	 * Parts of the patch outside the level are ignored.
+	 */
+	void setPatch(int level, int x, int y, std::shared_ptr<Image> patch);
 	uint8_t getScalar(uint x, uint y, uint level, uint channel = 0);
-	uint8_t getScalarFast(uint x, uint y, uint level, uint channel = 0) noexcept;
+	uint8_t getScalarFast(uint x, uint y, uint level, uint channel = 0);
 	std::unique_ptr<uchar[]> getPatchData(int level, int x, int y, int width, int height);
 	ImagePyramidPatch getPatch(std::string tile);
 	ImagePyramidPatch getPatch(int level, int patchX, int patchY);
@@ -56,6 +57,9 @@ private:
 	std::vector<ImagePyramidLevel> m_levels;
 	bool m_write;
 	openslide_t* m_fileHandle;
+	std::shared_ptr<ImagePyramidTileStorage> m_tiles;
+	std::shared_ptr<ImagePyramidTileCache> m_tileCache;
+	bool m_released = false;
 };
 
 }
\ No newline at end of file
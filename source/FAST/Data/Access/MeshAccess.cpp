@@ -20,7 +20,10 @@ MeshAccess::MeshAccess(
 }
 
 void MeshAccess::release() {
-	mMesh->accessFinished();
+    if(!m_released) {
+        m_released = true;
+        mMesh->accessFinished();
+    }
 }
 
 MeshAccess::~MeshAccess() {
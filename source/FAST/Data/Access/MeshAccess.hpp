@@ -42,6 +42,7 @@ class FAST_EXPORT  MeshAccess {
 		std::vector<uint>* mLines;
 		std::vector<uint>* mTriangles;
         std::shared_ptr<Mesh> mMesh;
+        bool m_released = false;
 };
 
 } // end namespace fast
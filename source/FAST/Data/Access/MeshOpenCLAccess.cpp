@@ -49,8 +49,8 @@ void MeshOpenCLAccess::release() {
         mLineBuffer = nullptr;
         mTriangleBuffer = nullptr;
         mIsDeleted = true;
+        mMesh->accessFinished();
     }
-    mMesh->accessFinished();
 }
 
 MeshOpenCLAccess::~MeshOpenCLAccess() {
@@ -21,8 +21,8 @@ void OpenCLBufferAccess::release() {
         delete mBuffer;
         mBuffer = nullptr;
         mIsDeleted = true;
+        mDataObject->accessFinished();
     }
-	mDataObject->accessFinished();
 }
 
 OpenCLBufferAccess::~OpenCLBufferAccess() {
@@ -31,11 +31,11 @@ OpenCLImageAccess::OpenCLImageAccess(cl::Image2D* image, std::shared_ptr<Image>
 }
 
 void OpenCLImageAccess::release() {
-	mImageObject->accessFinished();
     if(!mIsDeleted) {
         delete mImage;
         mImage = nullptr;
         mIsDeleted = true;
+        mImageObject->accessFinished();
     }
 }
 
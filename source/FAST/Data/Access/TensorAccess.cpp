@@ -18,7 +18,10 @@ TensorAccess::~TensorAccess() {
 }
 
 void TensorAccess::release() {
-    m_tensor->accessFinished();
+    if(!m_released) {
+        m_released = true;
+        m_tensor->accessFinished();
+    }
 }
 
 float* TensorAccess::getRawData() {
@@ -26,6 +26,7 @@ class FAST_EXPORT TensorAccess {
         std::shared_ptr<Tensor> m_tensor;
         TensorShape m_shape;
         float* m_data;
+        bool m_released = false;
 };
 
 
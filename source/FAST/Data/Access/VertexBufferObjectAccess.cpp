@@ -54,7 +54,6 @@ VertexBufferObjectAccess::VertexBufferObjectAccess(
 }
 
 void VertexBufferObjectAccess::release() {
-	mMesh->accessFinished();
     if(!mIsDeleted) {
         delete mCoordinateVBO;
         delete mNormalVBO;
@@ -62,6 +61,7 @@ void VertexBufferObjectAccess::release() {
         delete mLineEBO;
         delete mTriangleEBO;
         mIsDeleted = true;
+        mMesh->accessFinished();
     }
 }
 
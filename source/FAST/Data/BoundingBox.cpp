@@ -127,13 +127,7 @@ BoundingBoxSetAccess::pointer BoundingBoxSet::getAccess(accessType type) {
         throw Exception("BoundingBoxSet has not been initialized.");
     }
 
-    blockIfBeingWrittenTo();
-
-    if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-		std::lock_guard<std::mutex> lock(mDataIsBeingWrittenToMutex);
-		mDataIsBeingWrittenTo = true;
-    }
+    beginAccess(type);
     // Update data:
     if(!mHostHasData) {
 #ifdef FAST_MODULE_VISUALIZATION
@@ -183,10 +177,6 @@ BoundingBoxSetAccess::pointer BoundingBoxSet::getAccess(accessType type) {
         updateModifiedTimestamp();
     }
     mHostDataIsUpToDate = true;
-    {
-        std::lock_guard<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
-    }
 
     BoundingBoxSetAccess::pointer accessObject(new BoundingBoxSetAccess(&mCoordinates, &mLines, &m_labels, &m_scores, std::static_pointer_cast<BoundingBoxSet>(mPtr.lock())));
 	return std::move(accessObject);
@@ -197,13 +187,7 @@ BoundingBoxSetOpenGLAccess::pointer BoundingBoxSet::getOpenGLAccess(
     if(!mIsInitialized)
         throw Exception("BoundingBoxSet has not been initialized.");
 
-    blockIfBeingWrittenTo();
-
-    if (type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-		std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-		mDataIsBeingWrittenTo = true;
-    }
+    beginAccess(type);
     // Update data
     if(!mVBOHasData) {
         // VBO has not allocated data: Create VBO
@@ -277,10 +261,6 @@ BoundingBoxSetOpenGLAccess::pointer BoundingBoxSet::getOpenGLAccess(
     }
 	mVBODataIsUpToDate = true;
 
-    {
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
-    }
 
 	BoundingBoxSetOpenGLAccess::pointer accessObject(
             new BoundingBoxSetOpenGLAccess(
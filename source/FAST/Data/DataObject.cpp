@@ -5,38 +5,66 @@ namespace fast {
 
 DataObject::DataObject() :
         mTimestampModified(0),
-        mTimestampCreated(0) {
+        mTimestampCreated(0),
+        m_accessCount(0),
+        m_accessWaiting(0) {
+}
+
+void DataObject::beginAccess(accessType type) {
+    if(type == ACCESS_READ) {
+        // Fast path: no writer, just increment the nr of readers
+        int count = m_accessCount.load();
+        while(count >= 0) {
+            if(m_accessCount.compare_exchange_weak(count, count + 1))
+                return;
+        }
+    }
 
-    mDataIsBeingAccessed = false;
-    mDataIsBeingWrittenTo = false;
+    // Slow path: wait until the data is not being written to, or for writers until there are no other accesses
+    std::unique_lock<std::mutex> lock(m_accessMutex);
+    ++m_accessWaiting;
+    while(true) {
+        int count = m_accessCount.load();
+        if(type == ACCESS_READ) {
+            if(count >= 0 && m_accessCount.compare_exchange_strong(count, count + 1))
+                break;
+        } else {
+            if(count == 0 && m_accessCount.compare_exchange_strong(count, -1))
+                break;
+        }
+        m_accessCondition.wait(lock);
+    }
+    --m_accessWaiting;
 }
 
-void DataObject::blockIfBeingWrittenTo() {
-    std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-    while(mDataIsBeingWrittenTo) {
-        mDataIsBeingWrittenToCondition.wait(lock);
+void DataObject::accessFinished() {
+    int count = m_accessCount.load();
+    int newCount;
+    do {
+        if(count == 0) {
+            // Called from destructors of access objects, thus don't throw
+            reportError() << "accessFinished was called on " << getNameOfClass() << " which is not being accessed" << reportEnd();
+            return;
+        }
+        // Writers are exclusive, thus if the data is being written to, this must be the writer
+        newCount = count == -1 ? 0 : count - 1;
+    } while(!m_accessCount.compare_exchange_weak(count, newCount));
+
+    // Only the last access can unblock anyone, and only lock the mutex if someone is waiting
+    if(newCount == 0 && m_accessWaiting.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_accessMutex);
+        }
+        m_accessCondition.notify_all();
     }
 }
 
-void DataObject::blockIfBeingAccessed() {
-    std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-    while(mDataIsBeingAccessed) {
-        mDataIsBeingWrittenToCondition.wait(lock);
-    }
+int DataObject::getNrOfReaders() const {
+    return std::max(m_accessCount.load(), 0);
 }
 
-void DataObject::accessFinished() {
-	{
-        std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-        mDataIsBeingWrittenTo = false;
-	}
-	mDataIsBeingWrittenToCondition.notify_one();
-
-	{
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = false;
-	}
-	mDataIsBeingAccessedCondition.notify_one();
+bool DataObject::isBeingWrittenTo() const {
+    return m_accessCount.load() == -1;
 }
 
 uint64_t DataObject::getTimestamp() const {
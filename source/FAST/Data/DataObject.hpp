@@ -4,9 +4,11 @@
 
 #include "FAST/Object.hpp"
 #include "FAST/ExecutionDevice.hpp"
+#include "FAST/Data/Access/Access.hpp"
 #include <unordered_map>
 #include <unordered_set>
 #include <condition_variable>
+#include <atomic>
 
 namespace fast {
 
@@ -36,22 +38,39 @@ class FAST_EXPORT  DataObject : public Object {
         void setFrameData(std::string name, std::string value);
         std::string getFrameData(std::string name);
         std::unordered_map<std::string, std::string> getFrameData();
+        /**
+         * Called by access objects when they are released. Each access object must call this exactly once.
+         */
         void accessFinished();
+        /**
+         * @return nr of access objects currently reading this data object
+         */
+        int getNrOfReaders() const;
+        /**
+         * @return true if an access object is currently writing to this data object
+         */
+        bool isBeingWrittenTo() const;
     protected:
         virtual void free(ExecutionDevice::pointer device) = 0;
         virtual void freeAll() = 0;
 
-        void blockIfBeingWrittenTo();
-        void blockIfBeingAccessed();
+        /**
+         * Register a new access to this data object. Any nr of readers can access the data at the same time,
+         * while a writer has exclusive access. Thus a read blocks while the data is being written to,
+         * and a write blocks until all other accesses have finished. Uncontended reads don't lock any mutex.
+         * Every call must be matched by a call to accessFinished.
+         */
+        void beginAccess(accessType type);
 
-        std::mutex mDataIsBeingWrittenToMutex;
-        std::condition_variable mDataIsBeingWrittenToCondition;
-        bool mDataIsBeingWrittenTo;
-
-        std::mutex mDataIsBeingAccessedMutex;
-        std::condition_variable mDataIsBeingAccessedCondition;
-        bool mDataIsBeingAccessed;
+        // Serializes transfers of data between devices, as several readers may request the data at the same time
+        std::mutex mDataTransferMutex;
     private:
+        // Nr of readers, or -1 if the data is being written to
+        std::atomic<int> m_accessCount;
+        // Nr of threads waiting in beginAccess
+        std::atomic<int> m_accessWaiting;
+        std::mutex m_accessMutex;
+        std::condition_variable m_accessCondition;
 
         // Timestamp is set to 0 when data object is constructed
         uint64_t mTimestampModified;
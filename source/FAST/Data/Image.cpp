@@ -18,22 +18,41 @@ unique_pixel_ptr allocatePixelArray(std::size_t size, DataType type) {
     return ptr;
 }
 
+unique_pixel_ptr allocatePinnedPixelArray(std::size_t size, DataType type, OpenCLDevice::pointer device) {
+    const std::size_t bytes = size*getSizeOfDataType(type, 1);
+    cl::Buffer* buffer = device->getMemoryPool()->getBuffer(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bytes);
+    void* data = device->getCommandQueue().enqueueMapBuffer(*buffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, bytes);
+    return unique_pixel_ptr(data, [device, buffer](void* data) {
+        device->getCommandQueue().enqueueUnmapMemObject(*buffer, data);
+        device->getMemoryPool()->release(buffer);
+    });
+}
+
 // Pad data with 1, 2 or 3 channels to 4 channels with 0
 template <class T>
-void * padData(T * data, unsigned int size, unsigned int nrOfChannels) {
-    T * newData = new T[size*4]();
+void padData(const T * data, T * newData, unsigned int size, unsigned int nrOfChannels) {
     for(unsigned int i = 0; i < size; i++) {
     	if(nrOfChannels == 1) {
             newData[i*4] = data[i];
+            newData[i*4+1] = 0;
+            newData[i*4+2] = 0;
     	} else if(nrOfChannels == 2) {
             newData[i*4] = data[i*2];
             newData[i*4+1] = data[i*2+1];
+            newData[i*4+2] = 0;
     	} else {
             newData[i*4] = data[i*3];
             newData[i*4+1] = data[i*3+1];
             newData[i*4+2] = data[i*3+2];
     	}
+        newData[i*4+3] = 0;
     }
+}
+
+template <class T>
+void * padData(T * data, unsigned int size, unsigned int nrOfChannels) {
+    T * newData = new T[size*4];
+    padData(data, newData, size, nrOfChannels);
     return (void *)newData;
 }
 
@@ -52,8 +71,7 @@ const void * const adaptDataToImage(const void* const data, cl_channel_order ord
 
 // Remove padding from a data array created by padData
 template <class T>
-void * removePadding(T * data, unsigned int size, unsigned int nrOfChannels) {
-     T * newData = new T[size*nrOfChannels];
+void removePadding(const T * data, T * newData, unsigned int size, unsigned int nrOfChannels) {
     for(unsigned int i = 0; i < size; i++) {
     	if(nrOfChannels == 1) {
             newData[i] = data[i*4];
@@ -66,59 +84,79 @@ void * removePadding(T * data, unsigned int size, unsigned int nrOfChannels) {
             newData[i*3+2] = data[i*4+2];
     	}
     }
-    return (void *)newData;
 }
 
-unique_pixel_ptr adaptImageDataToHostData(unique_pixel_ptr data, cl_channel_order order, unsigned int size, DataType type, unsigned int nrOfChannels) {
-    // Because no OpenCL images support 3 channels,
-    // the data has to be padded to 4 channels if the nr of channels is 3.
-    // Also, not all CL platforms support CL_R and CL_RG images
-    // This function removes that padding
-    if(order == CL_RGBA && nrOfChannels != 4) {
-        switch(type) {
-            fastSwitchTypeMacro(return unique_pixel_ptr(removePadding<FAST_TYPE>((FAST_TYPE*)data.get(), size, nrOfChannels), &pixel_deleter<FAST_TYPE>))
-        }
+unique_pixel_ptr Image::allocateHostData(uint nrOfChannels) {
+    const std::size_t size = (std::size_t)mWidth*mHeight*mDepth*nrOfChannels;
+    if(Config::getPinnedHostMemory()) {
+        auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+        if(device)
+            return allocatePinnedPixelArray(size, mType, device);
     }
-
-    return data;
+    return allocatePixelArray(size, mType);
 }
 
+void Image::addHostTransferEvent(cl::Event event) {
+    // Remove transfers which have finished
+    mHostTransferEvents.erase(std::remove_if(mHostTransferEvents.begin(), mHostTransferEvents.end(), [](cl::Event& event) {
+        return event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() == CL_COMPLETE;
+    }), mHostTransferEvents.end());
+    mHostTransferEvents.push_back(event);
+}
 
+void Image::waitForHostTransfers() {
+    if(mHostTransferEvents.empty())
+        return;
+    cl::Event::waitForEvents(mHostTransferEvents);
+    mHostTransferEvents.clear();
+}
 
 void Image::transferCLImageFromHost(OpenCLDevice::pointer device) {
 
     // Special treatment for images with 3 channels because an OpenCL image can only have 1, 2 or 4 channels
 	// And if the device does not support 1 or 2 channels
     cl::ImageFormat format = getOpenCLImageFormat(device, mDimensions == 2 ? CL_MEM_OBJECT_IMAGE2D : CL_MEM_OBJECT_IMAGE3D, mType, mChannels);
+    void* data = mHostData.get();
     if(format.image_channel_order == CL_RGBA && mChannels != 4) {
-        auto tempData = adaptDataToImage(mHostData.get(), CL_RGBA, mWidth*mHeight*mDepth, mType, mChannels);
-        device->getCommandQueue().enqueueWriteImage(*(cl::Image*)mCLImages[device],
-        CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
-                0, (void*)tempData);
-        deleteArray((void*)tempData, mType);
-    } else {
-        device->getCommandQueue().enqueueWriteImage(*(cl::Image*)mCLImages[device],
-        CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
-                0, mHostData.get());
+        // A previous transfer may still be reading the padded data
+        waitForHostTransfers();
+        if(!mPaddedHostData)
+            mPaddedHostData = allocateHostData(4);
+        switch(mType) {
+            fastSwitchTypeMacro(padData<FAST_TYPE>((FAST_TYPE*)mHostData.get(), (FAST_TYPE*)mPaddedHostData.get(), mWidth*mHeight*mDepth, mChannels))
+        }
+        data = mPaddedHostData.get();
     }
+    // Non-blocking, commands on the device queue are executed in order after this transfer.
+    // The host data is kept until the transfer has finished, see waitForHostTransfers.
+    cl::Event event;
+    device->getCommandQueue().enqueueWriteImage(*(cl::Image*)mCLImages[device],
+    CL_FALSE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
+            0, data, NULL, &event);
+    addHostTransferEvent(event);
 }
 
 void Image::transferCLImageToHost(OpenCLDevice::pointer device) {
+    // Host data can't be overwritten while it is being transferred to another device
+    waitForHostTransfers();
+    if(!mHostHasData) {
+        // Must allocate memory for host data
+        mHostData = allocateHostData(mChannels);
+        mHostHasData = true;
+    }
     // Special treatment for images with 3 channels because an OpenCL image can only have 1, 2 or 4 channels
 	// And if the device does not support 1 or 2 channels
     cl::ImageFormat format = getOpenCLImageFormat(device, mDimensions == 2 ? CL_MEM_OBJECT_IMAGE2D : CL_MEM_OBJECT_IMAGE3D, mType, mChannels);
     if(format.image_channel_order == CL_RGBA && mChannels != 4) {
-        auto tempData = allocatePixelArray(mWidth*mHeight*mDepth*4, mType);
+        if(!mPaddedHostData)
+            mPaddedHostData = allocateHostData(4);
         device->getCommandQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
         CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
-                0, tempData.get());
-        mHostData = adaptImageDataToHostData(std::move(tempData), CL_RGBA, mWidth*mHeight*mDepth,mType,mChannels);
-    } else {
-        if(!mHostHasData) {
-            // Must allocate memory for host data
-            mHostData = allocatePixelArray(mWidth*mHeight*mDepth*mChannels,mType);
-			mHostHasData = true;
+                0, mPaddedHostData.get());
+        switch(mType) {
+            fastSwitchTypeMacro(removePadding<FAST_TYPE>((FAST_TYPE*)mPaddedHostData.get(), (FAST_TYPE*)mHostData.get(), mWidth*mHeight*mDepth, mChannels))
         }
+    } else {
         device->getCommandQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
         CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
                 0, mHostData.get());
@@ -141,10 +179,10 @@ void Image::updateOpenCLImageData(OpenCLDevice::pointer device) {
         // Data is not on device, create it
         cl::Image * newImage;
         if(mDimensions == 2) {
-            newImage = new cl::Image2D(device->getContext(),
+            newImage = device->getMemoryPool()->getImage2D(
             CL_MEM_READ_WRITE, getOpenCLImageFormat(device, CL_MEM_OBJECT_IMAGE2D, mType,mChannels), mWidth, mHeight);
         } else {
-            newImage = new cl::Image3D(device->getContext(),
+            newImage = device->getMemoryPool()->getImage3D(
             CL_MEM_READ_WRITE, getOpenCLImageFormat(device, CL_MEM_OBJECT_IMAGE3D, mType,mChannels), mWidth, mHeight, mDepth);
         }
 
@@ -204,26 +242,24 @@ OpenCLBufferAccess::pointer Image::getOpenCLBufferAccess(
     if(!isInitialized())
         throw Exception("Image has not been initialized.");
 
-    blockIfBeingWrittenTo();
-
-    if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-        std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-        mDataIsBeingWrittenTo = true;
-    }
-    updateOpenCLBufferData(device);
-    if(type == ACCESS_READ_WRITE) {
-        setAllDataToOutOfDate();
-        updateModifiedTimestamp();
-    }
-    mCLBuffersIsUpToDate[device] = true;
-    {
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
+    beginAccess(type);
+    cl::Buffer* buffer;
+    try {
+        std::lock_guard<std::mutex> lock(mDataTransferMutex);
+        updateOpenCLBufferData(device);
+        if(type == ACCESS_READ_WRITE) {
+            setAllDataToOutOfDate();
+            updateModifiedTimestamp();
+        }
+        mCLBuffersIsUpToDate[device] = true;
+        buffer = mCLBuffers[device];
+    } catch(...) {
+        accessFinished();
+        throw;
     }
 
     // Now it is guaranteed that the data is on the device and that it is up to date
-	OpenCLBufferAccess::pointer accessObject(new OpenCLBufferAccess(mCLBuffers[device],  std::static_pointer_cast<Image>(mPtr.lock())));
+	OpenCLBufferAccess::pointer accessObject(new OpenCLBufferAccess(buffer, std::static_pointer_cast<Image>(mPtr.lock())));
 	return std::move(accessObject);
 }
 
@@ -248,8 +284,7 @@ void Image::updateOpenCLBufferData(OpenCLDevice::pointer device) {
     if (mCLBuffers.count(device) == 0) {
         // Data is not on device, create it
         unsigned int bufferSize = getBufferSize();
-        cl::Buffer * newBuffer = new cl::Buffer(device->getContext(),
-        CL_MEM_READ_WRITE, bufferSize);
+        cl::Buffer * newBuffer = device->getMemoryPool()->getBuffer(CL_MEM_READ_WRITE, bufferSize);
 
         if(hasAnyData()) {
             mCLBuffersIsUpToDate[device] = false;
@@ -303,14 +338,19 @@ void Image::updateOpenCLBufferData(OpenCLDevice::pointer device) {
 
 void Image::transferCLBufferFromHost(OpenCLDevice::pointer device) {
     unsigned int bufferSize = getBufferSize();
+    // Non-blocking, see transferCLImageFromHost
+    cl::Event event;
     device->getCommandQueue().enqueueWriteBuffer(*mCLBuffers[device],
-        CL_TRUE, 0, bufferSize, mHostData.get());
+        CL_FALSE, 0, bufferSize, mHostData.get(), NULL, &event);
+    addHostTransferEvent(event);
 }
 
 void Image::transferCLBufferToHost(OpenCLDevice::pointer device) {
+    // Host data can't be overwritten while it is being transferred to another device
+    waitForHostTransfers();
 	if (!mHostHasData) {
 		// Must allocate memory for host data
-		mHostData = allocatePixelArray(mWidth*mHeight*mDepth*mChannels, mType);
+		mHostData = allocateHostData(mChannels);
 		mHostHasData = true;
 	}
     unsigned int bufferSize = getBufferSize();
@@ -329,7 +369,7 @@ void Image::updateHostData() {
         unsigned int size = mWidth*mHeight*mChannels;
         if(mDimensions == 3)
             size *= mDepth;
-        mHostData = allocatePixelArray(mWidth*mHeight*mDepth*mChannels,mType);
+        mHostData = allocateHostData(mChannels);
         if(hasAnyData()) {
             mHostDataIsUpToDate = false;
         } else {
@@ -384,31 +424,28 @@ OpenCLImageAccess::pointer Image::getOpenCLImageAccess(
     if(!isInitialized())
         throw Exception("Image has not been initialized.");
 
-    blockIfBeingWrittenTo();
-
-    // Check for write access
-    if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-    	std::lock_guard<std::mutex> lock(mDataIsBeingWrittenToMutex);
-        mDataIsBeingWrittenTo = true;
-    }
-    updateOpenCLImageData(device);
-    if (type == ACCESS_READ_WRITE) {
-        setAllDataToOutOfDate();
-        updateModifiedTimestamp();
-    }
-    {
-        std::lock_guard<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
+    beginAccess(type);
+    cl::Image* image;
+    try {
+        std::lock_guard<std::mutex> lock(mDataTransferMutex);
+        updateOpenCLImageData(device);
+        if(type == ACCESS_READ_WRITE) {
+            setAllDataToOutOfDate();
+            updateModifiedTimestamp();
+        }
+        mCLImagesIsUpToDate[device] = true;
+        image = mCLImages[device];
+    } catch(...) {
+        accessFinished();
+        throw;
     }
-    mCLImagesIsUpToDate[device] = true;
 
     // Now it is guaranteed that the data is on the device and that it is up to date
     if(mDimensions == 2) {
-        OpenCLImageAccess::pointer accessObject(new OpenCLImageAccess((cl::Image2D*)mCLImages[device], std::static_pointer_cast<Image>(mPtr.lock())));
+        OpenCLImageAccess::pointer accessObject(new OpenCLImageAccess((cl::Image2D*)image, std::static_pointer_cast<Image>(mPtr.lock())));
         return accessObject;
     } else {
-        OpenCLImageAccess::pointer accessObject(new OpenCLImageAccess((cl::Image3D*)mCLImages[device], std::static_pointer_cast<Image>(mPtr.lock())));
+        OpenCLImageAccess::pointer accessObject(new OpenCLImageAccess((cl::Image3D*)image, std::static_pointer_cast<Image>(mPtr.lock())));
         return accessObject;
     }
 }
@@ -426,22 +463,20 @@ ImageAccess::pointer Image::getImageAccess(accessType type) {
     if(!isInitialized())
         throw Exception("Image has not been initialized.");
 
-    blockIfBeingWrittenTo();
-
-    if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-        std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-        mDataIsBeingWrittenTo = true;
-    }
-    updateHostData();
-    if(type == ACCESS_READ_WRITE) {
-        setAllDataToOutOfDate();
-        updateModifiedTimestamp();
-    }
-    mHostDataIsUpToDate = true;
-    {
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
+    beginAccess(type);
+    try {
+        std::lock_guard<std::mutex> lock(mDataTransferMutex);
+        updateHostData();
+        if(type == ACCESS_READ_WRITE) {
+            // Transfers from the host data must finish before it is changed
+            waitForHostTransfers();
+            setAllDataToOutOfDate();
+            updateModifiedTimestamp();
+        }
+        mHostDataIsUpToDate = true;
+    } catch(...) {
+        accessFinished();
+        throw;
     }
 
 	ImageAccess::pointer accessObject(new ImageAccess(mHostData.get(), std::static_pointer_cast<Image>(mPtr.lock())));
@@ -585,12 +620,38 @@ void Image::create(
 	create(width, height, type, nrOfChannels, DeviceManager::getInstance()->getDefaultComputationDevice(), data);
 }
 
+void Image::create(
+        unsigned int width,
+        unsigned int height,
+        DataType type,
+        unsigned int nrOfChannels,
+        void* data,
+        pixel_deleter_t deleter) {
+
+    create(width, height, type, nrOfChannels);
+    setHostData(unique_pixel_ptr(data, deleter));
+}
+
+void Image::create(
+        unsigned int width,
+        unsigned int height,
+        unsigned int depth,
+        DataType type,
+        unsigned int nrOfChannels,
+        void* data,
+        pixel_deleter_t deleter) {
+
+    create(width, height, depth, type, nrOfChannels);
+    setHostData(unique_pixel_ptr(data, deleter));
+}
+
 void Image::copyData(ExecutionDevice::pointer device, const void* const data) {
     if(!mIsInitialized)
         throw Exception("Image must be initialized");
     // We do not own this pointer, have to copy it
     if(device->isHost()) {
-        mHostData = allocatePixelArray(mWidth*mHeight*mDepth*mChannels, mType);
+        waitForHostTransfers();
+        mHostData = allocateHostData(mChannels);
         std::memcpy(mHostData.get(), data, getSizeOfDataType(mType, mChannels) * mWidth * mHeight * mDepth);
         mHostHasData = true;
         mHostDataIsUpToDate = true;
@@ -604,25 +665,21 @@ void Image::copyData(ExecutionDevice::pointer device, const void* const data) {
             tempData = (void*)adaptDataToImage(data, getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE2D, mType,
                                                                          mChannels).image_channel_order,
                                               mWidth * mHeight, mType, mChannels);
-            clImage = new cl::Image2D(
-                    clDevice->getContext(),
-                    CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+            clImage = clDevice->getMemoryPool()->getImage2D(
+                    CL_MEM_READ_WRITE,
                     getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE2D, mType, mChannels),
-                    mWidth, mHeight,
-                    0,
-                    tempData
+                    mWidth, mHeight
             );
         } else {
             tempData = (void*)adaptDataToImage(data, getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE3D, mType, mChannels).image_channel_order, mWidth*mHeight*mDepth, mType, mChannels);
-            clImage = new cl::Image3D(
-                clDevice->getContext(),
-                CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+            clImage = clDevice->getMemoryPool()->getImage3D(
+                CL_MEM_READ_WRITE,
                 getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE3D, mType, mChannels),
-                mWidth, mHeight, mDepth,
-                0, 0,
-                tempData
+                mWidth, mHeight, mDepth
             );
         }
+        // Blocking write, since the temporary copy is deleted below
+        clDevice->getCommandQueue().enqueueWriteImage(*clImage, CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0, 0, tempData);
         mCLImages[clDevice] = clImage;
         mCLImagesIsUpToDate[clDevice] = true;
         if(tempData != data) // If a new copy was made, delete it
@@ -638,10 +695,8 @@ void Image::setData(ExecutionDevice::pointer device, void* data) {
     if(device->isHost()) {
         // Since we own the data pointer, we can put it in an unique_ptr:
         switch(mType) {
-            fastSwitchTypeMacro(mHostData = make_unique_pixel<FAST_TYPE>((FAST_TYPE*)data))
+            fastSwitchTypeMacro(setHostData(make_unique_pixel<FAST_TYPE>((FAST_TYPE*)data)))
         }
-        mHostHasData = true;
-        mHostDataIsUpToDate = true;
     } else {
         // For OpenCL we have to do a copy
         copyData(device, data);
@@ -651,6 +706,13 @@ void Image::setData(ExecutionDevice::pointer device, void* data) {
     mIsInitialized = true;
 }
 
+void Image::setHostData(unique_pixel_ptr data) {
+    waitForHostTransfers();
+    mHostData = std::move(data);
+    mHostHasData = true;
+    mHostDataIsUpToDate = true;
+}
+
 bool Image::isInitialized() const {
     return mIsInitialized;
 }
@@ -658,34 +720,38 @@ bool Image::isInitialized() const {
 void Image::free(ExecutionDevice::pointer device) {
     // Delete data on a specific device
     if(device->isHost()) {
+        waitForHostTransfers();
         mHostData.reset();
+        mPaddedHostData.reset();
         mHostHasData = false;
     } else {
         OpenCLDevice::pointer clDevice = std::static_pointer_cast<OpenCLDevice>(device);
-        // Delete any OpenCL images
-        delete mCLImages[clDevice];
+        // Give any OpenCL images back to the memory pool of the device
+        if(mCLImages.count(clDevice) > 0)
+            clDevice->getMemoryPool()->release(mCLImages[clDevice]);
         mCLImages.erase(clDevice);
         mCLImagesIsUpToDate.erase(clDevice);
-        // Delete any OpenCL buffers
-        delete mCLBuffers[clDevice];
+        // Give any OpenCL buffers back to the memory pool of the device
+        if(mCLBuffers.count(clDevice) > 0)
+            clDevice->getMemoryPool()->release(mCLBuffers[clDevice]);
         mCLBuffers.erase(clDevice);
         mCLBuffersIsUpToDate.erase(clDevice);
     }
 }
 
 void Image::freeAll() {
-    // Delete OpenCL Images
+    // Give OpenCL images back to the memory pool of each device
     std::unordered_map<OpenCLDevice::pointer, cl::Image*>::iterator it;
     for (it = mCLImages.begin(); it != mCLImages.end(); it++) {
-        delete it->second;
+        it->first->getMemoryPool()->release(it->second);
     }
     mCLImages.clear();
     mCLImagesIsUpToDate.clear();
 
-    // Delete OpenCL buffers
+    // Give OpenCL buffers back to the memory pool of each device
     std::unordered_map<OpenCLDevice::pointer, cl::Buffer*>::iterator it2;
     for (it2 = mCLBuffers.begin(); it2 != mCLBuffers.end(); it2++) {
-        delete it2->second;
+        it2->first->getMemoryPool()->release(it2->second);
     }
     mCLBuffers.clear();
     mCLBuffersIsUpToDate.clear();
@@ -1032,15 +1098,13 @@ void Image::fill(float value) {
     	cl::Image* clImage;
         OpenCLDevice::pointer clDevice = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
     	if(getDimensions() == 2) {
-			clImage = new cl::Image2D(
-				clDevice->getContext(),
+			clImage = clDevice->getMemoryPool()->getImage2D(
 				CL_MEM_READ_WRITE,
 				getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE2D, mType, mChannels),
 				mWidth, mHeight
 			);
     	} else {
-			clImage = new cl::Image3D(
-				clDevice->getContext(),
+			clImage = clDevice->getMemoryPool()->getImage3D(
 				CL_MEM_READ_WRITE,
 				getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE3D, mType, mChannels),
 				mWidth, mHeight, mDepth
@@ -27,6 +27,11 @@ auto make_unique_pixel(T * ptr) -> unique_pixel_ptr {
     return unique_pixel_ptr(ptr, &pixel_deleter<T>);
 }
 unique_pixel_ptr allocatePixelArray(std::size_t size, DataType type);
+/**
+ * Allocate a pixel array in pinned host memory (CL_MEM_ALLOC_HOST_PTR) which can be transferred
+ * to and from the given OpenCL device faster, and asynchronously.
+ */
+unique_pixel_ptr allocatePinnedPixelArray(std::size_t size, DataType type, OpenCLDevice::pointer device);
 #endif
 
 class FAST_EXPORT  Image : public SpatialDataObject {
@@ -130,6 +135,35 @@ class FAST_EXPORT  Image : public SpatialDataObject {
          * @param data
          */
         void create(uint width, uint height, uint depth, DataType type, uint nrOfChannels, const void* const data);
+#ifndef SWIG
+        /**
+         * Use the given 2D host data directly, without copying it.
+         * The deleter is called with the data pointer when the image no longer needs the data.
+         * To keep the owner of an external buffer alive, capture it in the deleter,
+         * e.g. [owner](void*) {} where owner is a std::shared_ptr.
+         *
+         * @param width
+         * @param height
+         * @param type
+         * @param nrOfChannels
+         * @param data
+         * @param deleter
+         */
+        void create(uint width, uint height, DataType type, uint nrOfChannels, void* data, pixel_deleter_t deleter);
+        /**
+         * Use the given 3D host data directly, without copying it.
+         * The deleter is called with the data pointer when the image no longer needs the data.
+         *
+         * @param width
+         * @param height
+         * @param depth
+         * @param type
+         * @param nrOfChannels
+         * @param data
+         * @param deleter
+         */
+        void create(uint width, uint height, uint depth, DataType type, uint nrOfChannels, void* data, pixel_deleter_t deleter);
+#endif
 
         /**
          * Moves the 2D data pointer to the given device
@@ -268,6 +302,12 @@ class FAST_EXPORT  Image : public SpatialDataObject {
          * @param data
          */
         void copyData(ExecutionDevice::pointer device, const void* const data);
+        /**
+         * Replace the host data
+         *
+         * @param data
+         */
+        void setHostData(unique_pixel_ptr data);
 
         void findDeviceWithUptodateData(ExecutionDevice::pointer& device, bool& isOpenCLImage);
 
@@ -283,6 +323,21 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         unique_pixel_ptr mHostData;
         bool mHostHasData;
         bool mHostDataIsUpToDate;
+        // Host data padded to 4 channels, kept for transfers to OpenCL images which don't support 3 channels
+        unique_pixel_ptr mPaddedHostData;
+        // Non-blocking transfers which read from the host data
+        std::vector<cl::Event> mHostTransferEvents;
+
+        /**
+         * Allocate host data with the size of this image, in pinned memory if enabled in Config
+         */
+        unique_pixel_ptr allocateHostData(uint nrOfChannels);
+        void addHostTransferEvent(cl::Event event);
+        /**
+         * Wait until all non-blocking transfers from the host data have finished.
+         * Must be called before the host data is changed or deleted.
+         */
+        void waitForHostTransfers();
 
         void setAllDataToOutOfDate();
         bool isInitialized() const;
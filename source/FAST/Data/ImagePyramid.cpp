@@ -3,28 +3,18 @@
 #include <FAST/Utility.hpp>
 #include <FAST/Data/Image.hpp>
 #include <FAST/Data/Access/ImagePyramidAccess.hpp>
-#ifdef WIN32
-#include <winbase.h>
-#else
-#include <sys/mman.h>
-#include <fcntl.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <unistd.h>
-#endif
 
 namespace fast {
 
 int ImagePyramid::m_counter = 0;
 
 void ImagePyramid::create(int width, int height, int channels, int levels) {
-    // TODO Create memory mapped files on disk to use as virtual memory
-
     if(channels <= 0 || channels > 4)
         throw Exception("Nr of channels must be between 1 and 4");
 
+    // Levels are stored as sparse tiles which are allocated when they are written to
+    m_tiles = std::make_shared<ImagePyramidTileStorage>(channels, m_tileSize);
+
     // Determine how many levels
     int currentLevel = 0;
     int currentWidth = width;
@@ -37,110 +27,38 @@ void ImagePyramid::create(int width, int height, int channels, int levels) {
         if(currentWidth < 4096 || currentHeight < 4096)
             break;
 
-        reportInfo() << "Processing level " << currentLevel << reportEnd();
-        std::size_t bytes = (std::size_t)currentWidth * currentHeight * m_channels * sizeof(char);
-
-        // Get total size of image
-        float sizeInMB = (float)bytes / (1024 * 1024);
         reportInfo() << "WSI level size: " << currentWidth << ", " << currentHeight << ", " << m_channels << reportEnd();
-        reportInfo() << "WSI level size: " << sizeInMB << " MBs" << reportEnd();
 
 		ImagePyramidLevel levelData;
 		levelData.width = currentWidth;
 		levelData.height = currentHeight;
-
-		if(sizeInMB < 512) {
-			// If level is less than X MBs, use system memory
-			levelData.data = new uint8_t[bytes];
-			levelData.memoryMapped = false;
-		} else {
-			reportInfo() << "Using memory mapping.." << reportEnd();
-			uint8_t* data;
-#ifdef WIN32
-			HANDLE hFile = CreateFile(("C:/windows/temp/fast_mmap_" + std::to_string(currentLevel) + "_" + std::to_string(m_counter) + ".bin").c_str(),
-				GENERIC_WRITE | GENERIC_READ,FILE_SHARE_READ | FILE_SHARE_WRITE,
-				NULL, OPEN_ALWAYS, NULL, NULL);
-			if(hFile == nullptr) {
-				throw Exception("Error creating memory mapped file: " + std::to_string(GetLastError()));
-			}
-
-			levelData.fileHandle = hFile;
-
-			HANDLE hMapFile = CreateFileMappingA(
-				//INVALID_HANDLE_VALUE,    // use paging file, Creating Named Shared Memory
-				hFile,
-				NULL,                    // default security
-				PAGE_READWRITE,          // read/write access
-				bytes >> 32,                       // buffer size (high part of 64 bit nr)
-				bytes,                // buffer size (low part of 64 bit nr)
-				("fast_mmap_" + std::to_string(currentLevel)).c_str());                 // name of mapping object
-
-			if(hMapFile == NULL || hMapFile == INVALID_HANDLE_VALUE) {
-				throw Exception("Error opening memory mapped file");
-			}
-
-			data = (uint8_t*) MapViewOfFile(hMapFile,   // handle to map object
-				FILE_MAP_ALL_ACCESS, // read/write permission
-				0,
-				0,
-				bytes);
-			if(data == nullptr) {
-			  throw Exception("Failed to create map view of file: " + std::to_string(GetLastError()));
-			}
-#else
-			int fd = open(("/tmp/fast_mmap_" + std::to_string(currentLevel) + "_" + std::to_string(m_counter) + ".bin").c_str(), O_RDWR | O_CREAT | O_TRUNC, (mode_t)0600);
-			if (fd == -1) {
-				perror("Error opening file for writing");
-				exit(EXIT_FAILURE);
-			}
-
-			// Stretch the file size to the size of the (mmapped) array of ints
-			int result = lseek(fd, bytes-1, SEEK_SET);
-			if (result == -1) {
-				close(fd);
-				perror("Error calling lseek() to 'stretch' the file");
-				exit(EXIT_FAILURE);
-			}
-			result = write(fd, "", 1);
-			if (result != 1) {
-				close(fd);
-				perror("Error writing last byte of the file");
-				exit(EXIT_FAILURE);
-			}
-
-			// Now the file is ready to be mmapped.
-			data = (uint8_t*)mmap64(0, bytes-1, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-			if (data == MAP_FAILED) {
-				close(fd);
-				perror("Error mmapping the file");
-				exit(EXIT_FAILURE);
-			}
-			levelData.fileHandle = fd;
-#endif
-			// Initialize data to all zeros
-			std::memset(data, 0, bytes);
-
-			levelData.data = data;
-			levelData.memoryMapped = true;
-		}
+		levelData.tileWidth = m_tileSize;
+		levelData.tileHeight = m_tileSize;
+		m_tiles->addLevel(currentWidth, currentHeight);
 		m_levels.push_back(levelData);
 
-		// TODO Initialize data to zeros?
 		reportInfo() << "Done creating level " << currentLevel << reportEnd();
 		++currentLevel;
     }
 
+    if(m_memoryLimit > 0) {
+#ifdef WIN32
+        std::string spillFilename = "C:/windows/temp/fast_tiles_" + std::to_string(m_counter) + ".bin";
+#else
+        std::string spillFilename = "/tmp/fast_tiles_" + std::to_string(m_counter) + ".bin";
+#endif
+        m_tiles->setMemoryLimit(m_memoryLimit, spillFilename);
+    }
+
     for(int i = 0; i < m_levels.size(); ++i) {
-        int x = m_levels.size() - i - 1;
-        //m_levels[i].patches = x*x*x + 10;
-		m_levels[i].patches = std::ceil(m_levels[i].width / 256);
+		m_levels[i].patches = (m_levels[i].width + m_tileSize - 1) / m_tileSize;
     }
     mBoundingBox = DataBoundingBox(Vector3f(getFullWidth(), getFullHeight(), 0));
     m_initialized = true;
 	m_counter += 1;
 }
 
-void ImagePyramid::create(openslide_t *fileHandle, std::vector<ImagePyramidLevel> levels) {
+void ImagePyramid::create(openslide_t *fileHandle, std::vector<ImagePyramidLevel> levels, std::string filename) {
     m_fileHandle = fileHandle;
     m_levels = levels;
     m_channels = 4;
@@ -148,6 +66,8 @@ void ImagePyramid::create(openslide_t *fileHandle, std::vector<ImagePyramidLevel
         int x = m_levels.size() - i - 1;
 		m_levels[i].patches = std::ceil(m_levels[i].width / m_levels[i].tileWidth); // TODO different patch size in X and Y
     }
+    if(m_tileCacheSize > 0)
+        m_tileCache = std::make_shared<ImagePyramidTileCache>(filename, fileHandle, m_levels, m_tileCacheSize, m_tileReaderThreads);
     mBoundingBox = DataBoundingBox(Vector3f(getFullWidth(), getFullHeight(), 0));
     m_initialized = true;
 	m_counter += 1;
@@ -186,24 +106,26 @@ void ImagePyramid::free(ExecutionDevice::pointer device) {
 }
 
 void ImagePyramid::freeAll() {
+    // Stop the background downsampling thread before the tiles are deleted
+    if(m_downsampleThread) {
+        {
+            std::lock_guard<std::mutex> lock(m_downsampleMutex);
+            m_stopDownsampling = true;
+        }
+        m_downsampleCondition.notify_all();
+        m_downsampleThread->join();
+        m_downsampleThread.reset();
+        m_stopDownsampling = false;
+        m_downsampleQueue.clear();
+    }
     if(m_fileHandle != nullptr) {
         m_levels.clear();
+        // Reader threads of the cache may use the file handle
+        m_tileCache.reset();
         openslide_close(m_fileHandle);
     } else {
-		for(auto& item : m_levels) {
-			if(item.memoryMapped) {
-#ifdef WIN32
-				UnmapViewOfFile(item.data);
-				CloseHandle(item.fileHandle);
-#else
-				munmap(item.data, item.width*item.height*m_channels);
-				close(item.fileHandle);
-#endif
-			} else {
-				delete[] item.data;
-			}
-		}
         m_levels.clear();
+        m_tiles.reset();
     }
 	m_initialized = false;
 	m_fileHandle = nullptr;
@@ -220,24 +142,14 @@ ImagePyramidAccess::pointer ImagePyramid::getAccess(accessType type) {
     if(!m_initialized)
         throw Exception("ImagePyramid has not been initialized.");
 
-    blockIfBeingWrittenTo();
-
-    if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-        std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-        mDataIsBeingWrittenTo = true;
-    }
+    beginAccess(type);
     //updateHostData();
     if(type == ACCESS_READ_WRITE) {
         //setAllDataToOutOfDate();
         updateModifiedTimestamp();
     }
     //mHostDataIsUpToDate = true;
-    {
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
-    }
-    return std::make_unique<ImagePyramidAccess>(m_levels, m_fileHandle, std::static_pointer_cast<ImagePyramid>(mPtr.lock()), type == ACCESS_READ_WRITE);
+    return std::make_unique<ImagePyramidAccess>(m_levels, m_fileHandle, m_tiles, m_tileCache, std::static_pointer_cast<ImagePyramid>(mPtr.lock()), type == ACCESS_READ_WRITE);
 }
 
 void ImagePyramid::setDirtyPatch(int level, int patchIdX, int patchIdY) {
@@ -263,6 +175,118 @@ void ImagePyramid::clearDirtyPatches(std::set<std::string> patches) {
 		m_dirtyPatches.erase(patch);
 }
 
+void ImagePyramid::setDirtyRegion(int level, int x, int y, int width, int height) {
+    const int levelWidth = getLevelWidth(level);
+    const int levelHeight = getLevelHeight(level);
+    const int patches = getLevelPatches(level);
+    const int startPatchX = std::floor(((float)std::max(x, 0) / levelWidth) * patches);
+    const int startPatchY = std::floor(((float)std::max(y, 0) / levelHeight) * patches);
+    const int endPatchX = std::floor(((float)(std::min(x + width, levelWidth) - 1) / levelWidth) * patches);
+    const int endPatchY = std::floor(((float)(std::min(y + height, levelHeight) - 1) / levelHeight) * patches);
+
+    std::lock_guard<std::mutex> lock(m_dirtyPatchMutex);
+    for(int patchIdY = startPatchY; patchIdY <= endPatchY; ++patchIdY) {
+        for(int patchIdX = startPatchX; patchIdX <= endPatchX; ++patchIdX) {
+            m_dirtyPatches.insert(std::to_string(level) + "_" + std::to_string(patchIdX) + "_" + std::to_string(patchIdY));
+        }
+    }
+}
+
+void ImagePyramid::downsampleRegion(Region region) {
+    while(m_tiles->downsample(region.level, region.x, region.y, region.width, region.height)) {
+        region.level += 1;
+        setDirtyRegion(region.level, region.x, region.y, region.width, region.height);
+    }
+}
+
+void ImagePyramid::updateLowerLevels(int level, int x, int y, int width, int height) {
+    if(!m_tiles)
+        throw Exception("Lower levels can only be updated on image pyramids created with create(width, height, channels)");
+    Region region = {level, x, y, width, height};
+    if(!m_backgroundDownsampling) {
+        downsampleRegion(region);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_downsampleMutex);
+        m_downsampleQueue.push_back(region);
+        if(!m_downsampleThread)
+            m_downsampleThread = std::make_unique<std::thread>(std::bind(&ImagePyramid::downsampleInBackground, this));
+    }
+    m_downsampleCondition.notify_all();
+}
+
+void ImagePyramid::downsampleInBackground() {
+    while(true) {
+        Region region;
+        {
+            std::unique_lock<std::mutex> lock(m_downsampleMutex);
+            m_downsampleCondition.wait(lock, [this]() { return m_stopDownsampling || !m_downsampleQueue.empty(); });
+            if(m_stopDownsampling)
+                return;
+            region = m_downsampleQueue.front();
+            m_downsampleQueue.pop_front();
+            m_downsamplingInProgress = true;
+        }
+        downsampleRegion(region);
+        {
+            std::lock_guard<std::mutex> lock(m_downsampleMutex);
+            m_downsamplingInProgress = false;
+        }
+        m_downsampleCondition.notify_all();
+    }
+}
+
+void ImagePyramid::setBackgroundDownsampling(bool background) {
+    if(!background)
+        waitForBackgroundDownsampling();
+    m_backgroundDownsampling = background;
+}
+
+void ImagePyramid::waitForBackgroundDownsampling() {
+    std::unique_lock<std::mutex> lock(m_downsampleMutex);
+    m_downsampleCondition.wait(lock, [this]() {
+        return !m_downsampleThread || (m_downsampleQueue.empty() && !m_downsamplingInProgress);
+    });
+}
+
+void ImagePyramid::setTileSize(int size) {
+    if(m_initialized)
+        throw Exception("Tile size of ImagePyramid must be set before create");
+    if(size <= 0)
+        throw Exception("Tile size must be larger than 0");
+    m_tileSize = size;
+}
+
+void ImagePyramid::setMemoryLimit(std::size_t bytes) {
+    if(m_initialized)
+        throw Exception("Memory limit of ImagePyramid must be set before create");
+    m_memoryLimit = bytes;
+}
+
+std::size_t ImagePyramid::getMemoryUsage() {
+    if(!m_tiles)
+        return 0;
+    return m_tiles->getMemoryUsage();
+}
+
+void ImagePyramid::setTileCacheSize(std::size_t bytes) {
+    if(m_initialized)
+        throw Exception("Tile cache size of ImagePyramid must be set before create");
+    m_tileCacheSize = bytes;
+}
+
+void ImagePyramid::setNrOfTileReaderThreads(int threads) {
+    if(m_initialized)
+        throw Exception("Nr of tile reader threads of ImagePyramid must be set before create");
+    m_tileReaderThreads = threads;
+}
+
+ImagePyramidTileCache::pointer ImagePyramid::getTileCache() const {
+    return m_tileCache;
+}
+
 void ImagePyramid::setSpacing(Vector3f spacing) {
 	m_spacing = spacing;
 }
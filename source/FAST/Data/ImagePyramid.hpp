@@ -3,7 +3,12 @@
 #include <FAST/Data/SpatialDataObject.hpp>
 #include <FAST/Data/Access/Access.hpp>
 #include <FAST/Data/Access/ImagePyramidAccess.hpp>
+#include <FAST/Data/ImagePyramidTileStorage.hpp>
+#include <FAST/Data/ImagePyramidTileCache.hpp>
 #include <set>
+#include <deque>
+#include <thread>
+#include <condition_variable>
 
 // Forward declare
 
@@ -13,14 +18,21 @@ class Image;
 
 /**
  * Data object for storing large images as tiled image pyramids.
- * Storage uses virtual memory enabling the images to be larger than
+ * Pyramids created from scratch are stored as sparse tiles which are allocated on first write,
+ * optionally spilling the least recently used tiles to disk, enabling the images to be larger than
  * the available RAM.
  */
 class FAST_EXPORT ImagePyramid : public SpatialDataObject {
     FAST_OBJECT(ImagePyramid)
     public:
         void create(int width, int height, int channels, int levels = -1);
-        void create(openslide_t* fileHandle, std::vector<ImagePyramidLevel> levels);
+        /**
+         * Create image pyramid read from file with OpenSlide.
+         * @param fileHandle
+         * @param levels
+         * @param filename Used to open one OpenSlide handle per tile reader thread. If empty, all reader threads share fileHandle.
+         */
+        void create(openslide_t* fileHandle, std::vector<ImagePyramidLevel> levels, std::string filename = "");
         int getNrOfLevels();
         int getLevelWidth(int level);
         int getLevelHeight(int level);
@@ -28,6 +40,35 @@ class FAST_EXPORT ImagePyramid : public SpatialDataObject {
         int getFullWidth();
         int getFullHeight();
         int getNrOfChannels() const;
+        /**
+         * Set size of the tiles used to store a pyramid created with create(width, height, channels).
+         * Must be called before create. Default is 256.
+         */
+        void setTileSize(int size);
+        /**
+         * Limit the nr of bytes of tiles kept in memory. Least recently used tiles exceeding this limit
+         * are moved to a file on disk. Must be called before create. Default is 0, which means no limit.
+         */
+        void setMemoryLimit(std::size_t bytes);
+        /**
+         * @return nr of bytes currently used by tiles in memory
+         */
+        std::size_t getMemoryUsage();
+        /**
+         * Set max nr of bytes of decoded tiles to cache for pyramids read from file.
+         * The cache is shared by all accesses, thus viewing and processing the same slide doesn't decode tiles twice.
+         * Must be called before create. Default is 256 MB, 0 disables the cache.
+         */
+        void setTileCacheSize(std::size_t bytes);
+        /**
+         * Set nr of threads decoding tiles for the tile cache. Must be called before create.
+         * Default is 0, which means one per hardware thread, up to 8.
+         */
+        void setNrOfTileReaderThreads(int threads);
+        /**
+         * @return tile cache of pyramid read from file, nullptr if the cache is disabled
+         */
+        ImagePyramidTileCache::pointer getTileCache() const;
         void setSpacing(Vector3f spacing);
         Vector3f getSpacing() const;
         ImagePyramidAccess::pointer getAccess(accessType type);
@@ -35,6 +76,24 @@ class FAST_EXPORT ImagePyramid : public SpatialDataObject {
         bool isDirtyPatch(const std::string& tileID);
         void setDirtyPatch(int level, int patchIdX, int patchIdY);
         void clearDirtyPatches(std::set<std::string> patches);
+        /**
+         * Mark all patches overlapping the given region of a level as dirty
+         */
+        void setDirtyRegion(int level, int x, int y, int width, int height);
+        /**
+         * Recompute all lower resolution levels covered by a region of the given level, which has been changed.
+         * If background downsampling is enabled, this is done on a separate thread and this method returns immediately.
+         */
+        void updateLowerLevels(int level, int x, int y, int width, int height);
+        /**
+         * Enable downsampling of changed regions to lower resolution levels on a background thread.
+         * Default is false.
+         */
+        void setBackgroundDownsampling(bool background);
+        /**
+         * Block until all lower resolution levels have been updated by the background thread.
+         */
+        void waitForBackgroundDownsampling();
         void free(ExecutionDevice::pointer device) override;
         void freeAll() override;
         ~ImagePyramid();
@@ -43,6 +102,26 @@ class FAST_EXPORT ImagePyramid : public SpatialDataObject {
         std::vector<ImagePyramidLevel> m_levels;
 
         openslide_t* m_fileHandle = nullptr;
+        std::shared_ptr<ImagePyramidTileStorage> m_tiles;
+        int m_tileSize = 256;
+        std::size_t m_memoryLimit = 0;
+        ImagePyramidTileCache::pointer m_tileCache;
+        std::size_t m_tileCacheSize = 256*1024*1024;
+        int m_tileReaderThreads = 0;
+
+        struct Region {
+            int level;
+            int x, y, width, height;
+        };
+        void downsampleRegion(Region region);
+        void downsampleInBackground();
+        bool m_backgroundDownsampling = false;
+        bool m_stopDownsampling = false;
+        bool m_downsamplingInProgress = false;
+        std::deque<Region> m_downsampleQueue;
+        std::unique_ptr<std::thread> m_downsampleThread;
+        std::mutex m_downsampleMutex;
+        std::condition_variable m_downsampleCondition;
 
         int m_channels;
         bool m_initialized;
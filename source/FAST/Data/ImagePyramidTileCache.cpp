@@ -0,0 +1,224 @@
+#include "ImagePyramidTileCache.hpp"
+#include <openslide/openslide.h>
+#include <cstring>
+
+namespace fast {
+
+ImagePyramidTileCache::ImagePyramidTileCache(std::string filename, openslide_t* fileHandle, std::vector<ImagePyramidLevel> levels, std::size_t memoryLimit, int threads) {
+    if(levels.empty())
+        throw Exception("Image pyramid has no levels");
+    if(levels.size() > 255)
+        throw Exception("Too many levels in image pyramid for the tile cache");
+    m_levels = levels;
+    m_fullWidth = levels[0].width;
+    m_memoryLimit = memoryLimit;
+    if(threads <= 0)
+        threads = std::min<int>(std::max<int>(std::thread::hardware_concurrency(), 1), 8);
+
+    // Open all handles before starting the threads, so that errors are reported here
+    std::vector<openslide_t*> handles;
+    for(int i = 0; i < threads; ++i) {
+        if(filename.empty()) {
+            // OpenSlide handles are thread safe
+            handles.push_back(fileHandle);
+            continue;
+        }
+        openslide_t* handle = openslide_open(filename.c_str());
+        if(handle == nullptr || openslide_get_error(handle) != nullptr) {
+            if(handle != nullptr)
+                openslide_close(handle);
+            for(auto openHandle : handles)
+                openslide_close(openHandle);
+            throw Exception("Unable to open " + filename + " with OpenSlide for the tile cache");
+        }
+        handles.push_back(handle);
+    }
+    const bool ownsHandles = !filename.empty();
+    for(auto handle : handles) {
+        m_readers.emplace_back([this, handle, ownsHandles]() {
+            readTiles(handle);
+            if(ownsHandles)
+                openslide_close(handle);
+        });
+    }
+}
+
+uint64_t ImagePyramidTileCache::getTileKey(int level, int tileX, int tileY) const {
+    return ((uint64_t)level << 56) | ((uint64_t)tileY << 28) | (uint64_t)tileX;
+}
+
+std::shared_future<ImagePyramidTileCache::TileData> ImagePyramidTileCache::requestTile(int level, int tileX, int tileY) {
+    const uint64_t key = getTileKey(level, tileX, tileY);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto cached = m_cache.find(key);
+    if(cached != m_cache.end()) {
+        ++m_hits;
+        // Mark as most recently used
+        m_lru.splice(m_lru.begin(), m_lru, cached->second.lruPosition);
+        std::promise<TileData> promise;
+        promise.set_value(cached->second.data);
+        return promise.get_future().share();
+    }
+    // Tile is already being decoded for another request
+    auto pending = m_pending.find(key);
+    if(pending != m_pending.end()) {
+        ++m_hits;
+        return pending->second;
+    }
+
+    ++m_misses;
+    std::promise<TileData> promise;
+    auto future = promise.get_future().share();
+    m_pending[key] = future;
+    m_queue.emplace_back(key, std::move(promise));
+    m_queueCondition.notify_one();
+    return future;
+}
+
+void ImagePyramidTileCache::getTileRegion(uint64_t key, int& level, int& offsetX, int& offsetY, int& width, int& height) const {
+    level = key >> 56;
+    const ImagePyramidLevel& levelData = m_levels[level];
+    offsetX = (key & 0xFFFFFFF) * levelData.tileWidth;
+    offsetY = ((key >> 28) & 0xFFFFFFF) * levelData.tileHeight;
+    // Tiles at the right and bottom border are cut at the border of the level
+    width = std::min(levelData.tileWidth, levelData.width - offsetX);
+    height = std::min(levelData.tileHeight, levelData.height - offsetY);
+}
+
+std::size_t ImagePyramidTileCache::getTileSize(uint64_t key) const {
+    int level, offsetX, offsetY, width, height;
+    getTileRegion(key, level, offsetX, offsetY, width, height);
+    return (std::size_t)width * height * 4;
+}
+
+ImagePyramidTileCache::TileData ImagePyramidTileCache::decodeTile(openslide_t* fileHandle, uint64_t key) {
+    int level, offsetX, offsetY, width, height;
+    getTileRegion(key, level, offsetX, offsetY, width, height);
+    const ImagePyramidLevel& levelData = m_levels[level];
+
+    std::shared_ptr<uint8_t> data(new uint8_t[(std::size_t)width * height * 4], std::default_delete<uint8_t[]>());
+    float scale = (float)m_fullWidth / levelData.width;
+    openslide_read_region(fileHandle, (uint32_t*)data.get(), offsetX * scale, offsetY * scale, level, width, height);
+    const char* error = openslide_get_error(fileHandle);
+    if(error != nullptr)
+        throw Exception("OpenSlide was unable to read tile: " + std::string(error));
+
+    return data;
+}
+
+void ImagePyramidTileCache::readTiles(openslide_t* fileHandle) {
+    while(true) {
+        std::pair<uint64_t, std::promise<TileData>> request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueCondition.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if(m_stop)
+                return;
+            request = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        const uint64_t key = request.first;
+        TileData data;
+        std::exception_ptr error;
+        try {
+            data = decodeTile(fileHandle, key);
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.erase(key);
+            if(data) {
+                m_lru.push_front(key);
+                m_cache[key] = {data, m_lru.begin()};
+                m_memoryUsage += getTileSize(key);
+                // Tiles which are evicted stay alive as long as a request is using them
+                while(m_memoryUsage > m_memoryLimit && m_lru.size() > 1) {
+                    const uint64_t evictKey = m_lru.back();
+                    m_memoryUsage -= getTileSize(evictKey);
+                    m_cache.erase(evictKey);
+                    m_lru.pop_back();
+                }
+            }
+        }
+        if(error) {
+            request.second.set_exception(error);
+        } else {
+            request.second.set_value(data);
+        }
+    }
+}
+
+void ImagePyramidTileCache::getRegion(int level, int x, int y, int width, int height, uint8_t* data) {
+    const ImagePyramidLevel& levelData = m_levels.at(level);
+    const int startX = std::max(x, 0);
+    const int startY = std::max(y, 0);
+    const int endX = std::min(x + width, levelData.width);
+    const int endY = std::min(y + height, levelData.height);
+    if(startX != x || startY != y || endX != x + width || endY != y + height)
+        std::memset(data, 0, (std::size_t)width * height * 4);
+    if(startX >= endX || startY >= endY)
+        return;
+
+    // Request all tiles first, so that the missing tiles are decoded in parallel
+    struct TileRequest {
+        int tileX, tileY;
+        std::shared_future<TileData> tile;
+    };
+    std::vector<TileRequest> requests;
+    for(int tileY = startY / levelData.tileHeight; tileY * levelData.tileHeight < endY; ++tileY) {
+        for(int tileX = startX / levelData.tileWidth; tileX * levelData.tileWidth < endX; ++tileX)
+            requests.push_back({tileX, tileY, requestTile(level, tileX, tileY)});
+    }
+
+    for(auto& request : requests) {
+        TileData tile = request.tile.get();
+        const int tileOffsetX = request.tileX * levelData.tileWidth;
+        const int tileOffsetY = request.tileY * levelData.tileHeight;
+        const int tileWidth = std::min(levelData.tileWidth, levelData.width - tileOffsetX);
+        // Part of the region covered by this tile
+        const int fromX = std::max(startX, tileOffsetX);
+        const int toX = std::min(endX, tileOffsetX + levelData.tileWidth);
+        const int fromY = std::max(startY, tileOffsetY);
+        const int toY = std::min(endY, tileOffsetY + levelData.tileHeight);
+        const std::size_t rowBytes = (std::size_t)(toX - fromX) * 4;
+        for(int cy = fromY; cy < toY; ++cy) {
+            std::memcpy(
+                    &data[((fromX - x) + (std::size_t)(cy - y) * width) * 4],
+                    &tile.get()[((fromX - tileOffsetX) + (std::size_t)(cy - tileOffsetY) * tileWidth) * 4],
+                    rowBytes
+            );
+        }
+    }
+}
+
+std::size_t ImagePyramidTileCache::getMemoryUsage() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryUsage;
+}
+
+uint64_t ImagePyramidTileCache::getNrOfHits() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+uint64_t ImagePyramidTileCache::getNrOfMisses() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+ImagePyramidTileCache::~ImagePyramidTileCache() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        // Requests which have not been started are abandoned, this only happens if a region request is still running
+        m_queue.clear();
+    }
+    m_queueCondition.notify_all();
+    for(auto& reader : m_readers)
+        reader.join();
+}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <FAST/Object.hpp>
+#include <FAST/Data/Access/ImagePyramidAccess.hpp>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <unordered_map>
+#include <condition_variable>
+
+namespace fast {
+
+/**
+ * Size bounded cache of decoded tiles of an image pyramid read with OpenSlide.
+ *
+ * Regions are assembled from the native tiles of each level. Tiles which are not in the cache are
+ * decoded by a pool of reader threads, each with its own OpenSlide handle, and tiles requested by several
+ * threads at the same time are only decoded once. Thus PatchGenerator and ImagePyramidRenderer can
+ * read from the same slide concurrently without decoding the same tiles twice.
+ * The least recently used tiles are removed when the cache exceeds its memory limit.
+ */
+class FAST_EXPORT ImagePyramidTileCache : public Object {
+    public:
+        typedef std::shared_ptr<ImagePyramidTileCache> pointer;
+        /**
+         * @param filename Slide each reader thread opens its own OpenSlide handle to. If empty, all threads share fileHandle.
+         * @param fileHandle OpenSlide handle used if filename is empty
+         * @param levels
+         * @param memoryLimit Maximum nr of bytes of decoded tiles to keep
+         * @param threads Nr of reader threads. 0 means one per hardware thread, up to 8.
+         */
+        ImagePyramidTileCache(std::string filename, openslide_t* fileHandle, std::vector<ImagePyramidLevel> levels, std::size_t memoryLimit, int threads = 0);
+        /**
+         * Copy a region of a level, as BGRA, to data which must have room for width*height*4 bytes.
+         * Pixels outside the level are set to zero.
+         */
+        void getRegion(int level, int x, int y, int width, int height, uint8_t* data);
+        /**
+         * @return nr of bytes of decoded tiles in the cache
+         */
+        std::size_t getMemoryUsage();
+        /**
+         * @return nr of tiles found in the cache
+         */
+        uint64_t getNrOfHits();
+        /**
+         * @return nr of tiles which had to be decoded
+         */
+        uint64_t getNrOfMisses();
+        ~ImagePyramidTileCache();
+    private:
+        typedef std::shared_ptr<const uint8_t> TileData;
+        struct CachedTile {
+            TileData data;
+            std::list<uint64_t>::iterator lruPosition;
+        };
+
+        uint64_t getTileKey(int level, int tileX, int tileY) const;
+        void getTileRegion(uint64_t key, int& level, int& offsetX, int& offsetY, int& width, int& height) const;
+        std::size_t getTileSize(uint64_t key) const;
+        std::shared_future<TileData> requestTile(int level, int tileX, int tileY);
+        TileData decodeTile(openslide_t* fileHandle, uint64_t key);
+        void readTiles(openslide_t* fileHandle);
+
+        std::vector<ImagePyramidLevel> m_levels;
+        int m_fullWidth;
+        std::size_t m_memoryLimit;
+        std::size_t m_memoryUsage = 0;
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+
+        // Decoded tiles, and tiles being decoded
+        std::unordered_map<uint64_t, CachedTile> m_cache;
+        std::unordered_map<uint64_t, std::shared_future<TileData>> m_pending;
+        // Keys of tiles in the cache, most recently used first
+        std::list<uint64_t> m_lru;
+        std::mutex m_mutex;
+
+        std::deque<std::pair<uint64_t, std::promise<TileData>>> m_queue;
+        std::condition_variable m_queueCondition;
+        bool m_stop = false;
+        std::vector<std::thread> m_readers;
+};
+
+}
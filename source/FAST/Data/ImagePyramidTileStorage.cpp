@@ -0,0 +1,264 @@
+#include "ImagePyramidTileStorage.hpp"
+#include <cstring>
+
+namespace fast {
+
+static int seekFile(std::FILE* file, std::size_t offset) {
+#ifdef WIN32
+    return _fseeki64(file, (__int64)offset, SEEK_SET);
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+}
+
+ImagePyramidTileStorage::ImagePyramidTileStorage(int channels, int tileSize) {
+    if(channels <= 0 || channels > 4)
+        throw Exception("Nr of channels must be between 1 and 4");
+    if(tileSize <= 0)
+        throw Exception("Tile size must be larger than 0");
+    m_channels = channels;
+    m_tileSize = tileSize;
+    m_tileBytes = (std::size_t)tileSize * tileSize * channels;
+}
+
+void ImagePyramidTileStorage::addLevel(int width, int height) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Level level;
+    level.width = width;
+    level.height = height;
+    level.tilesX = (width + m_tileSize - 1) / m_tileSize;
+    level.tilesY = (height + m_tileSize - 1) / m_tileSize;
+    level.firstTile = m_tiles.size();
+    m_levels.push_back(level);
+    m_tiles.resize(m_tiles.size() + (std::size_t)level.tilesX * level.tilesY);
+}
+
+void ImagePyramidTileStorage::setMemoryLimit(std::size_t bytes, std::string spillFilename) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(bytes > 0 && bytes < m_tileBytes)
+        throw Exception("Memory limit of image pyramid tile storage must be at least one tile");
+    if(bytes > 0 && m_spillFile == nullptr) {
+        m_spillFile = std::fopen(spillFilename.c_str(), "w+b");
+        if(m_spillFile == nullptr)
+            throw Exception("Unable to create spill file " + spillFilename + " for image pyramid");
+        m_spillFilename = spillFilename;
+    }
+    m_memoryLimit = bytes;
+    evictTiles();
+}
+
+std::size_t ImagePyramidTileStorage::getTileIndex(int level, int tileX, int tileY) const {
+    const Level& levelData = m_levels[level];
+    return levelData.firstTile + tileX + (std::size_t)tileY * levelData.tilesX;
+}
+
+uint8_t* ImagePyramidTileStorage::getTile(std::size_t index, bool write) {
+    Tile& tile = m_tiles[index];
+    if(!tile.allocated && !write)
+        return nullptr;
+
+    if(tile.data) {
+        // Mark as most recently used
+        m_lru.splice(m_lru.begin(), m_lru, tile.lruPosition);
+    } else {
+        tile.data = std::make_unique<uint8_t[]>(m_tileBytes); // Zero initialized
+        if(tile.spilled) {
+            if(seekFile(m_spillFile, index * m_tileBytes) != 0 || std::fread(tile.data.get(), 1, m_tileBytes, m_spillFile) != m_tileBytes)
+                throw Exception("Failed to read tile from image pyramid spill file");
+        } else {
+            ++m_allocatedTiles;
+        }
+        tile.allocated = true;
+        m_lru.push_front(index);
+        tile.lruPosition = m_lru.begin();
+        m_memoryUsage += m_tileBytes;
+        evictTiles();
+    }
+    if(write)
+        tile.modified = true;
+
+    return tile.data.get();
+}
+
+void ImagePyramidTileStorage::evictTiles() {
+    if(m_memoryLimit == 0)
+        return;
+    // Never evict the most recently used tile, as it is the one currently in use
+    while(m_memoryUsage > m_memoryLimit && m_lru.size() > 1) {
+        const std::size_t index = m_lru.back();
+        m_lru.pop_back();
+        Tile& tile = m_tiles[index];
+        if(!tile.spilled || tile.modified) {
+            if(seekFile(m_spillFile, index * m_tileBytes) != 0 || std::fwrite(tile.data.get(), 1, m_tileBytes, m_spillFile) != m_tileBytes)
+                throw Exception("Failed to write tile to image pyramid spill file");
+        }
+        tile.spilled = true;
+        tile.modified = false;
+        tile.data.reset();
+        m_memoryUsage -= m_tileBytes;
+    }
+}
+
+uint8_t ImagePyramidTileStorage::getScalar(int x, int y, int level, int channel) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint8_t* tile = getTile(getTileIndex(level, x / m_tileSize, y / m_tileSize), false);
+    if(tile == nullptr)
+        return 0;
+    return tile[((x % m_tileSize) + (std::size_t)(y % m_tileSize) * m_tileSize) * m_channels + channel];
+}
+
+void ImagePyramidTileStorage::setScalar(int x, int y, int level, int channel, uint8_t value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint8_t* tile = getTile(getTileIndex(level, x / m_tileSize, y / m_tileSize), true);
+    tile[((x % m_tileSize) + (std::size_t)(y % m_tileSize) * m_tileSize) * m_channels + channel] = value;
+}
+
+void ImagePyramidTileStorage::getRegion(int level, int x, int y, int width, int height, uint8_t* data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    readRegion(level, x, y, width, height, data);
+}
+
+void ImagePyramidTileStorage::setRegion(int level, int x, int y, int width, int height, const uint8_t* data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    writeRegion(level, x, y, width, height, data);
+}
+
+bool ImagePyramidTileStorage::downsample(int level, int& x, int& y, int& width, int& height) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(level + 1 >= m_levels.size())
+        return false;
+    const Level& source = m_levels[level];
+    const Level& target = m_levels[level + 1];
+
+    // Region of the next level covered by the given region
+    const int targetStartX = std::max(x, 0) / 2;
+    const int targetStartY = std::max(y, 0) / 2;
+    const int targetEndX = std::min((std::min(x + width, source.width) + 1) / 2, target.width);
+    const int targetEndY = std::min((std::min(y + height, source.height) + 1) / 2, target.height);
+    const int targetWidth = targetEndX - targetStartX;
+    const int targetHeight = targetEndY - targetStartY;
+    if(targetWidth <= 0 || targetHeight <= 0)
+        return false;
+
+    // Source pixels needed, clamped to the level
+    const int sourceX = targetStartX * 2;
+    const int sourceY = targetStartY * 2;
+    const int sourceWidth = std::min(targetEndX * 2, source.width) - sourceX;
+    const int sourceHeight = std::min(targetEndY * 2, source.height) - sourceY;
+    auto sourceData = std::make_unique<uint8_t[]>((std::size_t)sourceWidth * sourceHeight * m_channels);
+    readRegion(level, sourceX, sourceY, sourceWidth, sourceHeight, sourceData.get());
+
+    // 2x2 box filter. At the right and bottom border the last column/row is repeated,
+    // which gives the average of the available pixels.
+    auto targetData = std::make_unique<uint8_t[]>((std::size_t)targetWidth * targetHeight * m_channels);
+    const int channels = m_channels;
+    for(int ty = 0; ty < targetHeight; ++ty) {
+        const uint8_t* row0 = &sourceData[(std::size_t)(ty * 2) * sourceWidth * channels];
+        const uint8_t* row1 = ty * 2 + 1 < sourceHeight ? row0 + (std::size_t)sourceWidth * channels : row0;
+        uint8_t* out = &targetData[(std::size_t)ty * targetWidth * channels];
+        const int fullPairs = std::min(targetWidth, sourceWidth / 2);
+        for(int tx = 0; tx < fullPairs; ++tx) {
+            const uint8_t* top = row0 + tx * 2 * channels;
+            const uint8_t* bottom = row1 + tx * 2 * channels;
+            for(int channel = 0; channel < channels; ++channel)
+                out[tx * channels + channel] = (uint8_t)((top[channel] + top[channel + channels] + bottom[channel] + bottom[channel + channels] + 2) >> 2);
+        }
+        for(int tx = fullPairs; tx < targetWidth; ++tx) {
+            for(int channel = 0; channel < channels; ++channel) {
+                const int column = tx * 2 * channels + channel;
+                out[tx * channels + channel] = (uint8_t)((row0[column] * 2 + row1[column] * 2 + 2) >> 2);
+            }
+        }
+    }
+    writeRegion(level + 1, targetStartX, targetStartY, targetWidth, targetHeight, targetData.get());
+
+    x = targetStartX;
+    y = targetStartY;
+    width = targetWidth;
+    height = targetHeight;
+    return true;
+}
+
+void ImagePyramidTileStorage::writeRegion(int level, int x, int y, int width, int height, const uint8_t* data) {
+    const Level& levelData = m_levels.at(level);
+    const int startX = std::max(x, 0);
+    const int startY = std::max(y, 0);
+    const int endX = std::min(x + width, levelData.width);
+    const int endY = std::min(y + height, levelData.height);
+
+    for(int tileY = startY / m_tileSize; tileY * m_tileSize < endY; ++tileY) {
+        for(int tileX = startX / m_tileSize; tileX * m_tileSize < endX; ++tileX) {
+            uint8_t* tile = getTile(getTileIndex(level, tileX, tileY), true);
+            // Part of the region covered by this tile
+            const int fromX = std::max(startX, tileX * m_tileSize);
+            const int toX = std::min(endX, (tileX + 1) * m_tileSize);
+            const int fromY = std::max(startY, tileY * m_tileSize);
+            const int toY = std::min(endY, (tileY + 1) * m_tileSize);
+            const std::size_t rowBytes = (std::size_t)(toX - fromX) * m_channels;
+            for(int cy = fromY; cy < toY; ++cy) {
+                std::memcpy(
+                        &tile[((fromX - tileX * m_tileSize) + (std::size_t)(cy - tileY * m_tileSize) * m_tileSize) * m_channels],
+                        &data[((fromX - x) + (std::size_t)(cy - y) * width) * m_channels],
+                        rowBytes
+                );
+            }
+        }
+    }
+}
+
+void ImagePyramidTileStorage::readRegion(int level, int x, int y, int width, int height, uint8_t* data) {
+    const Level& levelData = m_levels.at(level);
+    const int startX = std::max(x, 0);
+    const int startY = std::max(y, 0);
+    const int endX = std::min(x + width, levelData.width);
+    const int endY = std::min(y + height, levelData.height);
+    if(startX != x || startY != y || endX != x + width || endY != y + height)
+        std::memset(data, 0, (std::size_t)width * height * m_channels);
+
+    for(int tileY = startY / m_tileSize; tileY * m_tileSize < endY; ++tileY) {
+        for(int tileX = startX / m_tileSize; tileX * m_tileSize < endX; ++tileX) {
+            const uint8_t* tile = getTile(getTileIndex(level, tileX, tileY), false);
+            // Part of the region covered by this tile
+            const int fromX = std::max(startX, tileX * m_tileSize);
+            const int toX = std::min(endX, (tileX + 1) * m_tileSize);
+            const int fromY = std::max(startY, tileY * m_tileSize);
+            const int toY = std::min(endY, (tileY + 1) * m_tileSize);
+            const std::size_t rowBytes = (std::size_t)(toX - fromX) * m_channels;
+            for(int cy = fromY; cy < toY; ++cy) {
+                uint8_t* destination = &data[((fromX - x) + (std::size_t)(cy - y) * width) * m_channels];
+                if(tile == nullptr) {
+                    std::memset(destination, 0, rowBytes);
+                } else {
+                    std::memcpy(destination, &tile[((fromX - tileX * m_tileSize) + (std::size_t)(cy - tileY * m_tileSize) * m_tileSize) * m_channels], rowBytes);
+                }
+            }
+        }
+    }
+}
+
+int ImagePyramidTileStorage::getTileSize() const {
+    return m_tileSize;
+}
+
+int ImagePyramidTileStorage::getNrOfChannels() const {
+    return m_channels;
+}
+
+int ImagePyramidTileStorage::getNrOfAllocatedTiles() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocatedTiles;
+}
+
+std::size_t ImagePyramidTileStorage::getMemoryUsage() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryUsage;
+}
+
+ImagePyramidTileStorage::~ImagePyramidTileStorage() {
+    if(m_spillFile != nullptr) {
+        std::fclose(m_spillFile);
+        std::remove(m_spillFilename.c_str());
+    }
+}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <FAST/Object.hpp>
+#include <FAST/Data/DataTypes.hpp>
+#include <list>
+#include <mutex>
+#include <cstdio>
+
+namespace fast {
+
+/**
+ * Sparse storage for the levels of a writable ImagePyramid.
+ * Every level is divided into a grid of square tiles, and memory for a tile is not allocated until
+ * the tile is written to. Tiles which have never been written to read as zero.
+ *
+ * If a memory limit is set, the least recently used tiles are written to a spill file on disk
+ * when the tiles in memory exceed the limit, and read back again when they are needed.
+ */
+class FAST_EXPORT ImagePyramidTileStorage : public Object {
+    public:
+        typedef std::shared_ptr<ImagePyramidTileStorage> pointer;
+        ImagePyramidTileStorage(int channels, int tileSize = 256);
+        /**
+         * Add a level of given size. Levels must be added from highest to lowest resolution.
+         */
+        void addLevel(int width, int height);
+        /**
+         * Limit the memory used by tiles. Tiles exceeding this limit are moved to the given spill file.
+         * @param bytes Maximum nr of bytes to keep in memory. 0 means no limit.
+         * @param spillFilename File to store tiles in when the memory limit is exceeded
+         */
+        void setMemoryLimit(std::size_t bytes, std::string spillFilename);
+        uint8_t getScalar(int x, int y, int level, int channel);
+        void setScalar(int x, int y, int level, int channel, uint8_t value);
+        /**
+         * Copy a region of a level to data, which must have room for width*height*channels bytes.
+         * Pixels which are not written to, or are outside the level, are set to zero.
+         */
+        void getRegion(int level, int x, int y, int width, int height, uint8_t* data);
+        /**
+         * Copy data of size width*height*channels into a region of a level.
+         * Pixels outside the level are ignored.
+         */
+        void setRegion(int level, int x, int y, int width, int height, const uint8_t* data);
+        /**
+         * Recompute the part of level+1 which is covered by the given region of level, using a 2x2 box filter.
+         * On return x, y, width and height is the updated region of level+1.
+         * @return false if level is the last level, or the region is empty
+         */
+        bool downsample(int level, int& x, int& y, int& width, int& height);
+        int getTileSize() const;
+        int getNrOfChannels() const;
+        /**
+         * @return nr of tiles which have been written to
+         */
+        int getNrOfAllocatedTiles();
+        /**
+         * @return nr of bytes currently used by tiles in memory
+         */
+        std::size_t getMemoryUsage();
+        ~ImagePyramidTileStorage();
+    protected:
+        struct Tile {
+            std::unique_ptr<uint8_t[]> data;
+            bool allocated = false;
+            bool spilled = false;
+            bool modified = false;
+            std::list<std::size_t>::iterator lruPosition;
+        };
+        struct Level {
+            int width;
+            int height;
+            int tilesX;
+            int tilesY;
+            std::size_t firstTile;
+        };
+        std::vector<Level> m_levels;
+        std::vector<Tile> m_tiles;
+        // Indices of tiles in memory, most recently used first
+        std::list<std::size_t> m_lru;
+        std::mutex m_mutex;
+
+        int m_channels;
+        int m_tileSize;
+        std::size_t m_tileBytes;
+        std::size_t m_memoryUsage = 0;
+        std::size_t m_memoryLimit = 0;
+        int m_allocatedTiles = 0;
+        std::string m_spillFilename;
+        std::FILE* m_spillFile = nullptr;
+
+        std::size_t getTileIndex(int level, int tileX, int tileY) const;
+        uint8_t* getTile(std::size_t index, bool write);
+        void readRegion(int level, int x, int y, int width, int height, uint8_t* data);
+        void writeRegion(int level, int x, int y, int width, int height, const uint8_t* data);
+        void evictTiles();
+};
+
+}
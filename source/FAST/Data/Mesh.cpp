@@ -109,14 +109,9 @@ VertexBufferObjectAccess::pointer Mesh::getVertexBufferObjectAccess(
     if(!mIsInitialized)
         throw Exception("Mesh has not been initialized.");
 
-    blockIfBeingWrittenTo();
-
-    if (type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-    	{
-            std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-            mDataIsBeingWrittenTo = true;
-    	}
+    beginAccess(type);
+
+    if(type == ACCESS_READ_WRITE) {
         updateModifiedTimestamp();
     }
     if(!mVBOHasData) {
@@ -204,10 +199,6 @@ VertexBufferObjectAccess::pointer Mesh::getVertexBufferObjectAccess(
         }
     }
 
-    {
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
-    }
 
 	VertexBufferObjectAccess::pointer accessObject(
             new VertexBufferObjectAccess(
@@ -257,14 +248,9 @@ MeshAccess::pointer Mesh::getMeshAccess(accessType type) {
         throw Exception("Mesh has not been initialized.");
     }
 
-    blockIfBeingWrittenTo();
+    beginAccess(type);
 
     if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-    	{
-    		std::lock_guard<std::mutex> lock(mDataIsBeingWrittenToMutex);
-            mDataIsBeingWrittenTo = true;
-    	}
         updateModifiedTimestamp();
     }
     if(!mHostHasData) {
@@ -340,10 +326,6 @@ MeshAccess::pointer Mesh::getMeshAccess(accessType type) {
         }
     }
 
-    {
-        std::lock_guard<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
-    }
 
     MeshAccess::pointer accessObject(new MeshAccess(&mCoordinates, &mNormals, &mColors, &mLines, &mTriangles, std::static_pointer_cast<Mesh>(mPtr.lock())));
 	return std::move(accessObject);
@@ -425,23 +407,13 @@ MeshOpenCLAccess::pointer Mesh::getOpenCLAccess(accessType type, OpenCLDevice::p
         throw Exception("Surface has not been initialized.");
     }
 
-    blockIfBeingWrittenTo();
-
-    if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-        std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-        mDataIsBeingWrittenTo = true;
-    }
+    beginAccess(type);
     updateOpenCLBufferData(device);
     if(type == ACCESS_READ_WRITE) {
         setAllDataToOutOfDate();
         updateModifiedTimestamp();
     }
     mCLBuffersIsUpToDate[device] = true;
-    {
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
-    }
 
     MeshOpenCLAccess::pointer accessObject(new MeshOpenCLAccess(mCoordinatesBuffers[device], mLinesBuffers[device], mTrianglesBuffers[device], std::static_pointer_cast<Mesh>(mPtr.lock())));
 	return std::move(accessObject);
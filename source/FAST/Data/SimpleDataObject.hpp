@@ -37,6 +37,7 @@ public:
 protected:
     DataType* mData;
     std::shared_ptr<SimpleDataObject<DataType> > mDataObject;
+    bool m_released = false;
 };
 
 
@@ -58,7 +59,10 @@ void DataAccess<DataType>::setData(const DataType &data) {
 
 template <class DataType>
 void DataAccess<DataType>::release() {
-    mDataObject->accessFinished();
+    if(!m_released) {
+        m_released = true;
+        mDataObject->accessFinished();
+    }
 }
 
 template <class DataType>
@@ -107,22 +111,13 @@ void SimpleDataObject<DataType, AccessObject>::create(DataType data) {
 template <class DataType, class AccessObject>
 typename AccessObject::pointer SimpleDataObject<DataType, AccessObject>::getAccess(accessType type) {
 
-    blockIfBeingWrittenTo();
+    beginAccess(type);
 
     if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-    	{
-    		std::lock_guard<std::mutex> lock(mDataIsBeingWrittenToMutex);
-            mDataIsBeingWrittenTo = true;
-    	}
         updateModifiedTimestamp();
     }
 
 
-    {
-        std::lock_guard<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
-    }
 
     typename AccessObject::pointer accessObject(new AccessObject(&mData, std::static_pointer_cast<SimpleDataObject<DataType>>(mPtr.lock())));
     return std::move(accessObject);
@@ -8,6 +8,8 @@ void Tensor::create(std::unique_ptr<float[]> data, TensorShape shape) {
     if(shape.empty())
         throw Exception("Shape can't be empty");
     m_data = std::move(data);
+    m_viewParent.reset();
+    m_viewOffset = 0;
     m_shape = shape;
     m_spacing = VectorXf::Ones(shape.getDimensions());
     mHostDataIsUpToDate = true;
@@ -24,6 +26,8 @@ void Tensor::create(TensorShape shape) {
     if(shape.getUnknownDimensions() > 0)
         throw Exception("When creating a tensor, shape must be fully defined");
     m_data = make_uninitialized_unique<float[]>(shape.getTotalSize());
+    m_viewParent.reset();
+    m_viewOffset = 0;
     m_spacing = VectorXf::Ones(shape.getDimensions());
     mHostDataIsUpToDate = true;
     m_shape = shape;
@@ -39,6 +43,8 @@ void Tensor::create(std::initializer_list<float> data) {
 		throw Exception("Shape can't be empty");
 
 	m_data = std::make_unique<float[]>(data.size());
+    m_viewParent.reset();
+    m_viewOffset = 0;
 	int i = 0;
 	for(auto item : data) {
 		m_data[i] = item;
@@ -54,6 +60,30 @@ void Tensor::create(std::initializer_list<float> data) {
     }
 }
 
+void Tensor::createView(std::shared_ptr<Tensor> parent, std::size_t offset, TensorShape shape) {
+    if(shape.empty())
+        throw Exception("Shape can't be empty");
+    if(shape.getUnknownDimensions() > 0)
+        throw Exception("When creating a tensor view, shape must be fully defined");
+    if(offset + shape.getTotalSize() > parent->getShape().getTotalSize())
+        throw Exception("Tensor view is outside of the parent tensor");
+    {
+        // Make sure the data of the parent is on the host
+        auto access = parent->getAccess(ACCESS_READ);
+    }
+    m_viewParent = parent;
+    m_viewOffset = offset;
+    m_data.reset();
+    m_spacing = VectorXf::Ones(shape.getDimensions());
+    mHostDataIsUpToDate = true;
+    m_shape = shape;
+    if(m_shape.getDimensions() >= 3) {
+        const int width = m_shape[m_shape.getDimensions() - 2];
+        const int height = m_shape[m_shape.getDimensions() - 3];
+        mBoundingBox = DataBoundingBox(Vector3f(width, height, 1));
+    }
+}
+
 void Tensor::expandDims(int position) {
 	if(position < 0) { // append to end
 		m_shape.addDimension(1);
@@ -71,22 +101,18 @@ TensorAccess::pointer Tensor::getAccess(accessType type) {
     if(!isInitialized())
         throw Exception("Tensor has not been initialized.");
 
-    blockIfBeingWrittenTo();
-
-    if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-        std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-        mDataIsBeingWrittenTo = true;
-    }
-    updateHostData();
-    if(type == ACCESS_READ_WRITE) {
-        setAllDataToOutOfDate();
-        updateModifiedTimestamp();
-    }
-    mHostDataIsUpToDate = true;
-    {
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
+    beginAccess(type);
+    try {
+        std::lock_guard<std::mutex> lock(mDataTransferMutex);
+        updateHostData();
+        if(type == ACCESS_READ_WRITE) {
+            setAllDataToOutOfDate();
+            updateModifiedTimestamp();
+        }
+        mHostDataIsUpToDate = true;
+    } catch(...) {
+        accessFinished();
+        throw;
     }
     return std::make_unique<TensorAccess>(getHostDataPointer(), m_shape, std::static_pointer_cast<Tensor>(mPtr.lock()));
 }
@@ -96,7 +122,8 @@ void Tensor::free(ExecutionDevice::pointer device) {
         m_data.reset();
     } else {
         auto clDevice = std::dynamic_pointer_cast<OpenCLDevice>(device);
-        delete mCLBuffers[clDevice];
+        if(mCLBuffers.count(clDevice) > 0)
+            clDevice->getMemoryPool()->release(mCLBuffers[clDevice]);
         mCLBuffers.erase(clDevice);
         mCLBuffersIsUpToDate.erase(clDevice);
     }
@@ -104,8 +131,9 @@ void Tensor::free(ExecutionDevice::pointer device) {
 
 void Tensor::freeAll() {
     m_data.reset();
+    m_viewParent.reset();
     for(auto buffer : mCLBuffers) {
-        delete buffer.second;
+        buffer.first->getMemoryPool()->release(buffer.second);
     }
     mCLBuffers.clear();
     mCLBuffersIsUpToDate.clear();
@@ -115,35 +143,37 @@ OpenCLBufferAccess::pointer Tensor::getOpenCLBufferAccess(accessType type, OpenC
     if(!isInitialized())
         throw Exception("Tensor has not been initialized.");
 
-    blockIfBeingWrittenTo();
-
-    if(type == ACCESS_READ_WRITE) {
-    	blockIfBeingAccessed();
-        std::unique_lock<std::mutex> lock(mDataIsBeingWrittenToMutex);
-        mDataIsBeingWrittenTo = true;
-    }
-    updateOpenCLBufferData(device);
-    if(type == ACCESS_READ_WRITE) {
-        setAllDataToOutOfDate();
-        updateModifiedTimestamp();
-    }
-    mCLBuffersIsUpToDate[device] = true;
-    {
-        std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
-        mDataIsBeingAccessed = true;
+    beginAccess(type);
+    cl::Buffer* buffer;
+    try {
+        std::lock_guard<std::mutex> lock(mDataTransferMutex);
+        updateOpenCLBufferData(device);
+        if(type == ACCESS_READ_WRITE) {
+            setAllDataToOutOfDate();
+            updateModifiedTimestamp();
+        }
+        mCLBuffersIsUpToDate[device] = true;
+        buffer = mCLBuffers[device];
+    } catch(...) {
+        accessFinished();
+        throw;
     }
 
     // Now it is guaranteed that the data is on the device and that it is up to date
-	auto accessObject = std::make_unique<OpenCLBufferAccess>(mCLBuffers[device],  std::dynamic_pointer_cast<DataObject>(mPtr.lock()));
+	auto accessObject = std::make_unique<OpenCLBufferAccess>(buffer, std::dynamic_pointer_cast<DataObject>(mPtr.lock()));
 	return std::move(accessObject);
 }
 
+bool Tensor::hasOpenCLBuffer(OpenCLDevice::pointer device) {
+    return mCLBuffersIsUpToDate.count(device) > 0 && mCLBuffersIsUpToDate[device];
+}
+
 bool Tensor::isInitialized() {
     return !m_shape.empty();
 }
 
 bool Tensor::hasAnyData() {
-    return m_data.get() != nullptr || mCLBuffers.size() > 0;
+    return m_data.get() != nullptr || m_viewParent || mCLBuffers.size() > 0;
 }
 
 void Tensor::updateOpenCLBufferData(OpenCLDevice::pointer device) {
@@ -156,8 +186,7 @@ void Tensor::updateOpenCLBufferData(OpenCLDevice::pointer device) {
     if(mCLBuffers.count(device) == 0) {
         // Data is not on device, create it
         unsigned int bufferSize = getShape().getTotalSize()*4;
-        cl::Buffer * newBuffer = new cl::Buffer(
-                device->getContext(),
+        cl::Buffer * newBuffer = device->getMemoryPool()->getBuffer(
                 CL_MEM_READ_WRITE,
                 bufferSize
         );
@@ -191,7 +220,7 @@ void Tensor::transferCLBufferFromHost(OpenCLDevice::pointer device) {
 }
 
 void Tensor::transferCLBufferToHost(OpenCLDevice::pointer device) {
-	if(!m_data) {
+	if(!m_data && !m_viewParent) {
 		// Must allocate memory for host data
         m_data = make_uninitialized_unique<float[]>(m_shape.getTotalSize());
 	}
@@ -215,7 +244,7 @@ void Tensor::updateHostData() {
         return;
 
     bool updated = false;
-    if(!m_data) {
+    if(!m_data && !m_viewParent) {
         // Data is not initialized, do that first
         m_data = make_uninitialized_unique<float[]>(m_shape.getTotalSize());
 
@@ -279,6 +308,8 @@ DataBoundingBox Tensor::getBoundingBox() const {
 }
 
 float* Tensor::getHostDataPointer() {
+    if(m_viewParent)
+        return m_viewParent->getHostDataPointer() + m_viewOffset;
     return m_data.get();
 }
 
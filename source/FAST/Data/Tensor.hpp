@@ -28,6 +28,15 @@ class FAST_EXPORT Tensor : public SpatialDataObject {
 		 * @param data
 		 */
 		virtual void create(std::initializer_list<float> data);
+        /**
+         * Create a tensor which is a view of a part of another tensor, without copying any data.
+         * The view keeps the parent tensor alive, and reads and writes the data of the parent directly.
+         * The parent tensor should not be modified while views of it are in use.
+         * @param parent Tensor to create view of
+         * @param offset Offset in number of elements from the start of the parent tensor
+         * @param shape Shape of the view
+         */
+        virtual void createView(std::shared_ptr<Tensor> parent, std::size_t offset, TensorShape shape);
 		/**
 		 * Add a dimension of size 1 at provided position. -1 is last position.
 		 * @param position
@@ -36,6 +45,11 @@ class FAST_EXPORT Tensor : public SpatialDataObject {
         virtual TensorShape getShape() const;
         virtual TensorAccess::pointer getAccess(accessType type);
         virtual std::unique_ptr<OpenCLBufferAccess> getOpenCLBufferAccess(accessType type, OpenCLDevice::pointer);
+        /**
+         * @param device
+         * @return true if the tensor has an up to date copy of its data in an OpenCL buffer on the given device
+         */
+        virtual bool hasOpenCLBuffer(OpenCLDevice::pointer device);
         virtual void freeAll() override;
         virtual void free(ExecutionDevice::pointer device) override;
         virtual void setSpacing(VectorXf spacing);
@@ -58,6 +72,9 @@ class FAST_EXPORT Tensor : public SpatialDataObject {
         virtual float* getHostDataPointer();
 
         std::unique_ptr<float[]> m_data;
+        // If this tensor is a view, the data is owned by the parent tensor
+        std::shared_ptr<Tensor> m_viewParent;
+        std::size_t m_viewOffset = 0;
         std::unordered_map<std::shared_ptr<OpenCLDevice>, cl::Buffer*> mCLBuffers;
         std::unordered_map<std::shared_ptr<OpenCLDevice>, bool> mCLBuffersIsUpToDate;
         TensorShape m_shape;
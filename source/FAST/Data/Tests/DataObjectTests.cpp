@@ -1,6 +1,8 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Tests/DummyObjects.hpp"
 #include "FAST/DeviceManager.hpp"
+#include "FAST/Data/Image.hpp"
+#include <thread>
 
 namespace fast {
 
@@ -12,6 +14,96 @@ TEST_CASE("Update timestamp on DataObject", "[fast][DataObject]") {
     CHECK(timestamp != data->getTimestamp());
 }
 
+TEST_CASE("DataObject allows several readers at the same time", "[fast][DataObject]") {
+    auto image = Image::New();
+    image->create(64, 64, TYPE_UINT8, 1);
+    image->fill(1);
+
+    auto access = image->getImageAccess(ACCESS_READ);
+    CHECK(image->getNrOfReaders() == 1);
+    // Another reader must not block while the first one is alive
+    std::atomic<int> readers(0);
+    std::thread reader([&]() {
+        auto access2 = image->getImageAccess(ACCESS_READ);
+        readers = image->getNrOfReaders();
+    });
+    reader.join();
+    CHECK(readers == 2);
+    CHECK(image->getNrOfReaders() == 1);
+
+    // Releasing the same access twice must only count once
+    auto access3 = image->getImageAccess(ACCESS_READ);
+    access3->release();
+    access3->release();
+    CHECK(image->getNrOfReaders() == 1);
+
+    // A writer must wait until all readers are finished
+    std::atomic<bool> written(false);
+    std::thread writer([&]() {
+        auto access = image->getImageAccess(ACCESS_READ_WRITE);
+        written = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK_FALSE(written);
+    access->release();
+    writer.join();
+    CHECK(written);
+    CHECK(image->getNrOfReaders() == 0);
+    CHECK_FALSE(image->isBeingWrittenTo());
+}
+
+TEST_CASE("DataObject stress test with many concurrent readers and writers", "[fast][DataObject]") {
+    auto image = Image::New();
+    image->create(64, 64, TYPE_UINT8, 1);
+    image->fill(0);
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+
+    const int nrOfReaders = 8;
+    const int iterations = 200;
+    std::atomic<int> errors(0);
+    std::atomic<int> writersActive(0);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < nrOfReaders; ++i) {
+        threads.emplace_back([&, i]() {
+            for(int j = 0; j < iterations; ++j) {
+                if((i + j) % 2 == 0) {
+                    auto access = image->getImageAccess(ACCESS_READ);
+                    if(writersActive > 0)
+                        ++errors;
+                    // The image is always filled with a single value by the writer
+                    auto data = (uchar*)access->get();
+                    if(data[0] != data[64*64-1])
+                        ++errors;
+                } else {
+                    auto access = image->getOpenCLImageAccess(ACCESS_READ, device);
+                    if(writersActive > 0)
+                        ++errors;
+                }
+            }
+        });
+    }
+    threads.emplace_back([&]() {
+        for(int j = 0; j < iterations / 10; ++j) {
+            auto access = image->getImageAccess(ACCESS_READ_WRITE);
+            ++writersActive;
+            if(image->getNrOfReaders() > 0)
+                ++errors;
+            auto data = (uchar*)access->get();
+            for(int k = 0; k < 64*64; ++k)
+                data[k] = j;
+            --writersActive;
+        }
+    });
+    for(auto& thread : threads)
+        thread.join();
+
+    CHECK(errors == 0);
+    CHECK(image->getNrOfReaders() == 0);
+    CHECK_FALSE(image->isBeingWrittenTo());
+    auto access = image->getImageAccess(ACCESS_READ);
+    CHECK(((uchar*)access->get())[0] == iterations / 10 - 1);
+}
+
 
 
 };
@@ -0,0 +1,166 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Data/ImagePyramid.hpp"
+#include "FAST/Data/ImagePyramidTileStorage.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Importers/WholeSlideImageImporter.hpp"
+#include <openslide/openslide.h>
+#include <thread>
+#include <cstring>
+
+using namespace fast;
+
+TEST_CASE("Image pyramid tile storage reads zero from untouched tiles", "[fast][ImagePyramid][ImagePyramidTileStorage]") {
+    ImagePyramidTileStorage storage(2, 64);
+    storage.addLevel(1000, 500);
+    storage.addLevel(500, 250);
+
+    CHECK(storage.getScalar(999, 499, 0, 1) == 0);
+    CHECK(storage.getNrOfAllocatedTiles() == 0);
+    CHECK(storage.getMemoryUsage() == 0);
+
+    storage.setScalar(130, 70, 0, 1, 42);
+    storage.setScalar(131, 70, 0, 1, 43);
+    storage.setScalar(10, 10, 1, 0, 7);
+    CHECK(storage.getNrOfAllocatedTiles() == 2);
+    CHECK(storage.getMemoryUsage() == 2*64*64*2);
+    CHECK(storage.getScalar(130, 70, 0, 1) == 42);
+    CHECK(storage.getScalar(130, 70, 0, 0) == 0);
+    CHECK(storage.getScalar(10, 10, 1, 0) == 7);
+    CHECK(storage.getScalar(10, 10, 0, 0) == 0);
+
+    // Region spanning several tiles, partly outside the level
+    std::vector<uint8_t> region(200*100*2, 255);
+    storage.getRegion(0, 100, 50, 200, 100, region.data());
+    CHECK(region[((130 - 100) + (70 - 50) * 200) * 2 + 1] == 42);
+    CHECK(region[((131 - 100) + (70 - 50) * 200) * 2 + 1] == 43);
+    CHECK(region[0] == 0);
+    CHECK(region[region.size() - 1] == 0);
+    storage.getRegion(0, 950, 450, 200, 100, region.data());
+    CHECK(region[region.size() - 1] == 0);
+}
+
+TEST_CASE("Image pyramid tile storage spills tiles to disk", "[fast][ImagePyramid][ImagePyramidTileStorage]") {
+    const int tileSize = 32;
+    ImagePyramidTileStorage storage(1, tileSize);
+    storage.addLevel(tileSize*8, tileSize*8);
+#ifdef WIN32
+    storage.setMemoryLimit(tileSize*tileSize*2, "C:/windows/temp/fast_tile_storage_test.bin");
+#else
+    storage.setMemoryLimit(tileSize*tileSize*2, "/tmp/fast_tile_storage_test.bin");
+#endif
+
+    for(int y = 0; y < 8; ++y) {
+        for(int x = 0; x < 8; ++x) {
+            storage.setScalar(x*tileSize + 1, y*tileSize + 2, 0, 0, (uint8_t)(x + y*8));
+        }
+    }
+    CHECK(storage.getNrOfAllocatedTiles() == 64);
+    CHECK(storage.getMemoryUsage() <= tileSize*tileSize*2);
+
+    for(int y = 0; y < 8; ++y) {
+        for(int x = 0; x < 8; ++x) {
+            CHECK(storage.getScalar(x*tileSize + 1, y*tileSize + 2, 0, 0) == (uint8_t)(x + y*8));
+            CHECK(storage.getScalar(x*tileSize, y*tileSize, 0, 0) == 0);
+        }
+    }
+    CHECK(storage.getMemoryUsage() <= tileSize*tileSize*2);
+}
+
+TEST_CASE("Create large image pyramid is lazy", "[fast][ImagePyramid]") {
+    auto pyramid = ImagePyramid::New();
+    pyramid->create(100000, 100000, 1);
+    CHECK(pyramid->getNrOfLevels() > 1);
+    CHECK(pyramid->getMemoryUsage() == 0);
+
+    {
+        auto access = pyramid->getAccess(ACCESS_READ_WRITE);
+        CHECK(access->getScalar(50000, 50000, 0) == 0);
+        access->setScalar(50000, 50000, 0, 255);
+        CHECK(access->getScalar(50000, 50000, 0) == 255);
+        // The value is propagated to lower resolution levels
+        CHECK(access->getScalar(25000, 25000, 1) > 0);
+        auto patch = access->getPatchData(0, 49990, 49990, 20, 20);
+        CHECK(patch[10 + 10*20] == 255);
+        CHECK(patch[0] == 0);
+    }
+    CHECK(pyramid->getMemoryUsage() < 1024*1024);
+}
+
+TEST_CASE("Set patch in image pyramid updates lower levels", "[fast][ImagePyramid]") {
+    for(bool background : {false, true}) {
+        auto pyramid = ImagePyramid::New();
+        pyramid->create(20000, 20000, 1);
+        pyramid->setBackgroundDownsampling(background);
+        const int levels = pyramid->getNrOfLevels();
+        REQUIRE(levels > 1);
+
+        auto patch = Image::New();
+        patch->create(256, 256, TYPE_UINT8, 1);
+        patch->fill(200);
+        {
+            auto access = pyramid->getAccess(ACCESS_READ_WRITE);
+            access->setPatch(0, 1024, 2048, patch);
+            CHECK_THROWS(access->setPatch(levels, 0, 0, patch));
+        }
+        pyramid->waitForBackgroundDownsampling();
+
+        auto access = pyramid->getAccess(ACCESS_READ);
+        CHECK(access->getScalar(1024, 2048, 0) == 200);
+        CHECK(access->getScalar(1024 + 255, 2048 + 255, 0) == 200);
+        CHECK(access->getScalar(1024 + 256, 2048, 0) == 0);
+        CHECK(access->getScalar(1023, 2048, 0) == 0);
+        for(int level = 1; level < levels; ++level) {
+            const int scale = 1 << level;
+            CHECK(access->getScalar(1024 / scale, 2048 / scale, level) == 200);
+        }
+        CHECK(pyramid->isDirtyPatch("0_" + std::to_string(1024*pyramid->getLevelPatches(0)/20000) + "_" + std::to_string(2048*pyramid->getLevelPatches(0)/20000)));
+    }
+}
+
+TEST_CASE("Image pyramid tile cache gives same regions as OpenSlide", "[fast][ImagePyramid][ImagePyramidTileCache][wsi]") {
+    const std::string filename = Config::getTestDataPath() + "/WSI/A05.svs";
+    auto importer = WholeSlideImageImporter::New();
+    importer->setFilename(filename);
+    auto port = importer->getOutputPort();
+    importer->update();
+    auto pyramid = port->getNextFrame<ImagePyramid>();
+    auto cache = pyramid->getTileCache();
+    REQUIRE(cache != nullptr);
+
+    // Regions which are not aligned with the tiles, and a region crossing the border of the level
+    const std::vector<Vector4i> regions = {
+        {40000, 10000, 1024, 1024},
+        {40123, 10321, 517, 333},
+        {pyramid->getFullWidth() - 100, 500, 200, 300},
+    };
+    std::vector<std::unique_ptr<uint32_t[]>> expected;
+    openslide_t* file = openslide_open(filename.c_str());
+    REQUIRE(file != nullptr);
+    for(auto&& region : regions) {
+        expected.push_back(std::make_unique<uint32_t[]>((std::size_t)region.z()*region.w()));
+        openslide_read_region(file, expected.back().get(), region.x(), region.y(), 0, region.z(), region.w());
+    }
+    openslide_close(file);
+
+    // Read from several threads at the same time, like a renderer and a patch generator would
+    std::vector<std::thread> threads;
+    std::vector<std::vector<int>> matches(4, std::vector<int>(regions.size(), 0));
+    for(int thread = 0; thread < matches.size(); ++thread) {
+        threads.emplace_back([&, thread]() {
+            auto access = pyramid->getAccess(ACCESS_READ);
+            for(int i = 0; i < regions.size(); ++i) {
+                auto data = access->getPatchData(0, regions[i].x(), regions[i].y(), regions[i].z(), regions[i].w());
+                matches[thread][i] = std::memcmp(data.get(), expected[i].get(), (std::size_t)regions[i].z()*regions[i].w()*4) == 0;
+            }
+        });
+    }
+    for(auto& thread : threads)
+        thread.join();
+    for(auto&& threadMatches : matches) {
+        for(int match : threadMatches)
+            CHECK(match == 1);
+    }
+    // Every tile is only decoded once
+    CHECK(cache->getNrOfHits() >= 3*cache->getNrOfMisses());
+    CHECK(cache->getMemoryUsage() > 0);
+}
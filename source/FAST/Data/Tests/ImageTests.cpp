@@ -1,9 +1,11 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Data/Image.hpp"
 #include "FAST/DeviceManager.hpp"
+#include "FAST/Config.hpp"
 #include "FAST/Tests/DataComparison.hpp"
 #include "FAST/Utility.hpp"
 #include <limits>
+#include <chrono>
 
 using namespace fast;
 
@@ -1483,3 +1485,170 @@ TEST_CASE("createFromImage on 3D image", "[fast][image]") {
 }
 
 
+
+TEST_CASE("OpenCL images and buffers of freed images are reused from the memory pool", "[fast][image][OpenCLMemoryPool]") {
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    auto pool = device->getMemoryPool();
+    pool->clear();
+    const uint64_t allocations = pool->getNrOfAllocations();
+    const uint64_t reuses = pool->getNrOfReuses();
+    for(int i = 0; i < 10; ++i) {
+        auto image = Image::New();
+        image->create(64, 32, TYPE_FLOAT, 1);
+        image->fill(i);
+        auto imageAccess = image->getOpenCLImageAccess(ACCESS_READ, device);
+        auto bufferAccess = image->getOpenCLBufferAccess(ACCESS_READ, device);
+    }
+    // One image and one buffer is allocated, then reused for the rest of the frames
+    CHECK(pool->getNrOfAllocations() - allocations == 2);
+    CHECK(pool->getNrOfReuses() - reuses == 18);
+    CHECK(pool->getSize() == 2*64*32*sizeof(float));
+
+    // Image with the same size, but another format, can't reuse them
+    {
+        auto image = Image::New();
+        image->create(64, 32, TYPE_UINT8, 1);
+        image->fill(0);
+    }
+    CHECK(pool->getNrOfAllocations() - allocations == 3);
+
+    // Pool is disabled
+    pool->setMaximumSize(0);
+    CHECK(pool->getSize() == 0);
+    {
+        auto image = Image::New();
+        image->create(64, 32, TYPE_FLOAT, 1);
+        image->fill(0);
+    }
+    CHECK(pool->getSize() == 0);
+    pool->setMaximumSize(256*1024*1024);
+}
+
+TEST_CASE("OpenCL memory pool streaming benchmark", "[fast][image][OpenCLMemoryPool][benchmark]") {
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    auto pool = device->getMemoryPool();
+    const std::size_t maximumSize = pool->getMaximumSize();
+    const int frames = 500;
+    for(bool enabled : {false, true}) {
+        pool->clear();
+        pool->setMaximumSize(enabled ? maximumSize : 0);
+        const uint64_t allocations = pool->getNrOfAllocations();
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < frames; ++i) {
+            // Same pattern as a 2D stream through a filter: an input frame and an output frame of the same size
+            auto input = Image::New();
+            input->create(512, 512, TYPE_FLOAT, 1);
+            input->fill(i);
+            auto output = Image::New();
+            output->create(512, 512, TYPE_FLOAT, 1);
+            auto inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
+            auto outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+            device->getCommandQueue().enqueueCopyImageToBuffer(*inputAccess->get2DImage(), *outputAccess->get(),
+                    createOrigoRegion(), createRegion(512, 512, 1), 0);
+        }
+        device->getCommandQueue().finish();
+        std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+        const uint64_t frameAllocations = pool->getNrOfAllocations() - allocations;
+        Reporter::info() << "Memory pool " << (enabled ? "enabled" : "disabled") << ": " << frameAllocations
+            << " allocations, " << duration.count() / frames << " ms per frame" << Reporter::end();
+        if(enabled) {
+            CHECK(frameAllocations <= 2);
+        } else {
+            CHECK(frameAllocations == 2*frames);
+        }
+    }
+    pool->setMaximumSize(maximumSize);
+}
+
+TEST_CASE("Transfer of 3 channel image in pinned host memory to OpenCL and back", "[fast][image]") {
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    Config::setPinnedHostMemory(true);
+    const int width = 64, height = 32;
+    auto data = std::make_unique<uchar[]>(width*height*3);
+    for(int i = 0; i < width*height*3; ++i)
+        data[i] = i % 255;
+    auto image = Image::New();
+    image->create(width, height, TYPE_UINT8, 3, Host::getInstance(), data.get());
+
+    for(int frame = 0; frame < 3; ++frame) {
+        {
+            // Non-blocking upload
+            auto access = image->getOpenCLImageAccess(ACCESS_READ, device);
+        }
+        {
+            // Waits for the upload before the host data is changed
+            auto access = image->getImageAccess(ACCESS_READ_WRITE);
+            auto pixels = (uchar*)access->get();
+            for(int i = 0; i < width*height*3; ++i)
+                pixels[i] = (data[i] + frame + 1) % 255;
+        }
+    }
+    {
+        // Modify on device, then transfer back through the padded host data
+        auto access = image->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
+    }
+    auto access = image->getImageAccess(ACCESS_READ);
+    auto pixels = (uchar*)access->get();
+    bool equal = true;
+    for(int i = 0; i < width*height*3; ++i)
+        equal = equal && pixels[i] == (data[i] + 3) % 255;
+    CHECK(equal);
+    Config::setPinnedHostMemory(false);
+}
+
+TEST_CASE("Upload of images in pageable and pinned host memory benchmark", "[fast][image][benchmark]") {
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    const int frames = 200;
+    for(bool pinned : {false, true}) {
+        Config::setPinnedHostMemory(pinned);
+        std::chrono::duration<float, std::milli> uploadDuration(0);
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < frames; ++i) {
+            auto image = Image::New();
+            image->create(1920, 1080, TYPE_UINT8, 3);
+            {
+                auto access = image->getImageAccess(ACCESS_READ_WRITE);
+                std::memset(access->get(), i, 1920*1080*3);
+            }
+            // Time the computation thread waits for the upload
+            auto uploadStart = std::chrono::high_resolution_clock::now();
+            auto access = image->getOpenCLImageAccess(ACCESS_READ, device);
+            uploadDuration += std::chrono::high_resolution_clock::now() - uploadStart;
+        }
+        device->getCommandQueue().finish();
+        std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+        Reporter::info() << (pinned ? "Pinned" : "Pageable") << " host memory: " << uploadDuration.count() / frames
+            << " ms waiting for upload, " << duration.count() / frames << " ms per frame" << Reporter::end();
+    }
+    Config::setPinnedHostMemory(false);
+}
+
+TEST_CASE("Create image from external buffer without copying", "[fast][image]") {
+    const int width = 64, height = 32;
+    auto buffer = std::make_shared<std::vector<float>>(width*height*2);
+    for(int i = 0; i < width*height*2; ++i)
+        (*buffer)[i] = i;
+    bool deleted = false;
+    {
+        auto image = Image::New();
+        image->create(width, height, TYPE_FLOAT, 2, buffer->data(), [buffer, &deleted](void* data) {
+            CHECK(data == buffer->data());
+            deleted = true;
+        });
+        CHECK(buffer.use_count() == 2);
+        {
+            auto access = image->getImageAccess(ACCESS_READ);
+            CHECK(access->get() == buffer->data());
+        }
+        // Host data is still used after a transfer to an OpenCL device and back
+        {
+            auto access = image->getOpenCLBufferAccess(ACCESS_READ, std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice()));
+        }
+        auto access = image->getImageAccess(ACCESS_READ_WRITE);
+        CHECK(access->get() == buffer->data());
+        CHECK(access->getScalar(Vector2i(width-1, height-1), 1) == width*height*2-1);
+        CHECK_FALSE(deleted);
+    }
+    CHECK(deleted);
+    CHECK(buffer.use_count() == 1);
+}
@@ -0,0 +1,62 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Data/Tensor.hpp"
+
+namespace fast {
+
+TEST_CASE("Tensor view reads data of parent without copy", "[fast][Tensor]") {
+    auto parent = Tensor::New();
+    parent->create(TensorShape({3, 2, 2}));
+    {
+        auto access = parent->getAccess(ACCESS_READ_WRITE);
+        float* data = access->getRawData();
+        for(int i = 0; i < 12; ++i)
+            data[i] = i;
+    }
+
+    for(int i = 0; i < 3; ++i) {
+        auto view = Tensor::New();
+        view->createView(parent, i*4, TensorShape({2, 2}));
+        CHECK(view->getShape().getTotalSize() == 4);
+        auto access = view->getAccess(ACCESS_READ);
+        auto data = access->getData<2>();
+        CHECK(data(0, 0) == i*4);
+        CHECK(data(1, 1) == i*4 + 3);
+    }
+}
+
+TEST_CASE("Tensor view keeps parent alive", "[fast][Tensor]") {
+    auto view = Tensor::New();
+    {
+        auto parent = Tensor::New();
+        parent->create({1, 2, 3, 4});
+        view->createView(parent, 2, TensorShape({2}));
+    }
+    auto access = view->getAccess(ACCESS_READ);
+    CHECK(access->getRawData()[0] == 3);
+    CHECK(access->getRawData()[1] == 4);
+}
+
+TEST_CASE("Tensor view outside of parent throws", "[fast][Tensor]") {
+    auto parent = Tensor::New();
+    parent->create({1, 2, 3, 4});
+    auto view = Tensor::New();
+    CHECK_THROWS(view->createView(parent, 3, TensorShape({2})));
+}
+
+TEST_CASE("Creating a tensor which was a view detaches it from the parent", "[fast][Tensor]") {
+    auto parent = Tensor::New();
+    parent->create({1, 2, 3, 4});
+    auto tensor = Tensor::New();
+    tensor->createView(parent, 2, TensorShape({2}));
+    tensor->create({5, 6});
+    {
+        auto access = tensor->getAccess(ACCESS_READ_WRITE);
+        CHECK(access->getRawData()[0] == 5);
+        CHECK(access->getRawData()[1] == 6);
+        access->getRawData()[0] = 7;
+    }
+    auto access = parent->getAccess(ACCESS_READ);
+    CHECK(access->getRawData()[2] == 3);
+}
+
+}
@@ -0,0 +1,217 @@
+#include "RingBufferDataChannel.hpp"
+#include <thread>
+
+namespace fast {
+
+bool RingBufferDataChannel::tryAddFrame(DataObject::pointer& data) {
+    uint64_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+    Slot* slot;
+    while(true) {
+        slot = &m_buffer[position % m_capacity];
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const int64_t difference = (int64_t)sequence - (int64_t)position;
+        if(difference == 0) {
+            // Slot is free, claim it
+            if(!m_multiple) {
+                m_enqueuePosition.store(position + 1, std::memory_order_relaxed);
+                break;
+            }
+            if(m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if(difference < 0) {
+            // Buffer is full
+            return false;
+        } else {
+            // Another producer claimed this slot, try again
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->data = std::move(data);
+    // Publish the frame to the consumer
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool RingBufferDataChannel::tryGetFrame(DataObject::pointer& data) {
+    uint64_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+    Slot* slot;
+    while(true) {
+        slot = &m_buffer[position % m_capacity];
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const int64_t difference = (int64_t)sequence - (int64_t)(position + 1);
+        if(difference == 0) {
+            // Slot has a frame, claim it
+            if(!m_multiple) {
+                m_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+                break;
+            }
+            if(m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if(difference < 0) {
+            // Buffer is empty
+            return false;
+        } else {
+            // Another consumer claimed this slot, try again
+            position = m_dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    data = std::move(slot->data);
+    slot->data.reset();
+    // Hand the slot back to the producer for the next lap
+    slot->sequence.store(position + m_capacity, std::memory_order_release);
+    return true;
+}
+
+void RingBufferDataChannel::wakeUp(std::atomic<int>& sleepers, std::condition_variable& condition) {
+    // Pairs with the fence in the waiting thread: Either we see the sleeper, or it sees our update of the buffer
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleepers.load(std::memory_order_relaxed) > 0) {
+        // Take the lock so that the notification can't happen between the sleeper's check and wait
+        { std::lock_guard<std::mutex> lock(m_mutex); }
+        condition.notify_all();
+    }
+}
+
+void RingBufferDataChannel::addFrame(DataObject::pointer data) {
+    int spin = 0;
+    while(true) {
+        // If stop is signaled, throw an exception to stop the entire computation thread
+        if(m_stopSignaled.load(std::memory_order_acquire))
+            throw ThreadStopped();
+
+        if(tryAddFrame(data))
+            break;
+
+        // Buffer is full, spin for a while before going to sleep
+        if(spin < m_spinCount) {
+            if(spin > m_spinCount / 2)
+                std::this_thread::yield();
+            ++spin;
+            continue;
+        }
+
+        bool added = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleepingProducers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_notFull.wait(lock, [this, &data, &added]() {
+                return m_stopSignaled.load() || (added = tryAddFrame(data));
+            });
+            m_sleepingProducers.fetch_sub(1);
+        }
+        if(added)
+            break;
+    }
+
+    wakeUp(m_sleepingConsumers, m_notEmpty);
+}
+
+DataObject::pointer RingBufferDataChannel::getNextDataFrame() {
+    DataObject::pointer data;
+    int spin = 0;
+    while(true) {
+        // If stop is signaled, throw an exception to stop the entire computation thread
+        if(m_stopSignaled.load(std::memory_order_acquire))
+            throw ThreadStopped();
+
+        if(tryGetFrame(data))
+            break;
+
+        // Buffer is empty, spin for a while before going to sleep
+        if(spin < m_spinCount) {
+            if(spin > m_spinCount / 2)
+                std::this_thread::yield();
+            ++spin;
+            continue;
+        }
+
+        bool received = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleepingConsumers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_notEmpty.wait(lock, [this, &data, &received]() {
+                return m_stopSignaled.load() || (received = tryGetFrame(data));
+            });
+            m_sleepingConsumers.fetch_sub(1);
+        }
+        if(received)
+            break;
+    }
+
+    wakeUp(m_sleepingProducers, m_notFull);
+
+    return data;
+}
+
+int RingBufferDataChannel::getSize() {
+    const uint64_t dequeuePosition = m_dequeuePosition.load(std::memory_order_acquire);
+    const uint64_t enqueuePosition = m_enqueuePosition.load(std::memory_order_acquire);
+    // A producer may have claimed a slot which is not yet published, thus this is only an estimate
+    if(enqueuePosition < dequeuePosition)
+        return 0;
+    return (int)std::min<uint64_t>(enqueuePosition - dequeuePosition, m_capacity);
+}
+
+void RingBufferDataChannel::setMaximumNumberOfFrames(uint frames) {
+    if(m_buffer && getSize() > 0)
+        throw Exception("Have to call setMaximumNumberOfFrames before executing pipeline");
+    if(frames == 0)
+        throw Exception("Maximum number of frames in RingBufferDataChannel must be larger than 0");
+    m_capacity = std::max<uint64_t>(frames, 2);
+    m_buffer = std::make_unique<Slot[]>(m_capacity);
+    for(uint64_t i = 0; i < m_capacity; ++i)
+        m_buffer[i].sequence.store(i, std::memory_order_relaxed);
+    m_enqueuePosition.store(0);
+    m_dequeuePosition.store(0);
+}
+
+void RingBufferDataChannel::setMultipleProducersAndConsumers(bool multiple) {
+    m_multiple = multiple;
+}
+
+void RingBufferDataChannel::setSpinCount(int count) {
+    if(count < 0)
+        throw Exception("Spin count in RingBufferDataChannel can't be negative");
+    m_spinCount = count;
+}
+
+void RingBufferDataChannel::stop() {
+    DataChannel::stop();
+    m_stopSignaled.store(true);
+
+    // Since getNextFrame or addFrame might be sleeping, we need to wake them up to stop them blocking
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_notFull.notify_all();
+    m_notEmpty.notify_all();
+}
+
+bool RingBufferDataChannel::hasCurrentData() {
+    const uint64_t position = m_dequeuePosition.load(std::memory_order_acquire);
+    return m_buffer[position % m_capacity].sequence.load(std::memory_order_acquire) == position + 1;
+}
+
+DataObject::pointer RingBufferDataChannel::getFrame() {
+    // Peek at the next frame. This assumes that no other thread is consuming frames at the same time.
+    const uint64_t position = m_dequeuePosition.load(std::memory_order_acquire);
+    Slot& slot = m_buffer[position % m_capacity];
+    if(slot.sequence.load(std::memory_order_acquire) != position + 1)
+        throw Exception("No frames available in getFrame");
+    return slot.data;
+}
+
+RingBufferDataChannel::RingBufferDataChannel() {
+    m_stopSignaled = false;
+    m_sleepingProducers = 0;
+    m_sleepingConsumers = 0;
+    // Spinning is pointless if the other thread can't run at the same time
+    m_spinCount = std::thread::hardware_concurrency() > 1 ? 4000 : 0;
+    setMaximumNumberOfFrames(50);
+}
+
+}
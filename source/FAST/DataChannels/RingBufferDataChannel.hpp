@@ -0,0 +1,92 @@
+#pragma once
+
+#include <FAST/DataChannels/DataChannel.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <vector>
+
+namespace fast {
+
+/**
+ * A bounded lock-free data channel for streams where all frames should be processed.
+ * It is used on the output data channels of streamers when streaming mode is
+ * STREAMING_MODE_PROCESS_ALL_FRAMES_LOCK_FREE.
+ *
+ * Frames are stored in a ring buffer where every slot has a sequence number (Vyukov's bounded queue).
+ * With a single producer and a single consumer, which is the normal case in a FAST pipeline,
+ * the positions are advanced with plain atomic stores. If multiple threads add or get frames,
+ * setMultipleProducersAndConsumers(true) must be called, and the positions are claimed with compare-and-swap.
+ *
+ * Threads waiting for a free slot or a new frame spin for a while before they are parked on a condition variable.
+ */
+class FAST_EXPORT RingBufferDataChannel : public DataChannel {
+    FAST_OBJECT(RingBufferDataChannel)
+    public:
+        /**
+         * Add frame to the data channel. This call may block
+         * if the buffer is full.
+         */
+        void addFrame(DataObject::pointer data) override;
+
+        /**
+         * @return the number of frames stored in this DataChannel
+         */
+        int getSize() override;
+
+        /**
+         * Set the maximum nr of frames that can be stored in this data channel.
+         * The ring buffer needs at least 2 slots, thus a value of 1 is rounded up to 2.
+         */
+        void setMaximumNumberOfFrames(uint frames) override;
+
+        /**
+         * Set whether more than one thread may add frames, or get frames, at the same time.
+         * Default is false.
+         */
+        void setMultipleProducersAndConsumers(bool multiple);
+
+        /**
+         * Set how many times a blocked thread should poll the buffer before it goes to sleep.
+         */
+        void setSpinCount(int count);
+
+        /**
+         * This will unblock if this DataChannel is currently blocking. Used to stop a pipeline.
+         */
+        void stop() override;
+
+        bool hasCurrentData() override;
+
+        /**
+         * Get current frame, throws if current frame is not available.
+         */
+        DataObject::pointer getFrame() override;
+    protected:
+        struct Slot {
+            std::atomic<uint64_t> sequence;
+            DataObject::pointer data;
+        };
+        std::unique_ptr<Slot[]> m_buffer;
+        uint64_t m_capacity;
+        bool m_multiple = false;
+        int m_spinCount;
+
+        // Keep producer and consumer positions on separate cache lines to avoid false sharing
+        alignas(64) std::atomic<uint64_t> m_enqueuePosition;
+        alignas(64) std::atomic<uint64_t> m_dequeuePosition;
+
+        alignas(64) std::atomic<bool> m_stopSignaled;
+        std::atomic<int> m_sleepingProducers;
+        std::atomic<int> m_sleepingConsumers;
+        std::condition_variable m_notFull;
+        std::condition_variable m_notEmpty;
+
+        bool tryAddFrame(DataObject::pointer& data);
+        bool tryGetFrame(DataObject::pointer& data);
+        void wakeUp(std::atomic<int>& sleepers, std::condition_variable& condition);
+        DataObject::pointer getNextDataFrame() override;
+        RingBufferDataChannel();
+
+};
+
+}
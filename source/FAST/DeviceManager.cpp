@@ -1,5 +1,6 @@
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Exception.hpp"
+#include "FAST/Config.hpp"
 #include <algorithm>
 #ifdef FAST_MODULE_VISUALIZATION
 #include "FAST/Visualization/Window.hpp"
@@ -68,7 +69,8 @@ throw Exception("Not able to get sharegroup");
 DeviceManager* DeviceManager::getInstance() {
     if(mInstance == NULL) {
 #ifdef FAST_MODULE_VISUALIZATION
-        Window::initializeQtApp();
+        if(Config::getVisualization())
+            Window::initializeQtApp();
 #endif
         mInstance = new DeviceManager();
     }
@@ -76,6 +78,10 @@ DeviceManager* DeviceManager::getInstance() {
     return mInstance;
 }
 
+bool DeviceManager::hasInstance() {
+    return mInstance != NULL;
+}
+
 void DeviceManager::deleteInstance() {
     if(mInstance != NULL) {
         // TODO this creates a memory leak, but deleting this instance causes seg fault for some reason
@@ -86,7 +92,10 @@ void DeviceManager::deleteInstance() {
 
 std::vector<OpenCLDevice::pointer> DeviceManager::getDevices(DeviceCriteria criteria, bool enableVisualization) {
     unsigned long * glContext = NULL;
-    if(!isGLInteropEnabled()) {
+    if(!Config::getVisualization()) {
+        // Headless: no GL context to share with
+        enableVisualization = false;
+    } else if(!isGLInteropEnabled()) {
         enableVisualization = false;
 #ifdef FAST_MODULE_VISUALIZATION
         fast::Window::getMainGLContext(); // Still have to create GL context
@@ -3,6 +3,9 @@
 #include "FAST/Utility.hpp"
 #include <mutex>
 #include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
 #include "FAST/Config.hpp"
 
 #if defined(__APPLE__) || defined(__MACOSX)
@@ -92,7 +95,11 @@ OpenCLDevice::OpenCLDevice() {
 }
 
 
-std::mutex buildBinaryMutex; // a global mutex
+// Protects the program lists of devices. Programs are compiled without holding this lock,
+// so that several programs can be compiled in parallel.
+std::mutex programMutex;
+// Protects the index file of the kernel binary cache
+std::mutex binaryCacheIndexMutex;
 
 bool OpenCLDevice::isImageFormatSupported(cl_channel_order order, cl_channel_type type, cl_mem_object_type imageType) {
     std::vector<cl::ImageFormat> formats;
@@ -182,6 +189,7 @@ OpenCLDevice::OpenCLDevice(std::vector<cl::Device> devices, unsigned long* OpenG
     }
     this->context = cl::Context(devices,cps);
     delete[] cps;
+    m_memoryPool = std::make_shared<OpenCLMemoryPool>(context, runtimeManager);
 
     // Create a command queue for each device
     for(int i = 0; i < devices.size(); i++) {
@@ -194,18 +202,15 @@ OpenCLDevice::OpenCLDevice(std::vector<cl::Device> devices, unsigned long* OpenG
 }
 
 int OpenCLDevice::createProgramFromSource(std::string filename, std::string buildOptions, bool useCaching) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
     cl::Program program;
     if(useCaching) {
-        program = buildProgramFromBinary(filename, buildOptions);
+        program = buildProgramFromCache(filename, buildOptions);
     } else {
-        std::string sourceCode = readFile(filename);
-        // If 3d image writes is supported, append the enable line to all source files (fix error on Intel devices)
-        if(isWritingTo3DTexturesSupported())
-            sourceCode = "#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable\n\n" + sourceCode;
+        std::string sourceCode = readSourceCode(filename);
         cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
         program = buildSources(source, buildOptions);
     }
+    std::lock_guard<std::mutex> lock(programMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
@@ -214,7 +219,6 @@ int OpenCLDevice::createProgramFromSource(std::string filename, std::string buil
  * Compile several source files together
  */
 int OpenCLDevice::createProgramFromSource(std::vector<std::string> filenames, std::string buildOptions) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
     // Do this in a weird way, because the the logical way does not work.
     std::string sourceCode = readFile(filenames[0]);
     if(isWritingTo3DTexturesSupported())
@@ -229,21 +233,22 @@ int OpenCLDevice::createProgramFromSource(std::vector<std::string> filenames, st
     }
 
     cl::Program program = buildSources(sources, buildOptions);
+    std::lock_guard<std::mutex> lock(programMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
 
 int OpenCLDevice::createProgramFromString(std::string code, std::string buildOptions) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
     cl::Program::Sources source(1, std::make_pair(code.c_str(), code.length()));
 
     cl::Program program = buildSources(source, buildOptions);
+    std::lock_guard<std::mutex> lock(programMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
 
 cl::Program OpenCLDevice::getProgram(unsigned int i) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
+    std::lock_guard<std::mutex> lock(programMutex);
     return programs.at(i);
 }
 
@@ -293,56 +298,75 @@ RuntimeMeasurementsManager::pointer OpenCLDevice::getRunTimeMeasurementManager()
 	return runtimeManager;
 }
 
+OpenCLMemoryPool::pointer OpenCLDevice::getMemoryPool() {
+    return m_memoryPool;
+}
 
-cl::Program OpenCLDevice::writeBinary(std::string filename, std::string buildOptions) {
-    // Build program from source file and store the binary file
-    std::string sourceCode = readFile(filename);
-    // If 3d image writes is supported, append the enable line to all source files (fix error on Intel devices)
-    if(isWritingTo3DTexturesSupported())
-        sourceCode = "#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable\n\n" + sourceCode;
-
-    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
-    cl::Program program = buildSources(source, buildOptions);
-
-    std::vector<std::size_t> binarySizes;
-    binarySizes = program.getInfo<CL_PROGRAM_BINARY_SIZES>();
 
-    std::vector<std::vector<uchar>> binaries;
-    binaries = program.getInfo<CL_PROGRAM_BINARIES>();
+/**
+ * 64 bit FNV-1a hash. Unlike std::hash, this gives the same value on all platforms and compilers,
+ * which is needed since it is used in file names of the kernel binary cache.
+ */
+static uint64_t hashFNV1a(const std::string& data, uint64_t hash = 14695981039346656037ULL) {
+    for(unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
 
-    std::string deviceName = getDevice(0).getInfo<CL_DEVICE_NAME>();
-    std::size_t hash = std::hash<std::string>{}(buildOptions + deviceName);
-    std::string binaryPath = Config::getKernelBinaryPath();
-    // TODO fix this for both install and build
-    std::string kernelSourcePath = Config::getKernelSourcePath();
-    std::string binaryFilename = binaryPath + filename.substr(kernelSourcePath.size()) + "_" + std::to_string(hash) + ".bin";
-    std::string cacheFilename = binaryPath + filename.substr(kernelSourcePath.size()) + "_" + std::to_string(hash) + ".cache";
-
-    // Create directories if they don't exist
-    if(binaryFilename.rfind("/") != std::string::npos) {
-        std::string directoryPath = binaryFilename.substr(0, binaryFilename.rfind("/"));
-//        QDir dir(directoryPath.c_str());
-//        if (!dir.exists()) {
-//            dir.mkpath(".");
-//        }
-        createDirectories(directoryPath);
+/**
+ * Add the content of a source file and all files it includes with #include "..." to content.
+ * Included files are looked up relative to the file including them.
+ */
+static void readSourceClosure(const std::string& filename, std::string& content, std::set<std::string>& visited) {
+    if(visited.count(filename) > 0)
+        return;
+    visited.insert(filename);
+    const std::string sourceCode = readFile(filename);
+    content += filename + "\n" + sourceCode + "\n";
+    const std::string directory = filename.rfind('/') != std::string::npos ? filename.substr(0, filename.rfind('/') + 1) : "";
+    std::stringstream stream(sourceCode);
+    std::string line;
+    while(std::getline(stream, line)) {
+        trim(line);
+        if(line.compare(0, 8, "#include") != 0)
+            continue;
+        const std::size_t start = line.find('"');
+        const std::size_t end = line.find('"', start + 1);
+        if(start == std::string::npos || end == std::string::npos)
+            continue;
+        const std::string includeFilename = directory + line.substr(start + 1, end - start - 1);
+        if(fileExists(includeFilename))
+            readSourceClosure(includeFilename, content, visited);
     }
-    FILE * file = fopen(binaryFilename.c_str(), "wb");
-    if(!file)
-        throw Exception("Could not write kernel binary to file: " + binaryFilename);
-    fwrite(binaries[0].data(), sizeof(char), (int)binarySizes[0], file);
-    fclose(file);
+}
 
-    // Write cache file
-    FILE * cacheFile = fopen(cacheFilename.c_str(), "w");
-    std::string timeStr = getModifiedDate(filename);
-    std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
-    timeStr += "-" + devices[0].getInfo<CL_DEVICE_NAME>() + "\n";
-    timeStr += "-" + buildOptions;
-    fwrite(timeStr.c_str(), sizeof(char), timeStr.size(), cacheFile);
-    fclose(cacheFile);
+std::string OpenCLDevice::readSourceCode(std::string filename) {
+    std::string sourceCode = readFile(filename);
+    // If 3d image writes is supported, append the enable line to all source files (fix error on Intel devices)
+    if(isWritingTo3DTexturesSupported())
+        sourceCode = "#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable\n\n" + sourceCode;
+    return sourceCode;
+}
 
-    return program;
+std::string OpenCLDevice::getProgramBinaryFilename(std::string filename, std::string buildOptions) {
+    // The key consists of everything which can change the compiled program
+    std::string content;
+    std::set<std::string> visited;
+    readSourceClosure(filename, content, visited);
+    cl::Device device = getDevice(0);
+    std::string key = content;
+    key += '\0' + buildOptions;
+    key += '\0' + device.getInfo<CL_DEVICE_NAME>();
+    key += '\0' + device.getInfo<CL_DEVICE_VERSION>();
+    key += '\0' + device.getInfo<CL_DRIVER_VERSION>();
+    key += '\0' + platform.getInfo<CL_PLATFORM_VERSION>();
+    key += '\0' + std::to_string(isWritingTo3DTexturesSupported());
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)hashFNV1a(key));
+    return join(Config::getKernelBinaryPath(), "cache", std::string(hash) + ".bin");
 }
 
 cl::Program OpenCLDevice::readBinary(std::string filename) {
@@ -367,62 +391,73 @@ cl::Program OpenCLDevice::readBinary(std::string filename) {
     return program;
 }
 
-cl::Program OpenCLDevice::buildProgramFromBinary(std::string filename, std::string buildOptions) {
-    cl::Program program;
-
-    std::string deviceName = getDevice(0).getInfo<CL_DEVICE_NAME>();
-    std::size_t hash = std::hash<std::string>{}(buildOptions + deviceName);
-    std::string binaryPath = Config::getKernelBinaryPath();
+cl::Program OpenCLDevice::buildProgramFromCache(std::string filename, std::string buildOptions) {
+    const std::string binaryFilename = getProgramBinaryFilename(filename, buildOptions);
     std::string kernelSourcePath = Config::getKernelSourcePath();
-    std::string binaryFilename = binaryPath + filename.substr(kernelSourcePath.size()) + "_" + std::to_string(hash) + ".bin";
-    std::string cacheFilename = binaryPath + filename.substr(kernelSourcePath.size()) + "_" + std::to_string(hash) + ".cache";
-
-    // Check if a binary file exists
-    std::ifstream binaryFile(binaryFilename.c_str(), std::ios_base::binary | std::ios_base::in);
-    if(binaryFile.fail()) {
-        program = writeBinary(filename, buildOptions);
-    } else {
-        // Compare modified dates of binary file and source file
-
-        // Read cache file
-        std::ifstream cacheFile(cacheFilename.c_str());
-        std::string cache(
-            std::istreambuf_iterator<char>(cacheFile),
-            (std::istreambuf_iterator<char>()));
-
-        bool outOfDate = true;
-        bool wrongDeviceID = true;
-        bool buildOptionsChanged = true;
-        const size_t pos = cache.find("-");
-        const size_t pos2 = cache.find("-", pos+1);
-        if(pos != std::string::npos && pos2 != std::string::npos) {
-            // Get modification date of file
-            #ifdef WIN32
-            HANDLE hFile = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
-            FILETIME ftCreate, ftAccess, ftWrite;
-			SYSTEMTIME sysTime;
-            GetFileTime(hFile, &ftCreate, &ftAccess, &ftWrite);
-			FileTimeToSystemTime(&ftWrite, &sysTime);
-			char* buffer = new char[255];
-			sprintf(buffer, "%d%d%d%d%d", sysTime.wYear, sysTime.wMonth, sysTime.wDay, sysTime.wHour,sysTime.wMinute,sysTime.wSecond);
-			outOfDate = strcmp(buffer, cache.substr(0, pos).c_str()) != 0;
-			delete[] buffer;
-            #else
-            struct stat attrib; // create a file attribute structure
-            stat(filename.c_str(), &attrib);
-            outOfDate = strcmp(ctime(&(attrib.st_mtime)), cache.substr(0, pos).c_str()) != 0;
-            #endif
-            std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
-            wrongDeviceID = cache.substr(pos+1, pos2-pos-2) != devices[0].getInfo<CL_DEVICE_NAME>();
-            buildOptionsChanged = cache.substr(pos2+1) != buildOptions;
+    std::string relativeFilename = filename.compare(0, kernelSourcePath.size(), kernelSourcePath) == 0 ? filename.substr(kernelSourcePath.size()) : filename;
+
+    // Since the file name is a hash of the source code, build options and device, an existing binary is always up to date
+    if(fileExists(binaryFilename)) {
+        try {
+            return readBinary(binaryFilename);
+        } catch(cl::Error &error) {
+            Reporter::warning() << "Kernel binary " << binaryFilename << " of " << relativeFilename << " could not be loaded. Compiling..." << Reporter::end();
         }
+    } else {
+        reportInfo() << "No kernel binary found for " << relativeFilename << ". Compiling..." << reportEnd();
+    }
 
-        if(outOfDate || wrongDeviceID || buildOptionsChanged) {
-            Reporter::warning() << "Kernel binary " << filename.substr(kernelSourcePath.size()) << " is out of date. Compiling..." << Reporter::end();
-            program = writeBinary(filename, buildOptions);
-        } else {
-            //std::cout << "Binary is not out of date." << std::endl;
-            program = readBinary(binaryFilename);
+    std::string sourceCode = readSourceCode(filename);
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = buildSources(source, buildOptions);
+
+    std::vector<std::size_t> binarySizes = program.getInfo<CL_PROGRAM_BINARY_SIZES>();
+    std::vector<std::vector<uchar>> binaries = program.getInfo<CL_PROGRAM_BINARIES>();
+
+    // Write to a temporary file first, and then rename it, so that other processes and threads
+    // never read a partially written binary
+    const std::string directoryPath = binaryFilename.substr(0, binaryFilename.rfind('/'));
+    createDirectories(directoryPath);
+    const std::string temporaryFilename = binaryFilename + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+    FILE * file = fopen(temporaryFilename.c_str(), "wb");
+    if(!file)
+        throw Exception("Could not write kernel binary to file: " + temporaryFilename);
+    fwrite(binaries[0].data(), sizeof(char), binarySizes[0], file);
+    fclose(file);
+    if(std::rename(temporaryFilename.c_str(), binaryFilename.c_str()) != 0) {
+        // Binary was created by someone else in the meantime
+        std::remove(temporaryFilename.c_str());
+    }
+
+    // Keep an index of which source file each binary belongs to. Entries of older binaries of the same
+    // source file, device and build options are replaced, so that the index doesn't grow with every compile.
+    {
+        std::lock_guard<std::mutex> lock(binaryCacheIndexMutex);
+        const std::string binaryName = binaryFilename.substr(directoryPath.size() + 1);
+        const std::string description = relativeFilename + " \"" + getDevice(0).getInfo<CL_DEVICE_NAME>() + "\" " + buildOptions;
+        const std::string indexFilename = join(directoryPath, "index.txt");
+        std::vector<std::string> entries;
+        {
+            std::ifstream index(indexFilename);
+            std::string line;
+            while(std::getline(index, line)) {
+                const auto separator = line.find(' ');
+                if(separator == std::string::npos || line.substr(0, separator) == binaryName || line.substr(separator + 1) == description)
+                    continue;
+                entries.push_back(line);
+            }
+        }
+        entries.push_back(binaryName + " " + description);
+        const std::string temporaryIndexFilename = indexFilename + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream index(temporaryIndexFilename);
+            for(auto&& entry : entries)
+                index << entry << "\n";
+        }
+        if(std::rename(temporaryIndexFilename.c_str(), indexFilename.c_str()) != 0) {
+            // Rename doesn't replace existing files on Windows
+            std::remove(indexFilename.c_str());
+            std::rename(temporaryIndexFilename.c_str(), indexFilename.c_str());
         }
     }
 
@@ -433,28 +468,34 @@ int OpenCLDevice::createProgramFromSourceWithName(
         std::string programName,
         std::string filename,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromSource(filename,buildOptions);
-    return programNames[programName];
+    const int index = createProgramFromSource(filename,buildOptions);
+    std::lock_guard<std::mutex> lock(programMutex);
+    programNames[programName] = index;
+    return index;
 }
 
 int OpenCLDevice::createProgramFromSourceWithName(
         std::string programName,
         std::vector<std::string> filenames,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromSource(filenames,buildOptions);
-    return programNames[programName];
+    const int index = createProgramFromSource(filenames,buildOptions);
+    std::lock_guard<std::mutex> lock(programMutex);
+    programNames[programName] = index;
+    return index;
 }
 
 int OpenCLDevice::createProgramFromStringWithName(
         std::string programName,
         std::string code,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromString(code,buildOptions);
-    return programNames[programName];
+    const int index = createProgramFromString(code,buildOptions);
+    std::lock_guard<std::mutex> lock(programMutex);
+    programNames[programName] = index;
+    return index;
 }
 
 cl::Program OpenCLDevice::getProgram(std::string name) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
+    std::lock_guard<std::mutex> lock(programMutex);
     if(programNames.count(name) == 0) {
         std::string msg ="Could not find OpenCL program with the name" + name;
         throw Exception(msg.c_str(), __LINE__, __FILE__);
@@ -467,6 +508,7 @@ cl::Program OpenCLDevice::getProgram(std::string name) {
 }
 
 bool OpenCLDevice::hasProgram(std::string name) {
+    std::lock_guard<std::mutex> lock(programMutex);
     return programNames.count(name) > 0;
 }
 
@@ -3,6 +3,7 @@
 
 #include "FAST/Object.hpp"
 #include "RuntimeMeasurementManager.hpp"
+#include "OpenCLMemoryPool.hpp"
 
 namespace fast {
 
@@ -80,6 +81,15 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
         cl::Program getProgram(unsigned int i);
         cl::Program getProgram(std::string name);
         bool hasProgram(std::string name);
+        /**
+         * Get the file name of the cached binary of a program.
+         * The file name is a hash of the source code, including any files it includes, the build options and
+         * the device and driver version. Thus, if the file exists, it is up to date.
+         * @param filename Source file name of program
+         * @param buildOptions
+         * @return path to binary file in the kernel binary cache, which may not exist yet
+         */
+        std::string getProgramBinaryFilename(std::string filename, std::string buildOptions = "");
 
         bool isImageFormatSupported(cl_channel_order order, cl_channel_type type, cl_mem_object_type imageType);
 
@@ -99,13 +109,17 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
         }
         bool isWritingTo3DTexturesSupported();
         RuntimeMeasurementsManager::pointer getRunTimeMeasurementManager();
+        /**
+         * Get the pool which recycles the OpenCL images and buffers of data objects on this device
+         */
+        OpenCLMemoryPool::pointer getMemoryPool();
         ~OpenCLDevice();
     private:
         OpenCLDevice();
         unsigned long * mGLContext;
-        cl::Program writeBinary(std::string filename, std::string buildOptions);
         cl::Program readBinary(std::string filename);
-        cl::Program buildProgramFromBinary(std::string filename, std::string buildOptions);
+        cl::Program buildProgramFromCache(std::string filename, std::string buildOptions);
+        std::string readSourceCode(std::string filename);
         cl::Program buildSources(cl::Program::Sources source, std::string buildOptions);
 
         cl::Context context;
@@ -117,6 +131,7 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
 
         bool profilingEnabled;
         RuntimeMeasurementsManager::pointer runtimeManager;
+        OpenCLMemoryPool::pointer m_memoryPool;
 
 };
 
@@ -0,0 +1,261 @@
+#include "HDF5StreamExporter.hpp"
+#include <FAST/Data/Image.hpp>
+#include <FAST/Data/Tensor.hpp>
+#include "HDF5Utility.hpp"
+
+namespace fast {
+
+void HDF5StreamExporter::setFilename(std::string filename) {
+    m_filename = filename;
+    setModified(true);
+}
+
+void HDF5StreamExporter::setDatasetName(std::string name) {
+    m_datasetName = name;
+    setModified(true);
+}
+
+void HDF5StreamExporter::setCompression(HDF5Compression compression, int level) {
+    if(level < 0 || level > 9)
+        throw Exception("Compression level in HDF5StreamExporter must be between 0 and 9");
+    m_compression = compression;
+    m_compressionLevel = level;
+    setModified(true);
+}
+
+void HDF5StreamExporter::setMaximumQueueSize(int frames) {
+    if(frames <= 0)
+        throw Exception("Maximum queue size in HDF5StreamExporter must be larger than 0");
+    m_maximumQueueSize = frames;
+}
+
+void HDF5StreamExporter::loadAttributes() {
+    setFilename(getStringAttribute("filename"));
+    setDatasetName(getStringAttribute("name"));
+    const std::string compression = getStringAttribute("compression");
+    if(compression == "none") {
+        setCompression(HDF5_COMPRESSION_NONE);
+    } else if(compression == "gzip") {
+        setCompression(HDF5_COMPRESSION_GZIP, getIntegerAttribute("compression-level"));
+    } else if(compression == "lzf") {
+        setCompression(HDF5_COMPRESSION_LZF);
+    } else if(compression == "blosc") {
+        setCompression(HDF5_COMPRESSION_BLOSC, getIntegerAttribute("compression-level"));
+    } else {
+        throw Exception("Unknown compression " + compression + " given to HDF5StreamExporter");
+    }
+    setMaximumQueueSize(getIntegerAttribute("queue-size"));
+}
+
+HDF5StreamExporter::HDF5StreamExporter() {
+    createInputPort<DataObject>(0);
+    createOutputPort<DataObject>(0);
+
+    createStringAttribute("filename", "Filename", "Path to file to record to", "");
+    createStringAttribute("name", "Dataset name", "Name of dataset to store frames in", m_datasetName);
+    createStringAttribute("compression", "Compression", "Compression of frames: none, gzip, lzf or blosc", "none");
+    createIntegerAttribute("compression-level", "Compression level", "Compression level for gzip and blosc", m_compressionLevel);
+    createIntegerAttribute("queue-size", "Queue size", "Max nr of frames waiting to be written", m_maximumQueueSize);
+}
+
+void HDF5StreamExporter::execute() {
+    if(m_filename.empty())
+        throw Exception("HDF5StreamExporter needs a filename to be set.");
+
+    auto input = getInputData<DataObject>();
+    if(!std::dynamic_pointer_cast<Image>(input) && !std::dynamic_pointer_cast<Tensor>(input))
+        throw Exception("HDF5StreamExporter can only record Image and Tensor data objects");
+
+    {
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        if(m_error)
+            std::rethrow_exception(m_error);
+        if(!m_writerThread) {
+            m_stopWriting = false;
+            m_framesWritten = 0;
+            m_writerThread = std::make_unique<std::thread>(std::bind(&HDF5StreamExporter::writeFrames, this));
+        }
+        // Only block if the writer thread is too far behind
+        m_queueCondition.wait(lock, [this]() { return m_error || m_queue.size() < m_maximumQueueSize; });
+        if(m_error)
+            std::rethrow_exception(m_error);
+        m_queue.push_back(input);
+    }
+    m_queueCondition.notify_all();
+
+    if(input->isLastFrame())
+        finish();
+    addOutputData(0, input);
+}
+
+namespace {
+
+/**
+ * Size and type of the frames of a recording, given by the first frame
+ */
+struct FrameLayout {
+    std::string object;
+    DataType type;
+    std::vector<hsize_t> shape;
+};
+
+}
+
+static FrameLayout getFrameLayout(DataObject::pointer frame) {
+    FrameLayout layout;
+    if(auto image = std::dynamic_pointer_cast<Image>(frame)) {
+        layout.object = "image";
+        layout.type = image->getDataType();
+        if(image->getDimensions() == 3)
+            layout.shape.push_back(image->getDepth());
+        layout.shape.push_back(image->getHeight());
+        layout.shape.push_back(image->getWidth());
+        layout.shape.push_back(image->getNrOfChannels());
+    } else {
+        auto tensor = std::static_pointer_cast<Tensor>(frame);
+        layout.object = "tensor";
+        layout.type = TYPE_FLOAT;
+        auto shape = tensor->getShape();
+        if(shape.getUnknownDimensions() > 0)
+            throw Exception("Tensor has unknown dimensions");
+        for(int size : shape.getAll())
+            layout.shape.push_back(size);
+    }
+    return layout;
+}
+
+static std::string serializeFrameData(DataObject::pointer frame) {
+    std::string result;
+    for(auto&& item : frame->getFrameData())
+        result += item.first + "\t" + item.second + "\n";
+    return result;
+}
+
+void HDF5StreamExporter::writeFrames() {
+    std::unique_ptr<H5::H5File> file;
+    H5::DataSet frames, timestamps, frameData;
+    H5::StrType stringType(H5::PredType::C_S1, H5T_VARIABLE);
+    FrameLayout layout;
+    uint64_t frameNr = 0;
+    while(true) {
+        DataObject::pointer frame;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCondition.wait(lock, [this]() { return m_stopWriting || !m_queue.empty(); });
+            if(m_queue.empty())
+                break;
+            frame = m_queue.front();
+            if(m_error) {
+                // Discard frames after an error, it is reported by execute and finish
+                m_queue.pop_front();
+                m_queueCondition.notify_all();
+                continue;
+            }
+        }
+
+        try {
+            if(!file) {
+                layout = getFrameLayout(frame);
+                file = std::make_unique<H5::H5File>(m_filename.c_str(), H5F_ACC_TRUNC);
+
+                H5::DSetCreatPropList properties;
+                if(m_compression == HDF5_COMPRESSION_GZIP) {
+                    properties.setShuffle();
+                    properties.setDeflate(m_compressionLevel);
+                } else if(m_compression == HDF5_COMPRESSION_LZF || m_compression == HDF5_COMPRESSION_BLOSC) {
+                    const H5Z_filter_t filter = m_compression == HDF5_COMPRESSION_LZF ? 32000 : 32001;
+                    if(H5Zfilter_avail(filter) <= 0)
+                        throw Exception("The " + std::string(m_compression == HDF5_COMPRESSION_LZF ? "LZF" : "Blosc") +
+                                        " HDF5 filter plugin is not available. Check HDF5_PLUGIN_PATH.");
+                    // The first 4 values are set by the blosc filter, then compression level, shuffle and compressor (blosclz)
+                    const unsigned int bloscOptions[] = {0, 0, 0, 0, (unsigned int)m_compressionLevel, 1, 0};
+                    if(m_compression == HDF5_COMPRESSION_LZF) {
+                        properties.setFilter(filter, H5Z_FLAG_MANDATORY);
+                    } else {
+                        properties.setFilter(filter, H5Z_FLAG_MANDATORY, 7, bloscOptions);
+                    }
+                }
+                frames = createExtensibleDataset(*file, m_datasetName, getHDF5Type(layout.type), layout.shape, properties);
+                timestamps = createExtensibleDataset(*file, m_datasetName + "_timestamps", H5::PredType::NATIVE_UINT64, {}, H5::DSetCreatPropList());
+                frameData = createExtensibleDataset(*file, m_datasetName + "_framedata", stringType, {}, H5::DSetCreatPropList());
+
+                // Store what kind of data object this is, so that it can be recreated
+                H5::DataSpace scalar(H5S_SCALAR);
+                frames.createAttribute("fast-object", stringType, scalar).write(stringType, layout.object);
+                const int type = layout.type;
+                frames.createAttribute("fast-data-type", H5::PredType::NATIVE_INT, scalar).write(H5::PredType::NATIVE_INT, &type);
+                if(auto image = std::dynamic_pointer_cast<Image>(frame)) {
+                    hsize_t three = 3;
+                    H5::DataSpace vector(1, &three);
+                    Vector3f spacing = image->getSpacing();
+                    frames.createAttribute("spacing", H5::PredType::NATIVE_FLOAT, vector).write(H5::PredType::NATIVE_FLOAT, spacing.data());
+                }
+            }
+
+            FrameLayout frameLayout = getFrameLayout(frame);
+            if(frameLayout.object != layout.object || frameLayout.type != layout.type || frameLayout.shape != layout.shape)
+                throw Exception("All frames recorded by HDF5StreamExporter must have the same size and type");
+            if(auto image = std::dynamic_pointer_cast<Image>(frame)) {
+                auto access = image->getImageAccess(ACCESS_READ);
+                appendToDataset(frames, frameNr, access->get(), getHDF5Type(layout.type));
+            } else {
+                auto access = std::static_pointer_cast<Tensor>(frame)->getAccess(ACCESS_READ);
+                appendToDataset(frames, frameNr, access->getRawData(), H5::PredType::NATIVE_FLOAT);
+            }
+            const uint64_t timestamp = frame->getCreationTimestamp();
+            appendToDataset(timestamps, frameNr, &timestamp, H5::PredType::NATIVE_UINT64);
+            const std::string data = serializeFrameData(frame);
+            const char* dataString = data.c_str();
+            appendToDataset(frameData, frameNr, &dataString, stringType);
+            ++frameNr;
+        } catch(H5::Exception& e) {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_error = std::make_exception_ptr(Exception("HDF5StreamExporter failed to write to " + m_filename + ": " + e.getDetailMsg()));
+        } catch(...) {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_queue.pop_front();
+            m_framesWritten = frameNr;
+        }
+        m_queueCondition.notify_all();
+    }
+    if(file)
+        file->close();
+}
+
+void HDF5StreamExporter::finish() {
+    if(!m_writerThread)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopWriting = true;
+    }
+    m_queueCondition.notify_all();
+    m_writerThread->join();
+    m_writerThread.reset();
+    reportInfo() << "HDF5StreamExporter wrote " << m_framesWritten << " frames to " << m_filename << reportEnd();
+    if(m_error) {
+        auto error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+uint64_t HDF5StreamExporter::getNrOfFramesWritten() {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return m_framesWritten;
+}
+
+HDF5StreamExporter::~HDF5StreamExporter() {
+    try {
+        finish();
+    } catch(Exception& e) {
+        reportError() << e.what() << reportEnd();
+    }
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <FAST/ProcessObject.hpp>
+#include <thread>
+#include <deque>
+#include <condition_variable>
+
+namespace fast {
+
+enum HDF5Compression {
+    HDF5_COMPRESSION_NONE,
+    HDF5_COMPRESSION_GZIP,
+    HDF5_COMPRESSION_LZF, // Requires the LZF filter plugin (HDF5 filter 32000)
+    HDF5_COMPRESSION_BLOSC // Requires the Blosc filter plugin (HDF5 filter 32001)
+};
+
+/**
+ * Record a stream of images or tensors to a HDF5 file.
+ *
+ * Every frame is appended to an extensible, chunked dataset, where the first dimension is the frame nr
+ * and each chunk is one frame. Images are stored as height x width x channels, or depth x height x width x channels.
+ * The creation timestamp and frame data of each frame are stored in the datasets <name>_timestamps and <name>_framedata.
+ *
+ * Frames are written to disk on a background thread. Thus execute only blocks if the queue of frames waiting to be
+ * written is full. The input is passed on to the output port. The file is closed when the last frame of the stream
+ * has been written or finish is called. Use HDF5Streamer to play back a recording.
+ */
+class FAST_EXPORT HDF5StreamExporter : public ProcessObject {
+    FAST_OBJECT(HDF5StreamExporter)
+    public:
+        void setFilename(std::string filename);
+        void setDatasetName(std::string name);
+        /**
+         * Set compression of the frames. Default is no compression.
+         * @param compression
+         * @param level Compression level (0-9) for gzip and blosc
+         */
+        void setCompression(HDF5Compression compression, int level = 4);
+        /**
+         * Set max nr of frames waiting to be written before execute blocks. Default is 64.
+         */
+        void setMaximumQueueSize(int frames);
+        /**
+         * Block until all frames in the queue are written, and close the file.
+         * The next frame will start a new recording.
+         */
+        void finish();
+        /**
+         * @return nr of frames written to file in the current recording
+         */
+        uint64_t getNrOfFramesWritten();
+        void loadAttributes() override;
+        ~HDF5StreamExporter();
+    private:
+        HDF5StreamExporter();
+        void execute() override;
+        void writeFrames();
+
+        std::string m_filename = "";
+        std::string m_datasetName = "frames";
+        HDF5Compression m_compression = HDF5_COMPRESSION_NONE;
+        int m_compressionLevel = 4;
+        int m_maximumQueueSize = 64;
+
+        std::unique_ptr<std::thread> m_writerThread;
+        std::deque<DataObject::pointer> m_queue;
+        std::mutex m_queueMutex;
+        std::condition_variable m_queueCondition;
+        bool m_stopWriting = false;
+        uint64_t m_framesWritten = 0;
+        std::exception_ptr m_error;
+};
+
+}
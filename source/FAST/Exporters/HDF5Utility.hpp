@@ -0,0 +1,92 @@
+#pragma once
+
+#include <FAST/Data/DataTypes.hpp>
+#include <FAST/Exception.hpp>
+#define H5_BUILT_AS_DYNAMIC_LIB
+#include <H5Cpp.h>
+#include <vector>
+
+/**
+ * @file
+ * Internal helpers for the HDF5 stream format shared by HDF5StreamExporter and HDF5Streamer.
+ * Each dataset stores one element per frame, with the frame nr as the first dimension.
+ */
+
+namespace fast {
+
+inline H5::PredType getHDF5Type(DataType type) {
+    switch(type) {
+        case TYPE_FLOAT:
+            return H5::PredType::NATIVE_FLOAT;
+        case TYPE_UINT8:
+            return H5::PredType::NATIVE_UINT8;
+        case TYPE_INT8:
+            return H5::PredType::NATIVE_INT8;
+        case TYPE_UINT16:
+        case TYPE_UNORM_INT16:
+            return H5::PredType::NATIVE_UINT16;
+        case TYPE_INT16:
+        case TYPE_SNORM_INT16:
+            return H5::PredType::NATIVE_INT16;
+        default:
+            throw Exception("Unsupported data type in HDF5 stream");
+    }
+}
+
+/**
+ * Create a dataset with zero frames which can be extended by appendToDataset
+ */
+inline H5::DataSet createExtensibleDataset(H5::H5File& file, std::string name, const H5::DataType& type, std::vector<hsize_t> shape, H5::DSetCreatPropList properties) {
+    std::vector<hsize_t> size = {0};
+    std::vector<hsize_t> maxSize = {H5S_UNLIMITED};
+    std::vector<hsize_t> chunk = {1};
+    for(auto dimension : shape) {
+        size.push_back(dimension);
+        maxSize.push_back(dimension);
+        chunk.push_back(dimension);
+    }
+    if(shape.empty()) // Scalars are stored in chunks of many frames
+        chunk[0] = 1024;
+    properties.setChunk(chunk.size(), chunk.data());
+    H5::DataSpace space(size.size(), size.data(), maxSize.data());
+    return file.createDataSet(name.c_str(), type, space, properties);
+}
+
+/**
+ * Append frame nr frameNr to a dataset
+ */
+inline void appendToDataset(H5::DataSet& dataset, hsize_t frameNr, const void* data, const H5::DataType& type) {
+    H5::DataSpace fileSpace = dataset.getSpace();
+    const int rank = fileSpace.getSimpleExtentNdims();
+    std::vector<hsize_t> size(rank);
+    fileSpace.getSimpleExtentDims(size.data());
+    size[0] = frameNr + 1;
+    dataset.extend(size.data());
+
+    fileSpace = dataset.getSpace();
+    std::vector<hsize_t> offset(rank, 0);
+    offset[0] = frameNr;
+    std::vector<hsize_t> count = size;
+    count[0] = 1;
+    fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
+    H5::DataSpace memorySpace(rank, count.data());
+    dataset.write(data, type, memorySpace, fileSpace);
+}
+
+/**
+ * Read frame nr frameNr of a dataset
+ */
+inline void readFromDataset(H5::DataSet& dataset, hsize_t frameNr, void* data, const H5::DataType& type) {
+    H5::DataSpace fileSpace = dataset.getSpace();
+    const int rank = fileSpace.getSimpleExtentNdims();
+    std::vector<hsize_t> count(rank);
+    fileSpace.getSimpleExtentDims(count.data());
+    count[0] = 1;
+    std::vector<hsize_t> offset(rank, 0);
+    offset[0] = frameNr;
+    fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
+    H5::DataSpace memorySpace(rank, count.data());
+    dataset.read(data, type, memorySpace, fileSpace);
+}
+
+}
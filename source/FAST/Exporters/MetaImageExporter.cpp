@@ -15,10 +15,11 @@ MetaImageExporter::MetaImageExporter() {
     mFilename = "";
     mIsModified = true;
     mUseCompression = false;
+    mCompressionLevel = Z_DEFAULT_COMPRESSION;
 }
 
 template <class T>
-inline std::size_t writeToRawFile(std::string filename, T * data, unsigned int numberOfElements, bool useCompression) {
+inline std::size_t writeToRawFile(std::string filename, T * data, unsigned int numberOfElements, bool useCompression, int compressionLevel) {
     // TODO use mapped_file_sink form boost instead
     FILE* file = fopen(filename.c_str(), "wb");
     if(file == NULL) {
@@ -30,11 +31,12 @@ inline std::size_t writeToRawFile(std::string filename, T * data, unsigned int n
         std::size_t sizeDataCompressed = compressBound(sizeof(T)*numberOfElements);
         std::size_t sizeDataOriginal = sizeof(T)*numberOfElements;
         Bytef* writeData = (Bytef*)malloc(sizeDataCompressed);
-        int z_result = compress(
+        int z_result = compress2(
                 (Bytef*)writeData,
                 (uLongf*)&sizeDataCompressed,
                 (Bytef*)data,
-                sizeDataOriginal
+                sizeDataOriginal,
+                compressionLevel
         );
         switch(z_result) {
         case Z_OK:
@@ -122,23 +124,23 @@ void MetaImageExporter::execute() {
     switch(input->getDataType()) {
     case TYPE_FLOAT:
         mhdFile << "ElementType = MET_FLOAT\n";
-        compressedSize = writeToRawFile<float>(rawFilename,(float*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<float>(rawFilename,(float*)data,numberOfElements,mUseCompression,mCompressionLevel);
         break;
     case TYPE_UINT8:
         mhdFile << "ElementType = MET_UCHAR\n";
-        compressedSize = writeToRawFile<uchar>(rawFilename,(uchar*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<uchar>(rawFilename,(uchar*)data,numberOfElements,mUseCompression,mCompressionLevel);
         break;
     case TYPE_INT8:
         mhdFile << "ElementType = MET_CHAR\n";
-        compressedSize = writeToRawFile<char>(rawFilename,(char*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<char>(rawFilename,(char*)data,numberOfElements,mUseCompression,mCompressionLevel);
         break;
     case TYPE_UINT16:
         mhdFile << "ElementType = MET_USHORT\n";
-        compressedSize = writeToRawFile<ushort>(rawFilename,(ushort*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<ushort>(rawFilename,(ushort*)data,numberOfElements,mUseCompression,mCompressionLevel);
         break;
     case TYPE_INT16:
         mhdFile << "ElementType = MET_SHORT\n";
-        compressedSize = writeToRawFile<short>(rawFilename,(short*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<short>(rawFilename,(short*)data,numberOfElements,mUseCompression,mCompressionLevel);
         break;
     }
 
@@ -182,6 +184,13 @@ void MetaImageExporter::setCompression(bool compress) {
     mIsModified = true;
 }
 
+void MetaImageExporter::setCompressionLevel(int level) {
+    if(level < -1 || level > 9)
+        throw Exception("Compression level in MetaImageExporter must be between 0 and 9, or -1 for default");
+    mCompressionLevel = level;
+    mIsModified = true;
+}
+
 void MetaImageExporter::setMetadata(std::string key, std::string value) {
     mMetadata[key] = value;
 }
@@ -15,6 +15,13 @@ class FAST_EXPORT MetaImageExporter : public ProcessObject {
          * @param compress
          */
         void setCompression(bool compress);
+        /**
+         * Set zlib compression level used when compression is enabled.
+         * 1 is fastest, 9 gives the smallest files, and -1 (default) is the zlib default level.
+         *
+         * @param level
+         */
+        void setCompressionLevel(int level);
         /**
          * Deprecated
          */
@@ -38,6 +45,7 @@ class FAST_EXPORT MetaImageExporter : public ProcessObject {
         std::string mFilename;
         std::map<std::string, std::string> mMetadata;
         bool mUseCompression;
+        int mCompressionLevel;
 };
 
 } // end namespace fast
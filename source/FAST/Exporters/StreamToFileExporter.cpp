@@ -30,10 +30,48 @@ void StreamToFileExporter::setFrameLimit(uint64_t limit) {
     m_frameLimit = limit;
 }
 
+void StreamToFileExporter::setCompressionLevel(int level) {
+    if(level < 0 || level > 9)
+        throw Exception("Compression level in StreamToFileExporter must be between 0 and 9");
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_compressionLevel = level;
+}
+
+void StreamToFileExporter::setNumberOfThreads(int threads) {
+    if(threads < 1)
+        throw Exception("Nr of threads in StreamToFileExporter must be at least 1");
+    // Takes effect when the writer threads are started again
+    finish();
+    m_nrOfThreads = threads;
+}
+
+void StreamToFileExporter::setMaximumQueueSize(int frames) {
+    if(frames < 1)
+        throw Exception("Maximum queue size in StreamToFileExporter must be at least 1");
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_maximumQueueSize = frames;
+    }
+    m_queueCondition.notify_all();
+}
+
+void StreamToFileExporter::setDropFramesWhenFull(bool drop) {
+    m_dropFramesWhenFull = drop;
+}
+
 uint64_t StreamToFileExporter::getFrameCounter() const {
     return m_frameCounter;
 }
 
+uint64_t StreamToFileExporter::getNrOfDroppedFrames() const {
+    return m_droppedFrames;
+}
+
+int StreamToFileExporter::getQueueSize() {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return m_queue.size();
+}
+
 void StreamToFileExporter::execute() {
     // Get data object
     auto input = getInputData<DataObject>();
@@ -43,6 +81,8 @@ void StreamToFileExporter::execute() {
         addOutputData(0, input);
         return;
     }
+    if(!std::dynamic_pointer_cast<Image>(input) && !std::dynamic_pointer_cast<Mesh>(input))
+        throw Exception("StreamToFileExporter can only handle Image and Mesh data objects");
     if(!m_hasStarted) {
         m_currentFolder = m_folder;
         // Use timestamp to create folder if one is not already set
@@ -58,34 +98,155 @@ void StreamToFileExporter::execute() {
     if(m_frameCounter >= m_frameLimit)
         throw Exception("Maximum nr of frames (" + std::to_string(m_frameLimit) + ") reached in StreamToFileExporter");
 
-    std::string currentFileName = join(m_path, m_currentFolder, m_filename + "_" + std::to_string(m_frameCounter));
-    if(auto imageInput = std::dynamic_pointer_cast<Image>(input)) {
-        auto exporter = MetaImageExporter::New();
-        exporter->enableCompression();
-        exporter->setFilename(currentFileName + ".mhd");
-        exporter->setInputData(input);
-        exporter->update();
-    } else if(auto meshInput = std::dynamic_pointer_cast<Mesh>(input)) {
-        auto exporter = VTKMeshFileExporter::New();
-        exporter->setFilename(currentFileName + ".vtk");
-        exporter->setInputData(input);
-        exporter->update();
-    } else {
-        throw Exception("StreamToFileExporter can only handle Image and Mesh data objects");
+    bool dropped = false;
+    int queueSize;
+    std::vector<double> writeTimes;
+    {
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        if(m_error)
+            std::rethrow_exception(m_error);
+        if(m_writerThreads.empty()) {
+            m_stopWriting = false;
+            for(int i = 0; i < m_nrOfThreads; ++i)
+                m_writerThreads.emplace_back(std::bind(&StreamToFileExporter::writeFrames, this));
+        }
+        queueSize = m_queue.size();
+        if(m_dropFramesWhenFull) {
+            dropped = m_queue.size() >= m_maximumQueueSize;
+        } else {
+            // Only block if the writer threads are too far behind
+            m_queueCondition.wait(lock, [this]() { return m_error || m_queue.size() < m_maximumQueueSize; });
+            if(m_error)
+                std::rethrow_exception(m_error);
+        }
+        if(!dropped) {
+            std::string filename = join(m_path, m_currentFolder, m_filename + "_" + std::to_string(m_frameCounter));
+            m_queue.push_back({input, filename});
+            m_frameCounter += 1;
+        }
+        std::swap(writeTimes, m_writeTimes);
     }
-    m_frameCounter += 1;
+    m_queueCondition.notify_all();
+
+    if(dropped) {
+        m_droppedFrames += 1;
+        reportWarning() << "Write queue of StreamToFileExporter is full, dropped frame" << reportEnd();
+    }
+    // The runtime manager is only used from this thread, thus samples from the writer threads are added here
+    mRuntimeManager->addSample("queue size", queueSize);
+    mRuntimeManager->addSample("dropped frames", dropped ? 1 : 0);
+    for(double time : writeTimes)
+        mRuntimeManager->addSample("write", time);
+
+    if(input->isLastFrame())
+        finish();
     addOutputData(0, input);
 }
 
+void StreamToFileExporter::writeFrames() {
+    while(true) {
+        Frame frame;
+        int compressionLevel;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCondition.wait(lock, [this]() { return m_stopWriting || !m_queue.empty(); });
+            if(m_queue.empty() || m_error) // Stopped and all frames are written, or another writer failed
+                return;
+            frame = m_queue.front();
+            m_queue.pop_front();
+            compressionLevel = m_compressionLevel;
+        }
+        m_queueCondition.notify_all();
+
+        try {
+            auto start = std::chrono::high_resolution_clock::now();
+            if(std::dynamic_pointer_cast<Image>(frame.data)) {
+                auto exporter = MetaImageExporter::New();
+                exporter->setCompression(compressionLevel > 0);
+                if(compressionLevel > 0)
+                    exporter->setCompressionLevel(compressionLevel);
+                exporter->setFilename(frame.filename + ".mhd");
+                exporter->setInputData(frame.data);
+                exporter->update();
+            } else {
+                auto exporter = VTKMeshFileExporter::New();
+                exporter->setFilename(frame.filename + ".vtk");
+                exporter->setInputData(frame.data);
+                exporter->update();
+            }
+            std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_writeTimes.push_back(time.count());
+        } catch(...) {
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                if(!m_error)
+                    m_error = std::current_exception();
+            }
+            m_queueCondition.notify_all();
+            return;
+        }
+    }
+}
+
+void StreamToFileExporter::stopWriters() {
+    if(m_writerThreads.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopWriting = true;
+    }
+    m_queueCondition.notify_all();
+    for(auto& thread : m_writerThreads)
+        thread.join();
+    m_writerThreads.clear();
+    // Remove frames left in the queue if a writer failed
+    m_queue.clear();
+}
+
+void StreamToFileExporter::finish() {
+    stopWriters();
+    for(double time : m_writeTimes)
+        mRuntimeManager->addSample("write", time);
+    m_writeTimes.clear();
+    if(m_error) {
+        auto error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
 void StreamToFileExporter::reset() {
+    finish();
     m_frameCounter = 0;
+    m_droppedFrames = 0;
     m_currentFolder = "";
     m_hasStarted = false;
 }
 
+void StreamToFileExporter::loadAttributes() {
+    setCompressionLevel(getIntegerAttribute("compression-level"));
+    setNumberOfThreads(getIntegerAttribute("threads"));
+    setMaximumQueueSize(getIntegerAttribute("queue-size"));
+    setDropFramesWhenFull(getBooleanAttribute("drop-frames"));
+}
+
 StreamToFileExporter::StreamToFileExporter() {
     createInputPort<DataObject>(0);
     createOutputPort<DataObject>(0);
+
+    createIntegerAttribute("compression-level", "Compression level", "Compression level of images, 0 to disable compression, 1 is fastest, 9 gives smallest files", m_compressionLevel);
+    createIntegerAttribute("threads", "Threads", "Nr of threads writing frames", m_nrOfThreads);
+    createIntegerAttribute("queue-size", "Queue size", "Max nr of frames waiting to be written", m_maximumQueueSize);
+    createBooleanAttribute("drop-frames", "Drop frames", "Drop frames when the queue is full instead of blocking", m_dropFramesWhenFull);
+}
+
+StreamToFileExporter::~StreamToFileExporter() {
+    try {
+        finish();
+    } catch(Exception& e) {
+        reportError() << e.what() << reportEnd();
+    }
 }
 
 bool StreamToFileExporter::isEnabled() {
@@ -104,4 +265,4 @@ float StreamToFileExporter::getRecordingDuration() const {
     return (float)duration.count();
 }
 
-}
\ No newline at end of file
+}
@@ -2,9 +2,22 @@
 
 #include <FAST/ProcessObject.hpp>
 #include <chrono>
+#include <thread>
+#include <deque>
+#include <condition_variable>
 
 namespace fast {
 
+/**
+ * Write a stream of images (metaimage) or meshes (VTK) to a folder, one file per frame.
+ *
+ * Frames are written and compressed by a pool of background writer threads, so that execute only blocks
+ * if the queue of frames waiting to be written is full. If dropping of frames is enabled, frames which arrive
+ * when the queue is full are not written instead. The input is always passed on to the output port.
+ *
+ * When runtime measurements are enabled, the queue size at every frame ("queue size"), whether a frame was dropped
+ * ("dropped frames", 1 or 0) and the time used to write each frame ("write") are recorded. Use getRuntime(name) to get them.
+ */
 class FAST_EXPORT StreamToFileExporter : public ProcessObject {
     FAST_OBJECT(StreamToFileExporter)
     public:
@@ -13,14 +26,47 @@ class FAST_EXPORT StreamToFileExporter : public ProcessObject {
         void setFrameFilename(std::string name);
         void setEnabled(bool enabled);
         void setFrameLimit(uint64_t limit);
+        /**
+         * Set compression level of images. 0 disables compression, 1 is the fastest and 9 gives the smallest files.
+         * Default is 6.
+         */
+        void setCompressionLevel(int level);
+        /**
+         * Set nr of threads writing frames to disk. Default is 2.
+         */
+        void setNumberOfThreads(int threads);
+        /**
+         * Set max nr of frames waiting to be written. Default is 64.
+         */
+        void setMaximumQueueSize(int frames);
+        /**
+         * If enabled, frames which arrive when the queue is full are dropped instead of blocking execute.
+         * Default is false.
+         */
+        void setDropFramesWhenFull(bool drop);
+        /**
+         * Block until all frames in the queue have been written to disk.
+         */
+        void finish();
         uint64_t getFrameCounter() const;
+        uint64_t getNrOfDroppedFrames() const;
+        int getQueueSize();
         std::string getCurrentDestinationFolder() const;
         float getRecordingDuration() const;
         void reset();
         bool isEnabled();
+        void loadAttributes() override;
+        ~StreamToFileExporter();
     private:
         StreamToFileExporter();
         void execute() override;
+        void writeFrames();
+        void stopWriters();
+
+        struct Frame {
+            DataObject::pointer data;
+            std::string filename;
+        };
 
         std::string m_path = "";
         std::string m_folder;
@@ -28,9 +74,22 @@ class FAST_EXPORT StreamToFileExporter : public ProcessObject {
         std::string m_currentFolder;
         uint64_t m_frameCounter = 0;
         uint64_t m_frameLimit = 10000;
+        uint64_t m_droppedFrames = 0;
         std::chrono::high_resolution_clock::time_point m_recordingStartTime;
         bool m_enabled = true;
         bool m_hasStarted = false;
+        int m_compressionLevel = 6;
+        int m_nrOfThreads = 2;
+        int m_maximumQueueSize = 64;
+        bool m_dropFramesWhenFull = false;
+
+        std::vector<std::thread> m_writerThreads;
+        std::deque<Frame> m_queue;
+        std::mutex m_queueMutex;
+        std::condition_variable m_queueCondition;
+        bool m_stopWriting = false;
+        std::vector<double> m_writeTimes;
+        std::exception_ptr m_error;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,110 @@
+#include <FAST/Testing.hpp>
+#include <FAST/Exporters/HDF5StreamExporter.hpp>
+#include <FAST/Streamers/HDF5Streamer.hpp>
+#include <FAST/Data/Image.hpp>
+#include <FAST/Data/Tensor.hpp>
+
+namespace fast {
+
+TEST_CASE("Record image stream as HDF5 and play it back", "[fast][HDF5StreamExporter][HDF5Streamer][HDF5]") {
+    const int frames = 20;
+    for(auto compression : {HDF5_COMPRESSION_NONE, HDF5_COMPRESSION_GZIP}) {
+        auto exporter = HDF5StreamExporter::New();
+        exporter->setFilename("image_stream.hd5");
+        exporter->setCompression(compression);
+        exporter->setMaximumQueueSize(4);
+        for(int i = 0; i < frames; ++i) {
+            auto image = Image::New();
+            image->create(64, 32, TYPE_UINT16, 2);
+            image->fill(i*100);
+            image->setSpacing(Vector3f(0.5f, 0.25f, 1.0f));
+            image->setCreationTimestamp(1000 + i);
+            image->setFrameData("frame-nr", std::to_string(i));
+            if(i == frames - 1)
+                image->setLastFrame("test");
+            exporter->setInputData(image);
+            exporter->update();
+        }
+        // The last frame closes the file
+        CHECK(exporter->getNrOfFramesWritten() == frames);
+
+        auto streamer = HDF5Streamer::New();
+        streamer->setFilename("image_stream.hd5");
+        auto port = streamer->getOutputPort();
+        int frameNr = 0;
+        Image::pointer image;
+        do {
+            streamer->update();
+            image = port->getNextFrame<Image>();
+            CHECK(image->getWidth() == 64);
+            CHECK(image->getHeight() == 32);
+            CHECK(image->getNrOfChannels() == 2);
+            CHECK(image->getDataType() == TYPE_UINT16);
+            CHECK(image->getSpacing().y() == Approx(0.25f));
+            CHECK(image->getCreationTimestamp() == 1000 + frameNr);
+            CHECK(image->getFrameData("frame-nr") == std::to_string(frameNr));
+            auto access = image->getImageAccess(ACCESS_READ);
+            CHECK(access->getScalar(Vector2i(63, 31), 1) == frameNr*100);
+            ++frameNr;
+        } while(!image->isLastFrame());
+        CHECK(frameNr == frames);
+    }
+}
+
+TEST_CASE("Record tensor stream as HDF5 and play it back", "[fast][HDF5StreamExporter][HDF5Streamer][HDF5]") {
+    auto exporter = HDF5StreamExporter::New();
+    exporter->setFilename("tensor_stream.hd5");
+    for(int i = 0; i < 3; ++i) {
+        auto tensor = Tensor::New();
+        tensor->create({(float)i, 1.0f, 2.0f, 3.0f});
+        exporter->setInputData(tensor);
+        exporter->update();
+    }
+    exporter->finish();
+    CHECK(exporter->getNrOfFramesWritten() == 3);
+
+    auto streamer = HDF5Streamer::New();
+    streamer->setFilename("tensor_stream.hd5");
+    auto port = streamer->getOutputPort();
+    for(int i = 0; i < 3; ++i) {
+        streamer->update();
+        auto tensor = port->getNextFrame<Tensor>();
+        CHECK(tensor->getShape().getTotalSize() == 4);
+        auto access = tensor->getAccess(ACCESS_READ);
+        CHECK(access->getRawData()[0] == (float)i);
+        CHECK(access->getRawData()[3] == 3.0f);
+        CHECK(tensor->isLastFrame() == (i == 2));
+    }
+}
+
+TEST_CASE("HDF5StreamExporter requires frames of same size", "[fast][HDF5StreamExporter][HDF5]") {
+    auto exporter = HDF5StreamExporter::New();
+    exporter->setFilename("mismatch_stream.hd5");
+    auto image = Image::New();
+    image->create(16, 16, TYPE_UINT8, 1);
+    exporter->setInputData(image);
+    exporter->update();
+    auto image2 = Image::New();
+    image2->create(32, 16, TYPE_UINT8, 1);
+    exporter->setInputData(image2);
+    exporter->update();
+    CHECK_THROWS(exporter->finish());
+}
+
+TEST_CASE("HDF5Streamer reports read errors on every update", "[fast][HDF5Streamer][HDF5]") {
+    auto exporter = HDF5StreamExporter::New();
+    exporter->setFilename("error_stream.hd5");
+    auto tensor = Tensor::New();
+    tensor->create({1.0f, 2.0f});
+    exporter->setInputData(tensor);
+    exporter->update();
+    exporter->finish();
+
+    auto streamer = HDF5Streamer::New();
+    streamer->setFilename("error_stream.hd5");
+    streamer->setDatasetName("missing");
+    CHECK_THROWS(streamer->update());
+    CHECK_THROWS(streamer->update());
+}
+
+}
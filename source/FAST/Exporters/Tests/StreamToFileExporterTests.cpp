@@ -0,0 +1,71 @@
+#include <FAST/Testing.hpp>
+#include <FAST/Exporters/StreamToFileExporter.hpp>
+#include <FAST/Importers/MetaImageImporter.hpp>
+#include <FAST/Data/Image.hpp>
+
+namespace fast {
+
+TEST_CASE("StreamToFileExporter writes all frames with multiple threads", "[fast][StreamToFileExporter]") {
+    const int frames = 20;
+    for(int compressionLevel : {0, 1, 6}) {
+        const std::string folder = "StreamToFileExporterTest_" + std::to_string(compressionLevel);
+        auto exporter = StreamToFileExporter::New();
+        exporter->setPath(".");
+        exporter->setRecordingFolderName(folder);
+        exporter->setCompressionLevel(compressionLevel);
+        exporter->setNumberOfThreads(3);
+        exporter->setMaximumQueueSize(4);
+        for(int i = 0; i < frames; ++i) {
+            auto image = Image::New();
+            image->create(128, 64, TYPE_UINT8, 1);
+            image->fill(i);
+            if(i == frames - 1)
+                image->setLastFrame("test");
+            exporter->setInputData(image);
+            exporter->update();
+        }
+        // The last frame waits for all frames to be written
+        CHECK(exporter->getFrameCounter() == frames);
+        CHECK(exporter->getQueueSize() == 0);
+        CHECK(exporter->getNrOfDroppedFrames() == 0);
+
+        for(int i = 0; i < frames; ++i) {
+            auto importer = MetaImageImporter::New();
+            importer->setFilename(join(".", folder, "frame_" + std::to_string(i) + ".mhd"));
+            auto port = importer->getOutputPort();
+            importer->update();
+            auto image = port->getNextFrame<Image>();
+            CHECK(image->getWidth() == 128);
+            auto access = image->getImageAccess(ACCESS_READ);
+            CHECK(access->getScalar(Vector2i(127, 63)) == i);
+        }
+        CHECK(fileExists(join(".", folder, "frame_0" + std::string(compressionLevel > 0 ? ".zraw" : ".raw"))));
+    }
+}
+
+TEST_CASE("StreamToFileExporter drops frames when queue is full", "[fast][StreamToFileExporter]") {
+    const int frames = 50;
+    auto exporter = StreamToFileExporter::New();
+    exporter->enableRuntimeMeasurements();
+    exporter->setPath(".");
+    exporter->setRecordingFolderName("StreamToFileExporterDropTest");
+    exporter->setNumberOfThreads(1);
+    exporter->setMaximumQueueSize(1);
+    exporter->setDropFramesWhenFull(true);
+    exporter->setCompressionLevel(9);
+    for(int i = 0; i < frames; ++i) {
+        auto image = Image::New();
+        image->create(512, 512, TYPE_FLOAT, 1);
+        image->fill(i);
+        exporter->setInputData(image);
+        exporter->update();
+    }
+    exporter->finish();
+    CHECK(exporter->getFrameCounter() + exporter->getNrOfDroppedFrames() == frames);
+    CHECK(exporter->getRuntime("queue size")->getSamples() == frames);
+    CHECK(exporter->getRuntime("queue size")->getMax() <= 1);
+    CHECK(exporter->getRuntime("dropped frames")->getSum() == exporter->getNrOfDroppedFrames());
+    CHECK(exporter->getRuntime("write")->getSamples() == exporter->getFrameCounter());
+}
+
+}
@@ -66,7 +66,9 @@ void WholeSlideImageImporter::execute() {
             break;
         }
     }
-    image->create(file, levelList);
+    image->setTileCacheSize(m_tileCacheSize);
+    image->setNrOfTileReaderThreads(m_tileReaderThreads);
+    image->create(file, levelList, mFilename);
 }
 
 WholeSlideImageImporter::WholeSlideImageImporter() {
@@ -76,11 +78,15 @@ WholeSlideImageImporter::WholeSlideImageImporter() {
     createOutputPort<ImagePyramid>(0);
 
     createStringAttribute("filename", "Filename", "Filename to read", "");
+    createIntegerAttribute("tile-cache-size", "Tile cache size", "Max size in MB of decoded tiles to cache, 0 disables the cache", m_tileCacheSize/(1024*1024));
+    createIntegerAttribute("tile-reader-threads", "Tile reader threads", "Nr of threads decoding tiles for the cache, 0 means one per hardware thread up to 8", m_tileReaderThreads);
     //createBooleanAttribute("grayscale", "Grayscale", "Turn image into grayscale on import", mGrayscale);
 }
 
 void WholeSlideImageImporter::loadAttributes() {
     setFilename(getStringAttribute("filename"));
+    setTileCacheSize((std::size_t)getIntegerAttribute("tile-cache-size")*1024*1024);
+    setNrOfTileReaderThreads(getIntegerAttribute("tile-reader-threads"));
 }
 
 void WholeSlideImageImporter::setGrayscale(bool grayscale) {
@@ -88,6 +94,18 @@ void WholeSlideImageImporter::setGrayscale(bool grayscale) {
     mIsModified = true;
 }
 
+void WholeSlideImageImporter::setTileCacheSize(std::size_t bytes) {
+    m_tileCacheSize = bytes;
+    mIsModified = true;
+}
+
+void WholeSlideImageImporter::setNrOfTileReaderThreads(int threads) {
+    if(threads < 0)
+        throw Exception("Nr of tile reader threads in WholeSlideImageImporter can't be negative");
+    m_tileReaderThreads = threads;
+    mIsModified = true;
+}
+
 void WholeSlideImageImporter::setFilename(std::string filename) {
     mFilename = filename;
     mIsModified = true;
@@ -10,12 +10,24 @@ class FAST_EXPORT WholeSlideImageImporter : public ProcessObject {
         void setFilename(std::string filename);
         WholeSlideImageImporter();
         void setGrayscale(bool grayscale);
+        /**
+         * Set max nr of bytes of decoded tiles to cache for the imported image pyramid.
+         * Default is 256 MB, 0 disables the cache.
+         */
+        void setTileCacheSize(std::size_t bytes);
+        /**
+         * Set nr of threads decoding tiles for the tile cache of the imported image pyramid.
+         * Each thread opens the file. Default is 0, which means one per hardware thread, up to 8.
+         */
+        void setNrOfTileReaderThreads(int threads);
         void loadAttributes() override;
     private:
         void execute();
 
         std::string mFilename;
         bool mGrayscale;
+        std::size_t m_tileCacheSize = 256*1024*1024;
+        int m_tileReaderThreads = 0;
 };
 
 }
@@ -0,0 +1,189 @@
+#include "OpenCLMemoryPool.hpp"
+
+namespace fast {
+
+OpenCLMemoryPool::OpenCLMemoryPool(cl::Context context, RuntimeMeasurementsManager::pointer runtimeManager) {
+    m_context = context;
+    m_runtimeManager = runtimeManager;
+}
+
+OpenCLMemoryPool::~OpenCLMemoryPool() {
+    clear();
+}
+
+static void deleteObject(cl_mem_object_type type, cl::Memory* object) {
+    // Delete using the type the object was created with
+    if(type == CL_MEM_OBJECT_IMAGE2D) {
+        delete (cl::Image2D*)object;
+    } else if(type == CL_MEM_OBJECT_IMAGE3D) {
+        delete (cl::Image3D*)object;
+    } else {
+        delete (cl::Buffer*)object;
+    }
+}
+
+std::size_t OpenCLMemoryPool::getSize(const Key& key) {
+    if(std::get<0>(key) == CL_MEM_OBJECT_BUFFER)
+        return std::get<4>(key);
+
+    cl::ImageFormat format(std::get<2>(key), std::get<3>(key));
+    std::size_t channels = 1;
+    switch(format.image_channel_order) {
+        case CL_RG:
+            channels = 2;
+            break;
+        case CL_RGB:
+            channels = 3;
+            break;
+        case CL_RGBA:
+        case CL_BGRA:
+            channels = 4;
+            break;
+    }
+    std::size_t bytesPerChannel = 1;
+    switch(format.image_channel_data_type) {
+        case CL_UNSIGNED_INT16:
+        case CL_SIGNED_INT16:
+        case CL_UNORM_INT16:
+        case CL_SNORM_INT16:
+        case CL_HALF_FLOAT:
+            bytesPerChannel = 2;
+            break;
+        case CL_UNSIGNED_INT32:
+        case CL_SIGNED_INT32:
+        case CL_FLOAT:
+            bytesPerChannel = 4;
+            break;
+    }
+    return std::get<4>(key)*std::get<5>(key)*std::max<std::size_t>(std::get<6>(key), 1)*channels*bytesPerChannel;
+}
+
+cl::Memory* OpenCLMemoryPool::get(const Key& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_objects.find(key);
+    if(it == m_objects.end() || it->second.empty()) {
+        m_allocations += 1;
+        m_runtimeManager->addSample("memory pool allocation", 1);
+        return nullptr;
+    }
+    cl::Memory* object = it->second.back();
+    it->second.pop_back();
+    m_size -= getSize(key);
+    m_reuses += 1;
+    m_runtimeManager->addSample("memory pool allocation", 0);
+    return object;
+}
+
+cl::Image2D* OpenCLMemoryPool::getImage2D(cl_mem_flags flags, cl::ImageFormat format, unsigned int width, unsigned int height) {
+    Key key(CL_MEM_OBJECT_IMAGE2D, flags, format.image_channel_order, format.image_channel_data_type, width, height, 0);
+    cl::Memory* object = get(key);
+    if(object != nullptr)
+        return (cl::Image2D*)object;
+
+    return new cl::Image2D(m_context, flags, format, width, height);
+}
+
+cl::Image3D* OpenCLMemoryPool::getImage3D(cl_mem_flags flags, cl::ImageFormat format, unsigned int width, unsigned int height, unsigned int depth) {
+    Key key(CL_MEM_OBJECT_IMAGE3D, flags, format.image_channel_order, format.image_channel_data_type, width, height, depth);
+    cl::Memory* object = get(key);
+    if(object != nullptr)
+        return (cl::Image3D*)object;
+
+    return new cl::Image3D(m_context, flags, format, width, height, depth);
+}
+
+cl::Buffer* OpenCLMemoryPool::getBuffer(cl_mem_flags flags, std::size_t size) {
+    Key key(CL_MEM_OBJECT_BUFFER, flags, 0, 0, size, 0, 0);
+    cl::Memory* object = get(key);
+    if(object != nullptr)
+        return (cl::Buffer*)object;
+
+    return new cl::Buffer(m_context, flags, size);
+}
+
+void OpenCLMemoryPool::release(cl::Image* image) {
+    if(image == nullptr)
+        return;
+    const cl_mem_object_type type = image->getInfo<CL_MEM_TYPE>();
+    const cl_mem_flags flags = image->getInfo<CL_MEM_FLAGS>();
+    const cl_image_format format = image->getImageInfo<CL_IMAGE_FORMAT>();
+    Key key(type, flags, format.image_channel_order, format.image_channel_data_type,
+            image->getImageInfo<CL_IMAGE_WIDTH>(), image->getImageInfo<CL_IMAGE_HEIGHT>(),
+            type == CL_MEM_OBJECT_IMAGE3D ? image->getImageInfo<CL_IMAGE_DEPTH>() : 0);
+    release(key, image, getSize(key));
+}
+
+void OpenCLMemoryPool::release(cl::Buffer* buffer) {
+    if(buffer == nullptr)
+        return;
+    const std::size_t size = buffer->getInfo<CL_MEM_SIZE>();
+    Key key(CL_MEM_OBJECT_BUFFER, buffer->getInfo<CL_MEM_FLAGS>(), 0, 0, size, 0, 0);
+    release(key, buffer, size);
+}
+
+void OpenCLMemoryPool::release(const Key& key, cl::Memory* object, std::size_t size) {
+    // Objects using host memory can't be reused
+    if(std::get<1>(key) & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR)) {
+        deleteObject(std::get<0>(key), object);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_size + size <= m_maximumSize) {
+            // Commands using the object which are still in the in-order command queue will finish before
+            // commands enqueued by the next owner.
+            m_objects[key].push_back(object);
+            m_size += size;
+            object = nullptr;
+        }
+        m_runtimeManager->addSample("memory pool size", (double)m_size/(1024*1024));
+    }
+    // Pool is full
+    if(object != nullptr)
+        deleteObject(std::get<0>(key), object);
+}
+
+void OpenCLMemoryPool::setMaximumSize(std::size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maximumSize = bytes;
+        if(m_size <= m_maximumSize)
+            return;
+    }
+    clear();
+}
+
+std::size_t OpenCLMemoryPool::getMaximumSize() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maximumSize;
+}
+
+std::size_t OpenCLMemoryPool::getSize() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+uint64_t OpenCLMemoryPool::getNrOfAllocations() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocations;
+}
+
+uint64_t OpenCLMemoryPool::getNrOfReuses() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_reuses;
+}
+
+void OpenCLMemoryPool::clear() {
+    std::map<Key, std::vector<cl::Memory*>> objects;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(objects, m_objects);
+        m_size = 0;
+    }
+    for(auto&& item : objects) {
+        for(cl::Memory* object : item.second)
+            deleteObject(std::get<0>(item.first), object);
+    }
+}
+
+}
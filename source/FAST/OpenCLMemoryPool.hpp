@@ -0,0 +1,82 @@
+#pragma once
+
+#include "FAST/Object.hpp"
+#include "RuntimeMeasurementManager.hpp"
+#include <mutex>
+#include <tuple>
+
+namespace fast {
+
+/**
+ * Pool of OpenCL images and buffers on a single OpenCL device.
+ *
+ * When a data object is freed, its OpenCL images and buffers are released to the pool of the device, and reused
+ * by the next data object which requests an image or buffer with the same format, size and flags. This avoids
+ * allocating new device memory for every frame when streaming.
+ *
+ * The total size of the images and buffers kept in the pool is limited by a high-water mark. Objects which
+ * are released when the pool is full are deleted instead.
+ *
+ * When the runtime measurement manager of the device is enabled, the following statistics are recorded:
+ * "memory pool allocation" (1 for every new allocation and 0 for every reuse) and
+ * "memory pool size" (size of the pool in MB after every release).
+ *
+ * Get the pool of a device with OpenCLDevice::getMemoryPool().
+ */
+class FAST_EXPORT OpenCLMemoryPool {
+    public:
+        typedef std::shared_ptr<OpenCLMemoryPool> pointer;
+        OpenCLMemoryPool(cl::Context context, RuntimeMeasurementsManager::pointer runtimeManager);
+        cl::Image2D* getImage2D(cl_mem_flags flags, cl::ImageFormat format, unsigned int width, unsigned int height);
+        cl::Image3D* getImage3D(cl_mem_flags flags, cl::ImageFormat format, unsigned int width, unsigned int height, unsigned int depth);
+        cl::Buffer* getBuffer(cl_mem_flags flags, std::size_t size);
+        /**
+         * Give an image back to the pool. The image must not be used after this.
+         */
+        void release(cl::Image* image);
+        /**
+         * Give a buffer back to the pool. The buffer must not be used after this.
+         */
+        void release(cl::Buffer* buffer);
+        /**
+         * Set max total size in bytes of the images and buffers kept in the pool. 0 disables the pool.
+         * Default is 256 MB.
+         */
+        void setMaximumSize(std::size_t bytes);
+        std::size_t getMaximumSize();
+        /**
+         * @return total size in bytes of the images and buffers currently kept in the pool
+         */
+        std::size_t getSize();
+        /**
+         * @return nr of images and buffers which have been allocated on the device through the pool
+         */
+        uint64_t getNrOfAllocations();
+        /**
+         * @return nr of images and buffers which have been reused from the pool
+         */
+        uint64_t getNrOfReuses();
+        /**
+         * Delete all images and buffers kept in the pool
+         */
+        void clear();
+        ~OpenCLMemoryPool();
+    private:
+        // Object type, flags, channel order, channel type, width, height, depth. Buffers use width as size.
+        typedef std::tuple<cl_mem_object_type, cl_mem_flags, cl_channel_order, cl_channel_type, std::size_t, std::size_t, std::size_t> Key;
+
+        cl::Memory* get(const Key& key);
+        void release(const Key& key, cl::Memory* object, std::size_t size);
+        static std::size_t getSize(const Key& key);
+
+        cl::Context m_context;
+        RuntimeMeasurementsManager::pointer m_runtimeManager;
+        std::map<Key, std::vector<cl::Memory*>> m_objects;
+        std::size_t m_maximumSize = 256*1024*1024;
+        std::size_t m_size = 0;
+        uint64_t m_allocations = 0;
+        uint64_t m_reuses = 0;
+        std::mutex m_mutex;
+};
+
+}
@@ -1,5 +1,8 @@
 #include "OpenCLProgram.hpp"
 #include "ExecutionDevice.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace fast {
 
@@ -19,6 +22,19 @@ std::string OpenCLProgram::getSourceFilename() const {
     return mSourceFilename;
 }
 
+/**
+ * Get mutex for building a given program. Different programs can be built at the same time.
+ */
+static std::mutex& getBuildMutex(const std::string& programName) {
+    static std::mutex mutex;
+    static std::map<std::string, std::unique_ptr<std::mutex>> buildMutexes;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& buildMutex = buildMutexes[programName];
+    if(!buildMutex)
+        buildMutex = std::make_unique<std::mutex>();
+    return *buildMutex;
+}
+
 cl::Program OpenCLProgram::build(std::shared_ptr<OpenCLDevice> device,
         std::string buildOptions) {
     if(mSourceFilename == "")
@@ -35,7 +51,9 @@ cl::Program OpenCLProgram::build(std::shared_ptr<OpenCLDevice> device,
         return mOpenCLPrograms[device][buildOptions];
 
     std::string programName = mSourceFilename + buildOptions;
-    // Only create program if it doesn't exist for this device from before
+    // Only create program if it doesn't exist for this device from before.
+    // Hold the lock of this program name while checking and creating, so that it is compiled only once.
+    std::lock_guard<std::mutex> lock(getBuildMutex(programName));
     if(!device->hasProgram(programName))
         device->createProgramFromSourceWithName(programName, mSourceFilename, buildOptions);
     return device->getProgram(programName);
@@ -60,4 +78,33 @@ bool OpenCLProgram::buildExists(std::shared_ptr<OpenCLDevice> device,
     return hasBuild;
 }
 
+void buildOpenCLPrograms(std::vector<std::shared_ptr<OpenCLProgram>> programs, std::shared_ptr<OpenCLDevice> device, int threads) {
+    if(threads <= 0)
+        threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    threads = std::min<int>(threads, programs.size());
+
+    std::atomic<int> nextProgram(0);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    std::vector<std::thread> workers;
+    for(int i = 0; i < threads; ++i) {
+        workers.emplace_back([&]() {
+            int index;
+            while((index = nextProgram++) < programs.size()) {
+                try {
+                    programs[index]->build(device);
+                } catch(...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if(!error)
+                        error = std::current_exception();
+                }
+            }
+        });
+    }
+    for(auto& worker : workers)
+        worker.join();
+    if(error)
+        std::rethrow_exception(error);
+}
+
 } // end namespace fast
@@ -3,6 +3,7 @@
 
 #include "Object.hpp"
 #include <unordered_map>
+#include <vector>
 
 namespace cl {
 
@@ -32,6 +33,15 @@ class FAST_EXPORT  OpenCLProgram : public Object {
         std::unordered_map<std::shared_ptr<OpenCLDevice>, std::map<std::string, cl::Program> > mOpenCLPrograms;
 };
 
+/**
+ * Build several OpenCL programs in parallel with default build options.
+ * The resulting binaries are stored in the kernel binary cache, which makes later builds of the same programs fast.
+ * @param programs Programs to build
+ * @param device Device to build for
+ * @param threads Nr of programs to build at the same time. 0 means the nr of hardware threads.
+ */
+FAST_EXPORT void buildOpenCLPrograms(std::vector<std::shared_ptr<OpenCLProgram>> programs, std::shared_ptr<OpenCLDevice> device, int threads = 0);
+
 } // end namespace fast
 
 #endif
@@ -8,7 +8,11 @@
 #include <QLineEdit>
 #include <QCheckBox>
 #include "ProcessObjectList.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/OpenCLProgram.hpp"
+#include <unordered_set>
 #include <FAST/Visualization/View.hpp>
+#include <FAST/Streamers/Streamer.hpp>
 
 namespace fast {
 
@@ -187,6 +191,7 @@ void Pipeline::parseProcessObject(
         } else {
             reportInfo() << "Connected process object " << inputID << " to " << objectID << reportEnd();
             object->setInputConnection(inputPortID, mProcessObjects.at(inputID)->getOutputPort(outputPortID));
+            m_inputs[objectID].push_back(inputID);
         }
         ++lineNr;
     }
@@ -202,6 +207,7 @@ void Pipeline::parsePipelineFile(std::unordered_map<std::string, std::shared_ptr
     mProcessObjects = processObjects;
     mRenderers.clear();
     m_views.clear();
+    m_inputs.clear();
 
     // Retrieve all POs and renderers
     for(int lineNr = 0; lineNr < m_lines.size(); ++lineNr) {
@@ -216,7 +222,20 @@ void Pipeline::parsePipelineFile(std::unordered_map<std::string, std::shared_ptr
 
         std::string key = tokens[0];
 
-        if(key == "ProcessObject") {
+        if((key == "Renderer" || key == "View") && !Config::getVisualization()) {
+            // Skip renderers and views, including their attributes and inputs, when running without visualization
+            reportInfo() << "Visualization is disabled, skipping " << key << " " << tokens[1] << reportEnd();
+            while(lineNr + 1 < m_lines.size()) {
+                std::string nextLine = m_lines[lineNr + 1];
+                trim(nextLine);
+                if(nextLine.empty())
+                    break;
+                auto nextKey = split(nextLine)[0];
+                if(nextKey != "Attribute" && nextKey != "Input")
+                    break;
+                ++lineNr;
+            }
+        } else if(key == "ProcessObject") {
             if(tokens.size() != 3) {
                 throw Exception("Unable to parse pipeline file " + mFilename + ", expected 3 tokens but got line " + line);
             }
@@ -253,6 +272,106 @@ void Pipeline::parsePipelineFile(std::unordered_map<std::string, std::shared_ptr
     }
 }
 
+int Pipeline::buildOpenCLPrograms(std::shared_ptr<OpenCLDevice> device, int threads) {
+    if(!device)
+        device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+
+    // Collect the programs of all process objects, each source file only once
+    std::vector<std::shared_ptr<OpenCLProgram>> programs;
+    std::unordered_set<std::string> sourceFilenames;
+    for(std::string line : m_lines) {
+        trim(line);
+        std::vector<std::string> tokens = split(line);
+        if(tokens.size() != 3 || tokens[0] != "ProcessObject")
+            continue;
+
+        std::shared_ptr<ProcessObject> object;
+        try {
+            object = getProcessObject(tokens[2]);
+        } catch(Exception& e) {
+            reportWarning() << "Unable to create process object " << tokens[2] << " to build its OpenCL programs: " << e.what() << reportEnd();
+            continue;
+        }
+        for(auto&& program : object->getOpenCLPrograms()) {
+            if(sourceFilenames.count(program->getSourceFilename()) > 0)
+                continue;
+            sourceFilenames.insert(program->getSourceFilename());
+            programs.push_back(program);
+        }
+    }
+
+    reportInfo() << "Building " << programs.size() << " OpenCL programs for pipeline " << mName << reportEnd();
+    fast::buildOpenCLPrograms(programs, device, threads);
+    return programs.size();
+}
+
+std::unordered_map<std::string, std::shared_ptr<ProcessObject>> Pipeline::getSinkProcessObjects() {
+    if(mProcessObjects.size() == 0)
+        parsePipelineFile();
+
+    std::unordered_set<std::string> hasConsumer(mRenderers.begin(), mRenderers.end());
+    for(auto&& inputs : m_inputs)
+        hasConsumer.insert(inputs.second.begin(), inputs.second.end());
+    std::unordered_map<std::string, std::shared_ptr<ProcessObject>> sinks;
+    for(auto&& object : mProcessObjects) {
+        if(hasConsumer.count(object.first) == 0)
+            sinks[object.first] = object.second;
+    }
+    return sinks;
+}
+
+int Pipeline::run(int maxIterations) {
+    auto sinks = getSinkProcessObjects();
+    if(sinks.empty())
+        throw Exception("No process objects to run in pipeline " + mFilename);
+
+    // Find the streamers upstream of each sink, the sink is finished when it has received the last frame of all of them
+    std::unordered_map<std::string, std::unordered_set<std::string>> sinkStreamers;
+    for(auto&& sink : sinks) {
+        std::vector<std::string> stack = m_inputs[sink.first];
+        std::unordered_set<std::string> visited;
+        while(!stack.empty()) {
+            const std::string id = stack.back();
+            stack.pop_back();
+            if(!visited.insert(id).second)
+                continue;
+            auto object = mProcessObjects.at(id);
+            if(std::dynamic_pointer_cast<Streamer>(object))
+                sinkStreamers[sink.first].insert(object->getNameOfClass());
+            if(m_inputs.count(id) > 0)
+                stack.insert(stack.end(), m_inputs[id].begin(), m_inputs[id].end());
+        }
+    }
+
+    reportInfo() << "Running pipeline " << mName << " with " << sinks.size() << " sinks" << reportEnd();
+    std::unordered_set<std::string> finished;
+    int iteration = 0;
+    try {
+        while(finished.size() < sinks.size() && (maxIterations <= 0 || iteration < maxIterations)) {
+            for(auto&& sink : sinks) {
+                if(finished.count(sink.first) > 0)
+                    continue;
+                // Use iteration as execute token, so that process objects shared by several sinks execute only once
+                sink.second->update(iteration);
+                bool lastFrame = true;
+                for(auto&& streamer : sinkStreamers[sink.first]) {
+                    if(!sink.second->hasReceivedLastFrame(streamer))
+                        lastFrame = false;
+                }
+                if(lastFrame) {
+                    reportInfo() << "Sink " << sink.first << " finished after " << iteration + 1 << " iterations" << reportEnd();
+                    finished.insert(sink.first);
+                }
+            }
+            ++iteration;
+        }
+    } catch(ThreadStopped &e) {
+        reportInfo() << "Thread stopped exception occured while running pipeline, exiting.." << reportEnd();
+    }
+
+    return iteration;
+}
+
 std::vector<View*> Pipeline::getViews() {
     Reporter::info() << "Setting up pipeline.." << Reporter::end();
     if(mProcessObjects.size() == 0)
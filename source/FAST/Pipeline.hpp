@@ -18,6 +18,11 @@ class FAST_EXPORT  Pipeline : public Object {
         std::vector<View*> getViews();
         std::vector<std::shared_ptr<Renderer>> getRenderers();
         std::unordered_map<std::string, std::shared_ptr<ProcessObject>> getProcessObjects();
+        /**
+         * Get the sinks of the pipeline, i.e. the process objects which output is not used by any other process object.
+         * Renderers are not included.
+         */
+        std::unordered_map<std::string, std::shared_ptr<ProcessObject>> getSinkProcessObjects();
         std::string getName() const;
         std::string getDescription() const;
         std::string getFilename() const;
@@ -25,6 +30,25 @@ class FAST_EXPORT  Pipeline : public Object {
          * Parse the pipeline file
          */
         void parsePipelineFile(std::unordered_map<std::string, std::shared_ptr<ProcessObject>> processObjects = {});
+        /**
+         * Build the OpenCL programs of all process objects in the pipeline file in parallel, and store them in the
+         * kernel binary cache. This avoids compiling kernels one at a time when the pipeline is run the first time.
+         * Programs are built with default build options, thus programs which are built with other options at runtime
+         * will still be compiled when they are first used.
+         * @param device Device to build for, default is the default computation device
+         * @param threads Nr of programs to build at the same time. 0 means the nr of hardware threads.
+         * @return nr of programs built
+         */
+        int buildOpenCLPrograms(std::shared_ptr<OpenCLDevice> device = nullptr, int threads = 0);
+        /**
+         * Run the pipeline without any views, by updating all sinks until every streamer they depend on
+         * has sent its last frame. Sinks which don't depend on any streamers are only updated once.
+         * To run on a machine without a display, disable visualization with Config::setVisualization(false)
+         * before parsing the pipeline file, renderers and views are then skipped.
+         * @param maxIterations Max nr of times to update the sinks, 0 means no limit
+         * @return nr of iterations
+         */
+        int run(int maxIterations = 0);
 
     private:
         std::string mName;
@@ -33,6 +57,8 @@ class FAST_EXPORT  Pipeline : public Object {
         std::unordered_map<std::string, std::shared_ptr<ProcessObject>> mProcessObjects;
         std::unordered_map<std::string, View*> m_views;
         std::vector<std::string> mRenderers;
+        // Process object id -> ids of the process objects it gets input from, renderers are not included
+        std::unordered_map<std::string, std::vector<std::string>> m_inputs;
         std::vector<std::string> m_lines;
 
         void parseProcessObject(
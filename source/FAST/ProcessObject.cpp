@@ -4,6 +4,7 @@
 #include "FAST/Streamers/Streamer.hpp"
 #include <unordered_set>
 #include <FAST/DataChannels/QueuedDataChannel.hpp>
+#include <FAST/DataChannels/RingBufferDataChannel.hpp>
 #include <FAST/DataChannels/NewestFrameDataChannel.hpp>
 #include <FAST/DataChannels/StaticDataChannel.hpp>
 
@@ -117,14 +118,22 @@ void ProcessObject::update(int executeToken) {
     //m_lastFrame.clear();
 }
 
+bool ProcessObject::hasReceivedLastFrame(std::string streamer) const {
+    return m_lastFrame.count(streamer) > 0;
+}
+
 DataChannel::pointer ProcessObject::getOutputPort(uint portID) {
     validateOutputPortExists(portID);
     // Create DataChannel, and it to list and return it
     DataChannel::pointer dataChannel;
     if(isStreamer(this)) {
         auto streamingMode = Config::getStreamingMode();
+        if(m_outputPortStreamingModes.count(portID) > 0)
+            streamingMode = m_outputPortStreamingModes[portID];
         if(streamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES) {
             dataChannel = QueuedDataChannel::New();
+        } else if(streamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES_LOCK_FREE) {
+            dataChannel = RingBufferDataChannel::New();
         } else if(streamingMode == STREAMING_MODE_NEWEST_FRAME_ONLY) {
             dataChannel = NewestFrameDataChannel::New();
         } else {
@@ -143,6 +152,11 @@ DataChannel::pointer ProcessObject::getOutputPort(uint portID) {
     return dataChannel;
 }
 
+void ProcessObject::setOutputPortStreamingMode(uint portID, StreamingMode mode) {
+    validateOutputPortExists(portID);
+    m_outputPortStreamingModes[portID] = mode;
+}
+
 DataChannel::pointer ProcessObject::getInputPort(uint portID) {
     return mInputConnections.at(portID);
 }
@@ -337,6 +351,13 @@ cl::Program ProcessObject::getOpenCLProgram(
     return program->build(device, buildOptions);
 }
 
+std::vector<std::shared_ptr<OpenCLProgram>> ProcessObject::getOpenCLPrograms() const {
+    std::vector<std::shared_ptr<OpenCLProgram>> programs;
+    for(auto&& program : mOpenCLPrograms)
+        programs.push_back(program.second);
+    return programs;
+}
+
 ProcessObject::~ProcessObject() {
 }
 
@@ -47,8 +47,17 @@ class FAST_EXPORT  ProcessObject : public Object {
         void setDevice(uint deviceNumber, ExecutionDevice::pointer device);
         void setDeviceCriteria(uint deviceNumber, const DeviceCriteria& criteria);
         ExecutionDevice::pointer getDevice(uint deviceNumber) const;
+        /**
+         * @return all OpenCL programs used by this process object
+         */
+        std::vector<std::shared_ptr<OpenCLProgram>> getOpenCLPrograms() const;
 
         virtual DataChannel::pointer getOutputPort(uint portID = 0);
+        /**
+         * Override the streaming mode of Config for the data channels created by getOutputPort
+         * on the given port. Only used by streamers.
+         */
+        void setOutputPortStreamingMode(uint portID, StreamingMode mode);
         virtual DataChannel::pointer getInputPort(uint portID = 0);
         virtual void setInputConnection(DataChannel::pointer port);
         virtual void setInputConnection(uint portID, DataChannel::pointer port);
@@ -72,6 +81,11 @@ class FAST_EXPORT  ProcessObject : public Object {
         void stopPipeline();
 
         void setModified(bool modified);
+        /**
+         * @param streamer Name of the streamer, as given to DataObject::setLastFrame
+         * @return true if this process object has received the last frame of the given streamer
+         */
+        bool hasReceivedLastFrame(std::string streamer) const;
 
         template <class DataType>
         std::shared_ptr<DataType> updateAndGetOutputData(uint portID = 0);
@@ -140,6 +154,7 @@ class FAST_EXPORT  ProcessObject : public Object {
         std::unordered_map<uint, std::vector<std::weak_ptr<DataChannel>>> mOutputConnections;
         std::unordered_map<uint, bool> mInputPorts;
         std::unordered_set<uint> mOutputPorts;
+        std::unordered_map<uint, StreamingMode> m_outputPortStreamingModes;
         // <port id, timestep>, register the last timestep of data which this PO executed with
         std::unordered_map<uint, std::pair<DataObject::pointer, uint64_t>> mLastProcessed;
 
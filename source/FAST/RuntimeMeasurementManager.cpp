@@ -118,6 +118,13 @@ void RuntimeMeasurementsManager::stopNumberedRegularTimer(std::string name) {
 		return;
 }
 
+void RuntimeMeasurementsManager::addSample(std::string name, double value) {
+	if (!enabled)
+		return;
+
+	getTiming(name)->addSample(value);
+}
+
 RuntimeMeasurement::pointer RuntimeMeasurementsManager::getTiming(std::string name) {
     if(timings.count(name) == 0) {
         // Create a new empty timing
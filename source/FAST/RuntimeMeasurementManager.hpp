@@ -30,6 +30,11 @@ public:
 	void startNumberedRegularTimer(std::string name);
 	void stopNumberedRegularTimer(std::string name);
 
+	/**
+	 * Add a sample which is not a runtime, such as a queue size, to the measurement with the given name.
+	 */
+	void addSample(std::string name, double value);
+
 	RuntimeMeasurement::pointer getTiming(std::string name);
 
 	void print(std::string name);
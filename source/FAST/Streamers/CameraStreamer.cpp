@@ -50,7 +50,7 @@ public:
         }
         QImage convertedImage = image.convertToFormat(format);
         try {
-            streamer->addNewImageFrame(convertedImage.constBits(), width, height);
+            streamer->addNewImageFrame(convertedImage);
             Reporter::info() << "Finished processing camera frame" << Reporter::end();
         } catch(ThreadStopped & e) {
         }
@@ -112,16 +112,21 @@ void CameraStreamer::execute() {
     reportInfo() << "Finished camera streamer execute" << reportEnd();
 }
 
-void CameraStreamer::addNewImageFrame(const uchar* data, int width, int height) {
+void CameraStreamer::addNewImageFrame(QImage image) {
+    const int channels = mGrayscale ? 1 : 3;
+    const int width = image.width();
+    const int height = image.height();
     auto output = Image::New();
-    output->create(
-        width,
-        height,
-        TYPE_UINT8,
-        mGrayscale ? 1 : 3,
-        getMainDevice(),
-        data
-    );
+    if(image.bytesPerLine() == width*channels) {
+        // Use the data of the QImage directly, the QImage is kept until the image no longer needs it
+        output->create(width, height, TYPE_UINT8, channels, (void*)image.constBits(), [image](void*) {});
+    } else {
+        // Remove padding at the end of each line
+        auto data = std::make_unique<uchar[]>(width*height*channels);
+        for(int y = 0; y < height; ++y)
+            std::memcpy(&data[y*width*channels], image.constScanLine(y), width*channels);
+        output->create(width, height, TYPE_UINT8, channels, Host::getInstance(), std::move(data));
+    }
     std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - m_startTime;
     output->setCreationTimestamp((uint64_t)elapsed.count());
     addOutputData(0, output);
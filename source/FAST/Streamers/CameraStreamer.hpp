@@ -3,6 +3,7 @@
 #include <FAST/Streamers/Streamer.hpp>
 #include <QtMultimedia/QCamera>
 #include <QtMultimedia/QCameraInfo>
+#include <QImage>
 
 class QThread;
 
@@ -14,7 +15,7 @@ class FAST_EXPORT CameraStreamer : public Streamer {
 	FAST_OBJECT(CameraStreamer)
 	public:
 		void setFinished(bool finished);
-        void addNewImageFrame(const uchar* data, int width, int height);
+        void addNewImageFrame(QImage image);
 		bool getGrayscale() const;
         void setGrayscale(bool grayscale);
         void loadAttributes() override;
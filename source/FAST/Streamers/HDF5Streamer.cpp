@@ -0,0 +1,179 @@
+#include "HDF5Streamer.hpp"
+#include <FAST/Data/Image.hpp>
+#include <FAST/Data/Tensor.hpp>
+#include <FAST/Exporters/HDF5Utility.hpp>
+
+namespace fast {
+
+HDF5Streamer::HDF5Streamer() {
+    createOutputPort<DataObject>(0); // Image or Tensor
+
+    createStringAttribute("filename", "Filename", "HDF5 file recorded with HDF5StreamExporter", "");
+    createStringAttribute("name", "Dataset name", "Name of dataset to stream frames from", m_datasetName);
+    createBooleanAttribute("loop", "Loop", "Loop recording", m_loop);
+}
+
+void HDF5Streamer::loadAttributes() {
+    setFilename(getStringAttribute("filename"));
+    setDatasetName(getStringAttribute("name"));
+    setLooping(getBooleanAttribute("loop"));
+}
+
+void HDF5Streamer::setFilename(std::string filename) {
+    m_filename = filename;
+    setModified(true);
+}
+
+void HDF5Streamer::setDatasetName(std::string name) {
+    m_datasetName = name;
+    setModified(true);
+}
+
+void HDF5Streamer::setLooping(bool loop) {
+    m_loop = loop;
+}
+
+void HDF5Streamer::execute() {
+    if(!m_streamIsStarted) {
+        if(m_filename.empty())
+            throw Exception("You must set filename in HDF5Streamer with setFilename()");
+        if(!fileExists(m_filename))
+            throw FileNotFoundException(m_filename);
+        startStream();
+    }
+
+    // Execute on every update, so that errors on the stream thread are also reported after the first frame
+    setModified(true);
+    throwIfStreamFailed();
+    waitForFirstFrame();
+    throwIfStreamFailed();
+}
+
+void HDF5Streamer::throwIfStreamFailed() {
+    if(!m_failed)
+        return;
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    throw Exception(m_errorMessage);
+}
+
+void HDF5Streamer::setError(std::string message) {
+    {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        m_errorMessage = message;
+    }
+    m_failed = true;
+    frameAdded();
+}
+
+void HDF5Streamer::generateStream() {
+    try {
+        H5::H5File file(m_filename.c_str(), H5F_ACC_RDONLY);
+        H5::DataSet frames = file.openDataSet(m_datasetName.c_str());
+        H5::StrType stringType(H5::PredType::C_S1, H5T_VARIABLE);
+
+        std::string object;
+        frames.openAttribute("fast-object").read(stringType, object);
+        int typeValue;
+        frames.openAttribute("fast-data-type").read(H5::PredType::NATIVE_INT, &typeValue);
+        const DataType type = (DataType)typeValue;
+        Vector3f spacing = Vector3f::Ones();
+        if(frames.attrExists("spacing"))
+            frames.openAttribute("spacing").read(H5::PredType::NATIVE_FLOAT, spacing.data());
+
+        H5::DataSpace space = frames.getSpace();
+        std::vector<hsize_t> shape(space.getSimpleExtentNdims());
+        space.getSimpleExtentDims(shape.data());
+        const hsize_t nrOfFrames = shape[0];
+        if(nrOfFrames == 0)
+            throw Exception("No frames in dataset " + m_datasetName + " of " + m_filename);
+        if(object == "image" && shape.size() != 4 && shape.size() != 5)
+            throw Exception("Expected 4 or 5 dimensions of image dataset in HDF5 file, got " + std::to_string(shape.size()));
+        std::size_t elements = 1;
+        for(int i = 1; i < shape.size(); ++i)
+            elements *= shape[i];
+        reportInfo() << "Nr of frames in HDF5 file: " << nrOfFrames << reportEnd();
+
+        const bool hasTimestamps = file.nameExists((m_datasetName + "_timestamps").c_str());
+        const bool hasFrameData = file.nameExists((m_datasetName + "_framedata").c_str());
+        H5::DataSet timestamps, frameData;
+        if(hasTimestamps)
+            timestamps = file.openDataSet((m_datasetName + "_timestamps").c_str());
+        if(hasFrameData)
+            frameData = file.openDataSet((m_datasetName + "_framedata").c_str());
+
+        bool stop = false;
+        while(!stop) {
+            for(hsize_t frameNr = 0; frameNr < nrOfFrames; ++frameNr) {
+                DataObject::pointer frame;
+                if(object == "image") {
+                    auto data = make_uninitialized_unique<uchar[]>(elements*getSizeOfDataType(type, 1));
+                    readFromDataset(frames, frameNr, data.get(), getHDF5Type(type));
+                    auto image = Image::New();
+                    const int channels = shape.back();
+                    if(shape.size() == 5) {
+                        image->create(shape[3], shape[2], shape[1], type, channels, std::move(data));
+                    } else {
+                        image->create(shape[2], shape[1], type, channels, std::move(data));
+                    }
+                    image->setSpacing(spacing);
+                    frame = image;
+                } else if(object == "tensor") {
+                    auto data = make_uninitialized_unique<float[]>(elements);
+                    readFromDataset(frames, frameNr, data.get(), H5::PredType::NATIVE_FLOAT);
+                    auto tensor = Tensor::New();
+                    tensor->create(std::move(data), TensorShape(std::vector<int>(shape.begin() + 1, shape.end())));
+                    frame = tensor;
+                } else {
+                    throw Exception("Unknown object type " + object + " in HDF5 file " + m_filename);
+                }
+
+                if(hasTimestamps) {
+                    uint64_t timestamp;
+                    readFromDataset(timestamps, frameNr, &timestamp, H5::PredType::NATIVE_UINT64);
+                    frame->setCreationTimestamp(timestamp);
+                }
+                if(hasFrameData) {
+                    char* data = nullptr;
+                    readFromDataset(frameData, frameNr, &data, stringType);
+                    if(data != nullptr) {
+                        for(auto&& line : split(data, "\n")) {
+                            const auto separator = line.find('\t');
+                            if(separator != std::string::npos)
+                                frame->setFrameData(line.substr(0, separator), line.substr(separator + 1));
+                        }
+                        H5free_memory(data);
+                    }
+                }
+                if(!m_loop && frameNr == nrOfFrames - 1)
+                    frame->setLastFrame(getNameOfClass());
+
+                try {
+                    addOutputData(0, frame);
+                    frameAdded();
+                } catch(ThreadStopped &e) {
+                    stop = true;
+                    break;
+                }
+                std::lock_guard<std::mutex> lock(m_stopMutex);
+                if(m_stop) {
+                    stop = true;
+                    break;
+                }
+            }
+            if(!m_loop)
+                break;
+        }
+    } catch(H5::Exception& e) {
+        setError("HDF5Streamer failed to read " + m_filename + ": " + e.getDetailMsg());
+    } catch(std::exception& e) {
+        setError(e.what());
+    } catch(...) {
+        setError("HDF5Streamer failed to read " + m_filename);
+    }
+}
+
+HDF5Streamer::~HDF5Streamer() {
+    stop();
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <FAST/Streamers/Streamer.hpp>
+#include <atomic>
+
+namespace fast {
+
+/**
+ * Play back a stream of images or tensors recorded with HDF5StreamExporter.
+ *
+ * Frames are read and output as fast as the pipeline consumes them, with the creation timestamp
+ * and frame data of the recorded frames.
+ */
+class FAST_EXPORT HDF5Streamer : public Streamer {
+    FAST_OBJECT(HDF5Streamer)
+    public:
+        void setFilename(std::string filename);
+        void setDatasetName(std::string name);
+        void setLooping(bool loop);
+        void loadAttributes() override;
+        ~HDF5Streamer();
+    protected:
+        void execute() override;
+        void generateStream() override;
+    private:
+        HDF5Streamer();
+        void setError(std::string message);
+        void throwIfStreamFailed();
+
+        std::string m_filename = "";
+        std::string m_datasetName = "frames";
+        bool m_loop = false;
+        std::atomic_bool m_failed = {false};
+        std::mutex m_errorMutex;
+        std::string m_errorMessage;
+};
+
+}
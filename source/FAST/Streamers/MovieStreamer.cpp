@@ -48,8 +48,11 @@ class VideoSurface : public QAbstractVideoSurface {
             format = QImage::Format_RGB888;
         }
         QImage convertedImage = image.convertToFormat(format);
+        // If no conversion was needed, the image still uses the memory of the frame, which is only valid here
+        if(convertedImage.constBits() == cloneFrame.bits())
+            convertedImage = convertedImage.copy();
         try {
-            streamer->addNewImageFrame(convertedImage.constBits(), width, height);
+            streamer->addNewImageFrame(convertedImage);
             Reporter::info() << "Finished processing movie frame" << Reporter::end();
         } catch(ThreadStopped &e) {
         }
@@ -65,16 +68,21 @@ class VideoSurface : public QAbstractVideoSurface {
     }
 };
 
-void MovieStreamer::addNewImageFrame(const uchar* data, int width, int height) {
+void MovieStreamer::addNewImageFrame(QImage image) {
+    const int channels = mGrayscale ? 1 : 3;
+    const int width = image.width();
+    const int height = image.height();
     Image::pointer output = Image::New();
-    output->create(
-            width,
-            height,
-            TYPE_UINT8,
-            mGrayscale ? 1 : 3,
-            getMainDevice(),
-            data
-    );
+    if(image.bytesPerLine() == width*channels) {
+        // Use the data of the QImage directly, the QImage is kept until the image no longer needs it
+        output->create(width, height, TYPE_UINT8, channels, (void*)image.constBits(), [image](void*) {});
+    } else {
+        // Remove padding at the end of each line
+        auto data = std::make_unique<uchar[]>(width*height*channels);
+        for(int y = 0; y < height; ++y)
+            std::memcpy(&data[y*width*channels], image.constScanLine(y), width*channels);
+        output->create(width, height, TYPE_UINT8, channels, Host::getInstance(), std::move(data));
+    }
     std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - m_startTime;
     output->setCreationTimestamp((uint64_t)elapsed.count());
     addOutputData(0, output);
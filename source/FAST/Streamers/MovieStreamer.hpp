@@ -3,6 +3,7 @@
 
 #include "FAST/Streamers/Streamer.hpp"
 #include <QObject>
+#include <QImage>
 
 class QMediaPlayer;
 class QThread;
@@ -17,7 +18,7 @@ class FAST_EXPORT MovieStreamer : public Streamer {
         void setFilename(std::string filename);
         std::string getFilename() const;
         bool hasReachedEnd();
-        void addNewImageFrame(const uchar* data, int width, int height);
+        void addNewImageFrame(QImage image);
         void setGrayscale(bool grayscale);
         bool getGrayscale() const;
         void setFinished(bool finished);
@@ -76,7 +76,7 @@ std::vector<std::string> OpenIGTLinkStreamer::getActiveTransformStreamNames() {
     return activeStreams;
 }
 
-static Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer message, ExecutionDevice::pointer device) {
+static Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer message) {
     Image::pointer image = Image::New();
     int width, height, depth;
     message->GetDimensions(width, height, depth);
@@ -103,10 +103,12 @@ static Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer mes
             break;
     }
 
+    // Use the data of the message directly, the message is kept until the image no longer needs it
+    auto deleter = [message](void*) {};
     if(depth == 1) {
-        image->create(width, height, type, message->GetNumComponents(), device, data);
+        image->create(width, height, type, message->GetNumComponents(), data, deleter);
     } else {
-        image->create(width, height, depth, type, message->GetNumComponents(), device, data);
+        image->create(width, height, depth, type, message->GetNumComponents(), data, deleter);
     }
 
     auto spacing = std::make_unique<float[]>(3);
@@ -300,7 +302,7 @@ void OpenIGTLinkStreamer::generateStream() {
                 mStreamDescriptions[headerMsg->GetDeviceName()] = description;
 
                 try {
-                    Image::pointer image = createFASTImageFromMessage(imgMsg, getMainDevice());
+                    Image::pointer image = createFASTImageFromMessage(imgMsg);
                     image->setCreationTimestamp(timestamp);
                     addOutputData(mOutputPortDeviceNames[deviceName], image);
                 } catch(NoMoreFramesException &e) {
@@ -0,0 +1,164 @@
+#include "catch.hpp"
+#include "DummyObjects.hpp"
+#include <FAST/DataChannels/QueuedDataChannel.hpp>
+#include <FAST/DataChannels/RingBufferDataChannel.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace fast {
+
+TEST_CASE("Ring buffer data channel keeps order of frames", "[fast][DataChannel][RingBufferDataChannel]") {
+    auto channel = RingBufferDataChannel::New();
+    channel->setMaximumNumberOfFrames(4);
+    const int frames = 1000;
+
+    std::thread producer([&]() {
+        for(int i = 0; i < frames; ++i) {
+            auto data = DummyDataObject::New();
+            data->create(i);
+            channel->addFrame(data);
+        }
+    });
+
+    for(int i = 0; i < frames; ++i) {
+        auto data = channel->getNextFrame<DummyDataObject>();
+        CHECK(data->getID() == i);
+    }
+    producer.join();
+    CHECK(channel->getSize() == 0);
+    CHECK_FALSE(channel->hasCurrentData());
+}
+
+TEST_CASE("Ring buffer data channel with multiple producers", "[fast][DataChannel][RingBufferDataChannel]") {
+    auto channel = RingBufferDataChannel::New();
+    channel->setMaximumNumberOfFrames(8);
+    channel->setMultipleProducersAndConsumers(true);
+    const int producers = 4;
+    const int framesPerProducer = 500;
+
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for(int i = 0; i < framesPerProducer; ++i) {
+                auto data = DummyDataObject::New();
+                data->create(p*framesPerProducer + i);
+                channel->addFrame(data);
+            }
+        });
+    }
+
+    std::vector<int> received;
+    for(int i = 0; i < producers*framesPerProducer; ++i)
+        received.push_back(channel->getNextFrame<DummyDataObject>()->getID());
+    for(auto& thread : threads)
+        thread.join();
+
+    std::sort(received.begin(), received.end());
+    for(int i = 0; i < producers*framesPerProducer; ++i)
+        CHECK(received[i] == i);
+}
+
+TEST_CASE("Ring buffer data channel getFrame and stop", "[fast][DataChannel][RingBufferDataChannel]") {
+    auto channel = RingBufferDataChannel::New();
+    channel->setMaximumNumberOfFrames(2);
+    CHECK_THROWS(channel->getFrame());
+
+    auto data = DummyDataObject::New();
+    data->create(7);
+    channel->addFrame(data);
+    CHECK(channel->hasCurrentData());
+    CHECK(channel->getSize() == 1);
+    CHECK(std::static_pointer_cast<DummyDataObject>(channel->getFrame())->getID() == 7);
+    CHECK(channel->getSize() == 1);
+    channel->addFrame(data);
+
+    // Buffer is now full, and a blocked producer should be released by stop
+    std::thread producer([&]() {
+        CHECK_THROWS_AS(channel->addFrame(data), ThreadStopped);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    channel->stop();
+    producer.join();
+    CHECK_THROWS_AS(channel->getNextFrame(), ThreadStopped);
+}
+
+TEST_CASE("Simple pipeline with stream PROCESS_ALL_FRAMES_LOCK_FREE", "[process_all_frames][ProcessObject][fast][RingBufferDataChannel]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES_LOCK_FREE);
+    auto streamer = DummyStreamer::New();
+    streamer->setSleepTime(10);
+    streamer->setTotalFrames(20);
+
+    auto po = DummyProcessObject::New();
+    po->setInputConnection(streamer->getOutputPort());
+    auto port = po->getOutputPort();
+
+    bool lastFrame = false;
+    int timestep = 0;
+    while(!lastFrame) {
+        po->update();
+        auto image = port->getNextFrame<DummyDataObject>();
+        lastFrame = image->isLastFrame();
+        CHECK(image->getID() == timestep);
+        timestep++;
+    }
+    CHECK(timestep == 20);
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+}
+
+TEST_CASE("Output port streaming mode overrides config", "[ProcessObject][fast][RingBufferDataChannel]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    auto streamer = DummyStreamer::New();
+    CHECK(streamer->getOutputPort()->getNameOfClass() == "QueuedDataChannel");
+    streamer->setOutputPortStreamingMode(0, STREAMING_MODE_PROCESS_ALL_FRAMES_LOCK_FREE);
+    CHECK(streamer->getOutputPort()->getNameOfClass() == "RingBufferDataChannel");
+    CHECK_THROWS(streamer->setOutputPortStreamingMode(1, STREAMING_MODE_PROCESS_ALL_FRAMES_LOCK_FREE));
+}
+
+static void benchmarkDataChannel(DataChannel::pointer channel, int frames) {
+    typedef std::chrono::high_resolution_clock Clock;
+    // Create the frames up front, so that only the hand-off is measured
+    std::vector<DataObject::pointer> objects;
+    for(int i = 0; i < frames; ++i) {
+        auto data = DummyDataObject::New();
+        data->create(i);
+        objects.push_back(data);
+    }
+    std::vector<Clock::time_point> sent(frames);
+    std::vector<double> latencies(frames);
+
+    auto start = Clock::now();
+    std::thread producer([&]() {
+        for(int i = 0; i < frames; ++i) {
+            sent[i] = Clock::now();
+            channel->addFrame(objects[i]);
+        }
+    });
+    for(int i = 0; i < frames; ++i) {
+        auto data = channel->getNextFrame<DummyDataObject>();
+        latencies[data->getID()] = std::chrono::duration<double, std::micro>(Clock::now() - sent[data->getID()]).count();
+    }
+    auto end = Clock::now();
+    producer.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    Reporter::info() << channel->getNameOfClass() << ": " << (int)(frames / seconds) << " frames/s, "
+        << "median hand-off latency " << latencies[frames / 2] << " us, "
+        << "p99 hand-off latency " << latencies[(int)(frames * 0.99)] << " us" << Reporter::end();
+}
+
+TEST_CASE("Data channel hand-off benchmark", "[fast][DataChannel][benchmark]") {
+    const int frames = 200000;
+    for(int capacity : {1, 50}) {
+        Reporter::info() << "Capacity " << capacity << Reporter::end();
+        auto queued = QueuedDataChannel::New();
+        queued->setMaximumNumberOfFrames(capacity);
+        benchmarkDataChannel(queued, frames);
+
+        auto ringBuffer = RingBufferDataChannel::New();
+        ringBuffer->setMaximumNumberOfFrames(capacity);
+        benchmarkDataChannel(ringBuffer, frames);
+    }
+}
+
+}
@@ -0,0 +1,114 @@
+#include "catch.hpp"
+#include <FAST/DeviceManager.hpp>
+#include <FAST/OpenCLProgram.hpp>
+#include <FAST/Config.hpp>
+#include <FAST/Utility.hpp>
+#include <fstream>
+#include <QDir>
+
+namespace fast {
+
+static std::string writeKernel(std::string filename, std::string source) {
+    createDirectories(getDirName(filename));
+    std::ofstream file(filename);
+    file << source;
+    file.close();
+    return filename;
+}
+
+/**
+ * Use a temporary kernel binary path during a test, and remove it afterwards
+ */
+class TemporaryKernelBinaryPath {
+    public:
+        TemporaryKernelBinaryPath() {
+            m_previousPath = Config::getKernelBinaryPath();
+            m_path = QDir::tempPath().toStdString() + "/FAST_kernel_binary_test/";
+            QDir(QString::fromStdString(m_path)).removeRecursively();
+            createDirectories(m_path);
+            Config::setKernelBinaryPath(m_path);
+        }
+        std::string get() const {
+            return m_path;
+        }
+        ~TemporaryKernelBinaryPath() {
+            Config::setKernelBinaryPath(m_previousPath);
+            QDir(QString::fromStdString(m_path)).removeRecursively();
+        }
+    private:
+        std::string m_previousPath;
+        std::string m_path;
+};
+
+static std::shared_ptr<OpenCLDevice> getDevice() {
+    return std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+}
+
+TEST_CASE("OpenCL binary cache filename depends on source and build options", "[fast][OpenCLProgram]") {
+    TemporaryKernelBinaryPath path;
+    auto device = getDevice();
+    const std::string filename = writeKernel(path.get() + "cacheTestKernel.cl",
+            "__kernel void test(__global float* data) { data[get_global_id(0)] = 1.0f; }\n");
+
+    const std::string binaryFilename = device->getProgramBinaryFilename(filename);
+    CHECK(binaryFilename == device->getProgramBinaryFilename(filename));
+    CHECK(binaryFilename != device->getProgramBinaryFilename(filename, "-DTEST"));
+
+    device->createProgramFromSource(filename);
+    CHECK(fileExists(binaryFilename));
+    // Building again should use the cached binary
+    CHECK_NOTHROW(device->createProgramFromSource(filename));
+
+    // Changing the source must give a new binary
+    writeKernel(filename, "__kernel void test(__global float* data) { data[get_global_id(0)] = 2.0f; }\n");
+    CHECK(binaryFilename != device->getProgramBinaryFilename(filename));
+
+    // The index should only have an entry for the newest binary of the source file
+    device->createProgramFromSource(filename);
+    std::ifstream index(path.get() + "cache/index.txt");
+    std::string line;
+    int entries = 0;
+    while(std::getline(index, line)) {
+        if(line.find("cacheTestKernel.cl") != std::string::npos)
+            ++entries;
+    }
+    CHECK(entries == 1);
+}
+
+TEST_CASE("OpenCL binary cache filename depends on included files", "[fast][OpenCLProgram]") {
+    TemporaryKernelBinaryPath path;
+    auto device = getDevice();
+    const std::string header = writeKernel(path.get() + "cacheTestHeader.clh", "#define VALUE 1.0f\n");
+    const std::string filename = writeKernel(path.get() + "cacheTestIncludeKernel.cl",
+            "#include \"cacheTestHeader.clh\"\n__kernel void test(__global float* data) { data[get_global_id(0)] = VALUE; }\n");
+
+    const std::string binaryFilename = device->getProgramBinaryFilename(filename);
+    writeKernel(header, "#define VALUE 2.0f\n");
+    CHECK(binaryFilename != device->getProgramBinaryFilename(filename));
+}
+
+TEST_CASE("Build several OpenCL programs in parallel", "[fast][OpenCLProgram]") {
+    TemporaryKernelBinaryPath path;
+    auto device = getDevice();
+    std::vector<std::shared_ptr<OpenCLProgram>> programs;
+    for(int i = 0; i < 4; ++i) {
+        auto program = OpenCLProgram::New();
+        program->setSourceFilename(writeKernel(path.get() + "parallelTestKernel" + std::to_string(i) + ".cl",
+                "__kernel void test(__global float* data) { data[get_global_id(0)] = " + std::to_string(i) + ".0f; }\n"));
+        programs.push_back(program);
+    }
+    CHECK_NOTHROW(buildOpenCLPrograms(programs, device, 2));
+    // OpenCLProgram adds this build option when building
+    const std::string buildOptions = device->isWritingTo3DTexturesSupported() ? "-Dfast_3d_image_writes" : "";
+    for(auto program : programs) {
+        CHECK(fileExists(device->getProgramBinaryFilename(program->getSourceFilename(), buildOptions)));
+    }
+
+    // A program which fails to build should give an exception
+    auto program = OpenCLProgram::New();
+    program->setSourceFilename(writeKernel(path.get() + "parallelTestErrorKernel.cl", "__kernel void test( {\n"));
+    programs.push_back(program);
+    CHECK_THROWS(buildOpenCLPrograms(programs, device));
+}
+
+}
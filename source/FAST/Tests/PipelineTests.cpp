@@ -0,0 +1,42 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Pipeline.hpp"
+#include <fstream>
+
+using namespace fast;
+
+static std::string writePipelineFile(std::string filename, bool loop) {
+    std::ofstream file(filename);
+    file << "PipelineName \"Headless test\"\n\n"
+         << "ProcessObject streamer ImageFileStreamer\n"
+         << "Attribute fileformat $TEST_DATA_PATH$/US/Axillary/US-2D_#.mhd\n"
+         << "Attribute loop " << (loop ? "true" : "false") << "\n\n"
+         << "ProcessObject thresholding BinaryThresholding\n"
+         << "Attribute lower-threshold 100\n"
+         << "Input 0 streamer 0\n\n"
+         << "ProcessObject temporalSmoothing ImageWeightedMovingAverage\n"
+         << "Attribute frame-count 5\n"
+         << "Input 0 thresholding 0\n";
+    file.close();
+    return filename;
+}
+
+TEST_CASE("Run pipeline without views until last frame", "[fast][Pipeline]") {
+    auto pipeline = Pipeline(writePipelineFile("headless_pipeline.fpl", false));
+    pipeline.parsePipelineFile();
+
+    auto sinks = pipeline.getSinkProcessObjects();
+    REQUIRE(sinks.size() == 1);
+    REQUIRE(sinks.count("temporalSmoothing") == 1);
+
+    const int iterations = pipeline.run();
+    CHECK(iterations > 1);
+    CHECK(sinks["temporalSmoothing"]->hasReceivedLastFrame("ImageFileStreamer"));
+}
+
+TEST_CASE("Run looping pipeline without views for a max nr of iterations", "[fast][Pipeline]") {
+    auto pipeline = Pipeline(writePipelineFile("headless_pipeline_loop.fpl", true));
+    pipeline.parsePipelineFile();
+
+    CHECK(pipeline.run(5) == 5);
+    CHECK_FALSE(pipeline.getSinkProcessObjects()["temporalSmoothing"]->hasReceivedLastFrame("ImageFileStreamer"));
+}
@@ -0,0 +1,29 @@
+#include <FAST/Tools/CommandLineParser.hpp>
+#include <FAST/Pipeline.hpp>
+#include <FAST/DeviceManager.hpp>
+#include <chrono>
+
+using namespace fast;
+
+int main(int argc, char** argv) {
+
+    CommandLineParser parser("FAST Pipeline Kernel Builder",
+            "Use this tool to build and cache the OpenCL kernels of a pipeline before it is executed the first time", true);
+    parser.addPositionVariable(1, "pipeline-filename", true, "Pipeline filename");
+    parser.addVariable("threads", "0", "Nr of kernels to build at the same time. 0 means the nr of hardware threads.");
+
+    parser.parse(argc, argv);
+
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    if(!device) {
+        Reporter::error() << "No OpenCL device was found, can't build kernels" << Reporter::end();
+        return 1;
+    }
+    auto pipeline = Pipeline(parser.get("pipeline-filename"), parser.getVariables());
+
+    auto start = std::chrono::high_resolution_clock::now();
+    const int programs = pipeline.buildOpenCLPrograms(device, parser.get<int>("threads"));
+    std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+    Reporter::info() << "Built " << programs << " OpenCL programs for " << device->getName() << " in " << duration.count() << " ms" << Reporter::end();
+    Reporter::info() << "Kernel binaries are stored in " << Config::getKernelBinaryPath() << Reporter::end();
+}
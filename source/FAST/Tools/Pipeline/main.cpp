@@ -1,22 +1,68 @@
 #include <FAST/Tools/CommandLineParser.hpp>
 #include <FAST/Pipeline.hpp>
 #include <FAST/Visualization/MultiViewWindow.hpp>
+#include <chrono>
+#include <iomanip>
 
 using namespace fast;
 
+// Run the pipeline without views and print the runtime of each process object
+static int runHeadless(Pipeline& pipeline, int maxIterations) {
+    auto processObjects = pipeline.getProcessObjects();
+    for(auto&& object : processObjects)
+        object.second->enableRuntimeMeasurements();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    const int iterations = pipeline.run(maxIterations);
+    std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+
+    std::map<std::string, std::shared_ptr<ProcessObject>> sorted(processObjects.begin(), processObjects.end());
+    std::cout << std::endl << "Runtime summary of pipeline " << pipeline.getName() << std::endl;
+    std::cout << "----------------------------------------------------------------------------------------" << std::endl;
+    std::cout << std::left << std::setw(24) << "ID" << std::setw(28) << "Process object" << std::right
+        << std::setw(10) << "Executed" << std::setw(14) << "Total (ms)" << std::setw(14) << "Average (ms)" << std::endl;
+    for(auto&& object : sorted) {
+        auto runtime = object.second->getRuntime();
+        std::cout << std::left << std::setw(24) << object.first << std::setw(28) << object.second->getNameOfClass() << std::right
+            << std::setw(10) << runtime->getSamples() << std::fixed << std::setprecision(2)
+            << std::setw(14) << runtime->getSum() << std::setw(14) << (runtime->getSamples() > 0 ? runtime->getAverage() : 0.0) << std::endl;
+    }
+    std::cout << "----------------------------------------------------------------------------------------" << std::endl;
+    std::cout << "Ran " << iterations << " iterations in " << duration.count() << " ms" << std::endl;
+    return 0;
+}
+
 int main(int argc, char** argv) {
-    
+
     CommandLineParser parser("FAST Pipeline Executor", "Use this tool to execute pipelines described in text files", true);
     parser.addPositionVariable(1, "pipeline-filename", true, "Pipeline filename");
+    parser.addOption("headless", "Run the pipeline without visualization until all streams have ended, and print a runtime summary");
+    parser.addVariable("max-iterations", "0", "Max nr of iterations to run the pipeline in headless mode. 0 means no limit.");
 
     parser.parse(argc, argv);
 
-    auto pipeline = Pipeline(parser.get("pipeline-filename"), parser.getVariables());
-    pipeline.parsePipelineFile();
+    try {
+        if(parser.getOption("headless")) {
+            Config::setVisualization(false);
+            auto variables = parser.getVariables();
+            variables.erase("headless");
+            variables.erase("max-iterations");
+            auto pipeline = Pipeline(parser.get("pipeline-filename"), variables);
+            pipeline.parsePipelineFile();
+            return runHeadless(pipeline, parser.get<int>("max-iterations"));
+        }
+
+        auto pipeline = Pipeline(parser.get("pipeline-filename"), parser.getVariables());
+        pipeline.parsePipelineFile();
 
-    auto window = MultiViewWindow::New();
-    for(auto view : pipeline.getViews()) {
-        window->addView(view);
+        auto window = MultiViewWindow::New();
+        for(auto view : pipeline.getViews()) {
+            window->addView(view);
+        }
+        window->start();
+    } catch(std::exception& e) {
+        Reporter::error() << "Failed to run pipeline: " << e.what() << Reporter::end();
+        return 1;
     }
-    window->start();
-}
\ No newline at end of file
+    return 0;
+}
@@ -105,6 +105,8 @@ void HeatmapRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, f
     }
 
     cl::Kernel kernel(getOpenCLProgram(device), "renderToTexture");
+    std::vector<OpenCLBufferAccess::pointer> accesses;
+    std::vector<uint> texturesToUpdate;
     for(auto it : mDataToRender) {
         auto input = std::static_pointer_cast<Tensor>(it.second);
         uint inputNr = it.first;
@@ -123,19 +125,16 @@ void HeatmapRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, f
 
         auto access = input->getOpenCLBufferAccess(ACCESS_READ, device);
 
-        if(mTexturesToRender.count(inputNr) > 0) {
-            // Delete old texture
-            glDeleteTextures(1, &mTexturesToRender[inputNr]);
-            mTexturesToRender.erase(inputNr);
-            glDeleteVertexArrays(1, &mVAO[inputNr]);
-            mVAO.erase(inputNr);
-        }
-
-        cl::Image2D image;
         cl::ImageGL imageGL;
         std::vector<cl::Memory> v;
         GLuint textureID;
         if(DeviceManager::isGLInteropEnabled()) {
+            if(mTexturesToRender.count(inputNr) > 0) {
+                // Delete old texture
+                glDeleteTextures(1, &mTexturesToRender[inputNr]);
+                mTexturesToRender.erase(inputNr);
+            }
+
             // Create OpenGL texture
             glGenTextures(1, &textureID);
             glBindTexture(GL_TEXTURE_2D, textureID);
@@ -160,16 +159,13 @@ void HeatmapRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, f
             queue.enqueueAcquireGLObjects(&v);
             kernel.setArg(1, imageGL);
         } else {
-            image = cl::Image2D(
-                    device->getContext(),
-                    CL_MEM_READ_WRITE,
-                    cl::ImageFormat(CL_RGBA, CL_FLOAT),
-                    width, height
-            );
-            kernel.setArg(1, image);
+            if(mTextureUploaders.count(inputNr) == 0)
+                mTextureUploaders[inputNr] = std::make_unique<TextureUploader>();
+            kernel.setArg(1, mTextureUploaders[inputNr]->getImage(device, width, height));
         }
 
         kernel.setArg(0, *access->get());
+        accesses.push_back(std::move(access));
         kernel.setArg(2, mColorBuffer);
         kernel.setArg(3, mMinConfidence);
         kernel.setArg(4, mMaxOpacity);
@@ -185,36 +181,20 @@ void HeatmapRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, f
         if(DeviceManager::isGLInteropEnabled()) {
             queue.enqueueReleaseGLObjects(&v);
             queue.finish();
+            mTexturesToRender[inputNr] = textureID;
         } else {
-            // Copy data from CL image to CPU
-            auto data = make_uninitialized_unique<float[]>(width * height * 4);
-            queue.enqueueReadImage(
-                    image,
-                    CL_TRUE,
-                    createOrigoRegion(),
-                    createRegion(width, height, 1),
-                    0, 0,
-                    data.get()
-            );
-            // Copy data from CPU to GL texture
-            glGenTextures(1, &textureID);
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMethod);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterMethod);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, data.get());
-            glBindTexture(GL_TEXTURE_2D, 0);
-            glFinish();
+            mTextureUploaders[inputNr]->enqueueRead(queue);
+            texturesToUpdate.push_back(inputNr);
         }
 
-        mTexturesToRender[inputNr] = textureID;
         mTensorUsed[inputNr] = input;
         mDataTimestamp[inputNr] = input->getTimestamp();
-        queue.finish();
     }
 
+    // Reads are asynchronous, so all inputs are processed before waiting for any of them
+    for(uint inputNr : texturesToUpdate)
+        mTexturesToRender[inputNr] = mTextureUploaders[inputNr]->updateTexture(filterMethod);
+
     glEnable(GL_BLEND);
     //glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC1_ALPHA);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -56,9 +56,12 @@ void ImageRenderer::deleteAllTextures() {
     }
     mEBO.clear();
     for(auto texture : mTexturesToRender) {
-        glDeleteTextures(1, &texture.second);
+        // Textures of texture uploaders are deleted by the uploader
+        if(mTextureUploaders.count(texture.first) == 0)
+            glDeleteTextures(1, &texture.second);
     }
     mTexturesToRender.clear();
+    mTextureUploaders.clear();
 }
 
 void ImageRenderer::setIntensityLevel(float level) {
@@ -87,6 +90,10 @@ void ImageRenderer::loadAttributes() {
 void ImageRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, float zNear, float zFar, bool mode2D) {
     std::lock_guard<std::mutex> lock(mMutex);
 
+    OpenCLDevice::pointer device = std::dynamic_pointer_cast<OpenCLDevice>(getMainDevice());
+    cl::CommandQueue queue = device->getCommandQueue();
+    std::vector<OpenCLImageAccess::pointer> accesses;
+    std::vector<uint> texturesToUpdate;
     for(auto it : mDataToRender) {
         Image::pointer input = std::static_pointer_cast<Image>(it.second);
         uint inputNr = it.first;
@@ -111,69 +118,20 @@ void ImageRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, flo
             level = getDefaultIntensityLevel(input->getDataType());
         }
 
-        OpenCLDevice::pointer device = std::dynamic_pointer_cast<OpenCLDevice>(getMainDevice());
-
         OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
         cl::Image2D *clImage = access->get2DImage();
+        accesses.push_back(std::move(access));
 
         mKernel = cl::Kernel(getOpenCLProgram(device, "3D"), "renderToTexture");
-        // Run kernel to fill the texture
-        cl::CommandQueue queue = device->getCommandQueue();
-
-        if(mTexturesToRender.count(inputNr) > 0) {
-            // If texture has correct size, we don't need to make a new one
-            int w, h;
-            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
-            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
-            //if(w != input->getWidth() && h != input->getHeight()) {
-                // Delete old texture
-                glDeleteTextures(1, &mTexturesToRender[inputNr]);
-                mTexturesToRender.erase(inputNr);
-                glDeleteVertexArrays(1, &mVAO[inputNr]);
-                mVAO.erase(inputNr);
-            //}
-        }
 
-        cl::Image2D image;
-        cl::ImageGL imageGL;
-        std::vector<cl::Memory> v;
-        GLuint textureID;
-        if(DeviceManager::isGLInteropEnabled() && false) {
-            // Create OpenGL texture
-            glGenTextures(1, &textureID);
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            // TODO Why is this needed:
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, input->getWidth(), input->getHeight(), 0, GL_RGBA, GL_FLOAT, nullptr);
-
-            // Create CL-GL image
-            imageGL = cl::ImageGL(
-                    device->getContext(),
-                    CL_MEM_READ_WRITE,
-                    GL_TEXTURE_2D,
-                    0,
-                    textureID
-            );
-            glBindTexture(GL_TEXTURE_2D, 0);
-            glFinish();     // Make sure everything is ready for CL to take over the texture
-            v.push_back(imageGL);
-            queue.enqueueAcquireGLObjects(&v);
-            mKernel.setArg(1, imageGL);
-        } else {
-            image = cl::Image2D(
-                    device->getContext(),
-                    CL_MEM_READ_WRITE,
-                    cl::ImageFormat(CL_RGBA, CL_FLOAT),
-                    input->getWidth(), input->getHeight()
-            );
-            mKernel.setArg(1, image);
-        }
+        // Grayscale images only need a single channel texture
+        if(mTextureUploaders.count(inputNr) == 0)
+            mTextureUploaders[inputNr] = std::make_unique<TextureUploader>();
+        cl::Image2D image = mTextureUploaders[inputNr]->getImage(device, input->getWidth(), input->getHeight(), input->getNrOfChannels() == 1 ? 1 : 4);
 
+        // Run kernel to fill the texture
         mKernel.setArg(0, *clImage);
+        mKernel.setArg(1, image);
         mKernel.setArg(2, level);
         mKernel.setArg(3, window);
         queue.enqueueNDRangeKernel(
@@ -182,41 +140,17 @@ void ImageRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, flo
                 cl::NDRange(input->getWidth(), input->getHeight()),
                 cl::NullRange
         );
+        mTextureUploaders[inputNr]->enqueueRead(queue);
+        texturesToUpdate.push_back(inputNr);
 
-        if(DeviceManager::isGLInteropEnabled() && false) {
-            queue.enqueueReleaseGLObjects(&v);
-            queue.finish(); // This is needed, otherwise seg fault can occur when doing GL stuff with this texture
-        } else {
-            // Copy data from CL image to CPU
-            auto data = make_uninitialized_unique<float[]>(input->getWidth() * input->getHeight() * 4);
-            queue.finish();
-            queue.enqueueReadImage(
-                    image,
-                    CL_TRUE,
-                    createOrigoRegion(),
-                    createRegion(input->getWidth(), input->getHeight(), 1),
-                    0, 0,
-                    data.get()
-            );
-            // Copy data from CPU to GL texture
-            glGenTextures(1, &textureID);
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            // TODO Why is this needed:
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, input->getWidth(), input->getHeight(), 0, GL_RGBA, GL_FLOAT, data.get());
-            glBindTexture(GL_TEXTURE_2D, 0);
-            glFinish();
-        }
-
-        mTexturesToRender[inputNr] = textureID;
         mImageUsed[inputNr] = input;
         mDataTimestamp[inputNr] = input->getTimestamp();
     }
 
+    // Reads are asynchronous, so all inputs are processed before waiting for any of them
+    for(uint inputNr : texturesToUpdate)
+        mTexturesToRender[inputNr] = mTextureUploaders[inputNr]->updateTexture(GL_LINEAR);
+
     drawTextures(perspectiveMatrix, viewingMatrix, mode2D);
 
 }
@@ -2,6 +2,7 @@
 
 #include "FAST/Visualization/Renderer.hpp"
 #include "FAST/Data/Image.hpp"
+#include "FAST/Visualization/TextureUploader.hpp"
 
 namespace fast {
 
@@ -29,6 +30,10 @@ class FAST_EXPORT  ImageRenderer : public Renderer {
         std::unordered_map<uint, uint> mVAO;
         std::unordered_map<uint, uint> mVBO;
         std::unordered_map<uint, uint> mEBO;
+        /**
+         * Copies the output of the render kernel to the texture of each input
+         */
+        std::unordered_map<uint, std::unique_ptr<TextureUploader>> mTextureUploaders;
 
         cl::Kernel mKernel;
 
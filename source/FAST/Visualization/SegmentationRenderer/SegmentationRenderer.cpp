@@ -117,6 +117,9 @@ SegmentationRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, f
     mKernel.setArg(5, mOpacity);
 
 
+    cl::CommandQueue queue = device->getCommandQueue();
+    std::vector<OpenCLImageAccess::pointer> accesses;
+    std::vector<uint> texturesToUpdate;
     for(auto it : mDataToRender) {
         Image::pointer input = std::static_pointer_cast<Image>(it.second);
         uint inputNr = it.first;
@@ -135,94 +138,33 @@ SegmentationRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, f
 
         OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
         cl::Image2D *clImage = access->get2DImage();
+        accesses.push_back(std::move(access));
 
-        // Run kernel to fill the texture
-        cl::CommandQueue queue = device->getCommandQueue();
-
-        if (mTexturesToRender.count(inputNr) > 0) {
-            // Delete old texture
-            glDeleteTextures(1, &mTexturesToRender[inputNr]);
-            mTexturesToRender.erase(inputNr);
-            glDeleteVertexArrays(1, &mVAO[inputNr]);
-            mVAO.erase(inputNr);
-        }
-
-        cl::Image2D image;
-        cl::ImageGL imageGL;
-        std::vector<cl::Memory> v;
-        GLuint textureID;
-        // TODO The GL-CL interop here is causing glClear to not work on AMD systems and therefore disabled
-        /*
-        if(DeviceManager::isGLInteropEnabled()) {
-            // Create OpenGL texture
-            glGenTextures(1, &textureID);
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, input->getWidth(), input->getHeight(), 0, GL_RGBA, GL_FLOAT, 0);
-
-            // Create CL-GL image
-            imageGL = cl::ImageGL(
-                    device->getContext(),
-                    CL_MEM_READ_WRITE,
-                    GL_TEXTURE_2D,
-                    0,
-                    textureID
-            );
-            glBindTexture(GL_TEXTURE_2D, 0);
-            glFinish();
-            mKernel.setArg(1, imageGL);
-            v.push_back(imageGL);
-            queue.enqueueAcquireGLObjects(&v);
-        } else {
-         */
-        image = cl::Image2D(
-                device->getContext(),
-                CL_MEM_READ_WRITE,
-                cl::ImageFormat(CL_RGBA, CL_FLOAT),
-                input->getWidth(), input->getHeight()
-        );
-        mKernel.setArg(1, image);
-        //}
-
+        // TODO The GL-CL interop here is causing glClear to not work on AMD systems and therefore not used
+        if(mTextureUploaders.count(inputNr) == 0)
+            mTextureUploaders[inputNr] = std::make_unique<TextureUploader>();
+        cl::Image2D image = mTextureUploaders[inputNr]->getImage(device, input->getWidth(), input->getHeight());
 
+        // Run kernel to fill the texture
         mKernel.setArg(0, *clImage);
+        mKernel.setArg(1, image);
         queue.enqueueNDRangeKernel(
                 mKernel,
                 cl::NullRange,
                 cl::NDRange(input->getWidth(), input->getHeight()),
                 cl::NullRange
         );
+        mTextureUploaders[inputNr]->enqueueRead(queue);
+        texturesToUpdate.push_back(inputNr);
 
-        /*if(DeviceManager::isGLInteropEnabled()) {
-            queue.enqueueReleaseGLObjects(&v);
-        } else {*/
-        // Copy data from CL image to CPU
-        auto data = make_uninitialized_unique<float[]>(input->getWidth() * input->getHeight() * 4);
-        queue.enqueueReadImage(
-                image,
-                CL_TRUE,
-                createOrigoRegion(),
-                createRegion(input->getWidth(), input->getHeight(), 1),
-                0, 0,
-                data.get()
-        );
-        // Copy data from CPU to GL texture
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMethod);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterMethod);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, input->getWidth(), input->getHeight(), 0, GL_RGBA, GL_FLOAT, data.get());
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glFinish();
-        //}
-
-        mTexturesToRender[inputNr] = textureID;
         mImageUsed[inputNr] = input;
         mDataTimestamp[inputNr] = input->getTimestamp();
-        queue.finish();
     }
 
+    // Reads are asynchronous, so all inputs are processed before waiting for any of them
+    for(uint inputNr : texturesToUpdate)
+        mTexturesToRender[inputNr] = mTextureUploaders[inputNr]->updateTexture(filterMethod);
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     drawTextures(perspectiveMatrix, viewingMatrix, mode2D);
@@ -0,0 +1,101 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Visualization/TextureUploader.hpp"
+#include "FAST/Visualization/Window.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/Utility.hpp"
+#include <QApplication>
+#include <QGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+#include <chrono>
+
+using namespace fast;
+
+static std::unique_ptr<QOpenGLFunctions_3_3_Core> makeGLContextCurrent() {
+    if(!QApplication::instance())
+        Window::initializeQtApp();
+    if(QGLContext::currentContext() == nullptr)
+        Window::getMainGLContext()->makeCurrent();
+    auto functions = std::make_unique<QOpenGLFunctions_3_3_Core>();
+    functions->initializeOpenGLFunctions();
+    return functions;
+}
+
+TEST_CASE("TextureUploader copies OpenCL image to texture", "[fast][TextureUploader][visual]") {
+    auto gl = makeGLContextCurrent();
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    cl::CommandQueue queue = device->getCommandQueue();
+
+    // Odd width to check that rows which are not 4 byte aligned are handled
+    const int width = 33;
+    const int height = 17;
+    for(int channels : {1, 4}) {
+        TextureUploader uploader;
+        cl::Image2D image = uploader.getImage(device, width, height, channels);
+        const int actualChannels = uploader.getFrameSize() / (width*height);
+        std::vector<uint8_t> data(uploader.getFrameSize());
+        for(int i = 0; i < data.size(); ++i)
+            data[i] = (uint8_t)(i*7);
+
+        // Upload two frames to use more than one pixel buffer
+        for(int frame = 0; frame < 2; ++frame) {
+            data[0] = frame;
+            queue.enqueueWriteImage(image, CL_TRUE, createOrigoRegion(), createRegion(width, height, 1), 0, 0, data.data());
+            uploader.enqueueRead(queue);
+            uint texture = uploader.updateTexture(GL_NEAREST);
+            CHECK(texture == uploader.getTexture());
+
+            std::vector<uint8_t> result(data.size());
+            gl->glBindTexture(GL_TEXTURE_2D, texture);
+            gl->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            gl->glGetTexImage(GL_TEXTURE_2D, 0, actualChannels == 1 ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, result.data());
+            gl->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            gl->glBindTexture(GL_TEXTURE_2D, 0);
+            CHECK(result == data);
+        }
+    }
+}
+
+TEST_CASE("Texture upload benchmark", "[fast][TextureUploader][benchmark][visual]") {
+    auto gl = makeGLContextCurrent();
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    cl::CommandQueue queue = device->getCommandQueue();
+    typedef std::chrono::high_resolution_clock Clock;
+    const int width = 1920;
+    const int height = 1080;
+    const int frames = 100;
+
+    {
+        // The way 2D renderers copied the render kernel output to a texture before
+        cl::Image2D image(device->getContext(), CL_MEM_READ_WRITE, cl::ImageFormat(CL_RGBA, CL_FLOAT), width, height);
+        auto data = make_uninitialized_unique<float[]>(width*height*4);
+        auto start = Clock::now();
+        for(int frame = 0; frame < frames; ++frame) {
+            queue.enqueueReadImage(image, CL_TRUE, createOrigoRegion(), createRegion(width, height, 1), 0, 0, data.get());
+            GLuint texture;
+            gl->glGenTextures(1, &texture);
+            gl->glBindTexture(GL_TEXTURE_2D, texture);
+            gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, data.get());
+            gl->glBindTexture(GL_TEXTURE_2D, 0);
+            gl->glFinish();
+            gl->glDeleteTextures(1, &texture);
+        }
+        std::chrono::duration<double, std::milli> duration = Clock::now() - start;
+        Reporter::info() << "RGBA32F blocking upload: " << duration.count() / frames << " ms per frame, "
+            << width*height*16 / (1024.0f*1024.0f) << " MB per frame" << Reporter::end();
+    }
+
+    for(int channels : {4, 1}) {
+        TextureUploader uploader(3);
+        uploader.getImage(device, width, height, channels);
+        auto start = Clock::now();
+        for(int frame = 0; frame < frames; ++frame) {
+            uploader.enqueueRead(queue);
+            uploader.updateTexture();
+            gl->glFinish();
+        }
+        std::chrono::duration<double, std::milli> duration = Clock::now() - start;
+        Reporter::info() << (uploader.getFrameSize() == width*height ? "R8" : "RGBA8") << " pixel buffer upload: "
+            << duration.count() / frames << " ms per frame, "
+            << uploader.getFrameSize() / (1024.0f*1024.0f) << " MB per frame" << Reporter::end();
+    }
+}
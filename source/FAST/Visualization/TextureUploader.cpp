@@ -0,0 +1,146 @@
+#include "TextureUploader.hpp"
+#include "FAST/Utility.hpp"
+
+namespace fast {
+
+TextureUploader::TextureUploader(int pixelBuffers) {
+    if(pixelBuffers < 1)
+        throw Exception("TextureUploader needs at least one pixel buffer");
+    m_pixelBuffers.resize(pixelBuffers, 0);
+}
+
+cl::Image2D TextureUploader::getImage(OpenCLDevice::pointer device, int width, int height, int channels) {
+    if(channels != 1 && channels != 4)
+        throw Exception("TextureUploader only supports textures with 1 or 4 channels");
+    if(!m_initialized) {
+        initializeOpenGLFunctions();
+        m_initialized = true;
+    }
+    if(channels == 1 && !device->isImageFormatSupported(CL_R, CL_UNORM_INT8, CL_MEM_OBJECT_IMAGE2D))
+        channels = 4;
+
+    if(device == m_device && width == m_width && height == m_height && channels == m_channels)
+        return m_image;
+
+    // Size has changed, create new image, pixel buffers and texture
+    deleteGLObjects();
+    m_device = device;
+    m_width = width;
+    m_height = height;
+    m_channels = channels;
+    m_image = cl::Image2D(
+            device->getContext(),
+            CL_MEM_WRITE_ONLY,
+            cl::ImageFormat(channels == 1 ? CL_R : CL_RGBA, CL_UNORM_INT8),
+            width, height
+    );
+    glGenBuffers(m_pixelBuffers.size(), m_pixelBuffers.data());
+    for(uint pixelBuffer : m_pixelBuffers) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, getFrameSize(), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    return m_image;
+}
+
+void TextureUploader::enqueueRead(cl::CommandQueue queue) {
+    if(m_width == 0)
+        throw Exception("getImage must be called before enqueueRead in TextureUploader");
+    if(m_mappedPixelBuffer != nullptr)
+        throw Exception("updateTexture must be called before the next enqueueRead in TextureUploader");
+
+    // Use the next pixel buffer in the ring, so that we don't have to wait for the texture update
+    // from the previous frame to finish
+    m_currentPixelBuffer = (m_currentPixelBuffer + 1) % m_pixelBuffers.size();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffers[m_currentPixelBuffer]);
+    m_mappedPixelBuffer = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, getFrameSize(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if(m_mappedPixelBuffer == nullptr)
+        throw Exception("Unable to map OpenGL pixel buffer object in TextureUploader");
+
+    queue.enqueueReadImage(
+            m_image,
+            CL_FALSE,
+            createOrigoRegion(),
+            createRegion(m_width, m_height, 1),
+            0, 0,
+            m_mappedPixelBuffer,
+            nullptr,
+            &m_readEvent
+    );
+}
+
+uint TextureUploader::updateTexture(int filter) {
+    if(m_mappedPixelBuffer == nullptr)
+        throw Exception("enqueueRead must be called before updateTexture in TextureUploader");
+
+    m_readEvent.wait();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffers[m_currentPixelBuffer]);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    m_mappedPixelBuffer = nullptr;
+
+    const GLenum format = m_channels == 1 ? GL_RED : GL_RGBA;
+    if(m_texture == 0) {
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        if(m_channels == 1) {
+            // Display single channel textures as grayscale
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
+        }
+        glTexImage2D(GL_TEXTURE_2D, 0, m_channels == 1 ? GL_R8 : GL_RGBA8, m_width, m_height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+
+    // Rows of R8 textures are not 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, format, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glFlush();
+
+    return m_texture;
+}
+
+uint TextureUploader::getTexture() const {
+    return m_texture;
+}
+
+std::size_t TextureUploader::getFrameSize() const {
+    return (std::size_t)m_width*m_height*m_channels;
+}
+
+void TextureUploader::deleteGLObjects() {
+    if(!m_initialized)
+        return;
+    if(m_mappedPixelBuffer != nullptr) {
+        m_readEvent.wait();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffers[m_currentPixelBuffer]);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        m_mappedPixelBuffer = nullptr;
+    }
+    if(m_pixelBuffers[0] != 0) {
+        glDeleteBuffers(m_pixelBuffers.size(), m_pixelBuffers.data());
+        std::fill(m_pixelBuffers.begin(), m_pixelBuffers.end(), 0);
+    }
+    if(m_texture != 0) {
+        glDeleteTextures(1, &m_texture);
+        m_texture = 0;
+    }
+}
+
+TextureUploader::~TextureUploader() {
+    deleteGLObjects();
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "FAST/ExecutionDevice.hpp"
+#include <QOpenGLFunctions_3_3_Core>
+
+namespace fast {
+
+/**
+ * Copies the output of an OpenCL render kernel to an OpenGL texture, when OpenCL-OpenGL interop is not used.
+ *
+ * The kernel writes to an 8 bit image (RGBA8, or R8 for grayscale) with write_imagef, which converts
+ * the values to 8 bit. The image is read asynchronously into one of a ring of pixel buffer objects, and
+ * the texture is updated from the pixel buffer object with glTexSubImage2D. The OpenCL image, pixel buffers
+ * and texture are reused between frames as long as the size and nr of channels doesn't change.
+ *
+ * All methods, including the destructor, must be called from the thread which has the OpenGL context.
+ */
+class FAST_EXPORT TextureUploader : protected QOpenGLFunctions_3_3_Core {
+    public:
+        /**
+         * @param pixelBuffers Nr of pixel buffer objects to cycle through
+         */
+        explicit TextureUploader(int pixelBuffers = 2);
+        /**
+         * Get an OpenCL image for a render kernel to write to.
+         * R8 images are not required to be supported by OpenCL 1.2 devices, thus RGBA8 is used if R8 is not available.
+         * @param device
+         * @param width
+         * @param height
+         * @param channels 1 gives a R8 texture which is displayed as grayscale, 4 gives a RGBA8 texture
+         * @return OpenCL image
+         */
+        cl::Image2D getImage(OpenCLDevice::pointer device, int width, int height, int channels = 4);
+        /**
+         * Start reading the image into the next pixel buffer object. Call this after the render kernel is enqueued.
+         * @param queue
+         */
+        void enqueueRead(cl::CommandQueue queue);
+        /**
+         * Wait for the read started by enqueueRead and copy the pixel buffer object to the texture.
+         * @param filter GL_LINEAR or GL_NEAREST
+         * @return OpenGL texture ID
+         */
+        uint updateTexture(int filter = GL_LINEAR);
+        /**
+         * @return OpenGL texture ID, 0 if no texture is created yet
+         */
+        uint getTexture() const;
+        /**
+         * @return nr of bytes moved from the OpenCL device to OpenGL per frame
+         */
+        std::size_t getFrameSize() const;
+        ~TextureUploader();
+    private:
+        void deleteGLObjects();
+
+        bool m_initialized = false;
+        OpenCLDevice::pointer m_device;
+        cl::Image2D m_image;
+        cl::Event m_readEvent;
+        int m_width = 0;
+        int m_height = 0;
+        int m_channels = 0;
+        std::vector<uint> m_pixelBuffers;
+        int m_currentPixelBuffer = 0;
+        void* m_mappedPixelBuffer = nullptr;
+        uint m_texture = 0;
+};
+
+}
@@ -9,11 +9,13 @@ VectorFieldColorRenderer::VectorFieldColorRenderer() {
 }
 
 void VectorFieldColorRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, float zNear, float zFar, bool mode2D) {
-        std::lock_guard<std::mutex> lock(mMutex);
+    std::lock_guard<std::mutex> lock(mMutex);
     OpenCLDevice::pointer device = std::dynamic_pointer_cast<OpenCLDevice>(getMainDevice());
     cl::CommandQueue queue = device->getCommandQueue();
 
     cl::Kernel kernel(getOpenCLProgram(device), "renderToTexture");
+    std::vector<OpenCLImageAccess::pointer> accesses;
+    std::vector<uint> texturesToUpdate;
     for(auto it : mDataToRender) {
         Image::pointer input = std::static_pointer_cast<Image>(it.second);
         uint inputNr = it.first;
@@ -33,51 +35,14 @@ void VectorFieldColorRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewing
 
         OpenCLImageAccess::pointer access = input->getOpenCLImageAccess(ACCESS_READ, device);
         cl::Image2D *clImage = access->get2DImage();
+        accesses.push_back(std::move(access));
 
-        if(mTexturesToRender.count(inputNr) > 0) {
-            // Delete old texture
-            glDeleteTextures(1, &mTexturesToRender[inputNr]);
-            mTexturesToRender.erase(inputNr);
-            glDeleteVertexArrays(1, &mVAO[inputNr]);
-            mVAO.erase(inputNr);
-        }
-
-        cl::Image2D image;
-        cl::ImageGL imageGL;
-        std::vector<cl::Memory> v;
-        GLuint textureID;
-        if(DeviceManager::isGLInteropEnabled() && false) {
-            // Create OpenGL texture
-            glGenTextures(1, &textureID);
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, input->getWidth(), input->getHeight(), 0, GL_RGBA, GL_FLOAT, 0);
-
-            // Create CL-GL image
-            imageGL = cl::ImageGL(
-                    device->getContext(),
-                    CL_MEM_READ_WRITE,
-                    GL_TEXTURE_2D,
-                    0,
-                    textureID
-            );
-            glBindTexture(GL_TEXTURE_2D, 0);
-            glFinish();
-            v.push_back(imageGL);
-            queue.enqueueAcquireGLObjects(&v);
-            kernel.setArg(1, imageGL);
-        } else {
-            image = cl::Image2D(
-                    device->getContext(),
-                    CL_MEM_READ_WRITE,
-                    cl::ImageFormat(CL_RGBA, CL_FLOAT),
-                    input->getWidth(), input->getHeight()
-            );
-            kernel.setArg(1, image);
-        }
+        if(mTextureUploaders.count(inputNr) == 0)
+            mTextureUploaders[inputNr] = std::make_unique<TextureUploader>();
+        cl::Image2D image = mTextureUploaders[inputNr]->getImage(device, input->getWidth(), input->getHeight());
 
         kernel.setArg(0, *clImage);
+        kernel.setArg(1, image);
         kernel.setArg(2, m_maxOpacity);
         kernel.setArg(3, 1.4f*maxComponent); // sqrt(max*max + max*max) = sqrt(2*max*max) = 1.4*max
 
@@ -87,36 +52,16 @@ void VectorFieldColorRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewing
             cl::NDRange(input->getWidth(), input->getHeight()),
             cl::NullRange
         );
+        mTextureUploaders[inputNr]->enqueueRead(queue);
+        texturesToUpdate.push_back(inputNr);
 
-        if(DeviceManager::isGLInteropEnabled() && false) {
-            queue.enqueueReleaseGLObjects(&v);
-            queue.finish();
-        } else {
-            // Copy data from CL image to CPU
-            auto data = make_uninitialized_unique<float[]>(input->getWidth() * input->getHeight() * 4);
-            queue.enqueueReadImage(
-                    image,
-                    CL_TRUE,
-                    createOrigoRegion(),
-                    createRegion(input->getWidth(), input->getHeight(), 1),
-                    0, 0,
-                    data.get()
-            );
-            // Copy data from CPU to GL texture
-            glGenTextures(1, &textureID);
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, input->getWidth(), input->getHeight(), 0, GL_RGBA, GL_FLOAT, data.get());
-            glBindTexture(GL_TEXTURE_2D, 0);
-            glFinish();
-        }
-
-        mTexturesToRender[inputNr] = textureID;
         mImageUsed[inputNr] = input;
-        queue.finish();
     }
 
+    // Reads are asynchronous, so all inputs are processed before waiting for any of them
+    for(uint inputNr : texturesToUpdate)
+        mTexturesToRender[inputNr] = mTextureUploaders[inputNr]->updateTexture(GL_LINEAR);
+
     glEnable(GL_BLEND);
     //glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC1_ALPHA);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);